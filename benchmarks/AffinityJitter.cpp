@@ -0,0 +1,93 @@
+/*
+ * AffinityJitter.cpp
+ *
+ * Reaction time jitter of a two steps sequence, with and without workers pinning.
+ * Usage: sfc_AffinityJitter [cycles] [cpu...]
+ */
+
+#include <sfc/Sequence.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SteadyTime = std::chrono::steady_clock;
+
+std::vector<double> measure(uint32_t cycles, const AffinityConfig &affinity) {
+  Sequence seq(4);
+  seq.setTransitionPollingDelay(10);
+  seq.setAffinityConfig(affinity);
+  auto init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  auto first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  auto t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  auto t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::atomic<int64_t> activated_at(0);
+  std::atomic<int> activated_id(-1);
+  seq.addStepChangedCallback([&](int id, bool state) {
+    if (state) {
+      activated_at = SteadyTime::now().time_since_epoch().count();
+      activated_id = id;
+    }
+  });
+
+  std::thread t([&seq]() { seq.start(); });
+  while (!init_step->isActivated()) {
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+  }
+
+  std::vector<double> reactions;
+  reactions.reserve(cycles * 2);
+  for (uint32_t i = 0; i < cycles * 2; i++) {
+    auto &transition = (i % 2 == 0) ? t1 : t2;
+    int expected = (i % 2 == 0) ? 1 : 0;
+    std::this_thread::sleep_for(std::chrono::microseconds(200));
+    int64_t set_at = SteadyTime::now().time_since_epoch().count();
+    transition->setReceptivityState(true);
+    while (activated_id != expected) {
+      std::this_thread::yield();
+    }
+    transition->setReceptivityState(false);
+    reactions.push_back((activated_at - set_at) / 1000.0);
+  }
+  seq.stop();
+  t.join();
+  return reactions;
+}
+
+void report(const std::string &name, std::vector<double> reactions) {
+  std::sort(reactions.begin(), reactions.end());
+  auto percentile = [&reactions](double p) { return reactions[static_cast<std::size_t>(p * (reactions.size() - 1))]; };
+  std::cout << std::left << std::setw(12) << name << std::fixed << std::setprecision(1) << " p50: " << percentile(0.5)
+            << "us  p99: " << percentile(0.99) << "us  max: " << reactions.back()
+            << "us  jitter(p99-p50): " << percentile(0.99) - percentile(0.5) << "us" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  uint32_t cycles = (argc > 1) ? std::stoul(argv[1]) : 2000;
+  AffinityConfig pinned;
+  for (int i = 2; i < argc; i++) {
+    pinned.cpus.push_back(std::stoi(argv[i]));
+  }
+  if (pinned.cpus.empty()) {
+    pinned.cpus.push_back(0);
+  }
+
+  std::cout << "Reaction time over " << cycles * 2 << " transitions crossing:" << std::endl;
+  report("unpinned", measure(cycles, AffinityConfig()));
+  report("pinned", measure(cycles, pinned));
+  AffinityConfig isolated;
+  isolated.transition_cpu = pinned.cpus.back();
+  report("isolated", measure(cycles, isolated));
+  return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ * ChartMemory.cpp
+ *
+ * Memory footprint of a big chart, built with 'make_shared' then with a 'ChartArena': heap allocations and bytes per
+ * step, plus the compiled (Contiguous) view the engine reads from.
+ * Usage: sfc_ChartMemory [steps]
+ */
+
+#include <sfc/ChartArena.hpp>
+#include <sfc/CompiledChart.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+std::size_t g_allocations = 0;
+std::size_t g_bytes = 0;
+} // namespace
+
+void *operator new(std::size_t size) {
+  g_allocations++;
+  g_bytes += size;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void *operator new(std::size_t size, std::align_val_t align) {
+  g_allocations++;
+  g_bytes += size;
+  if (void *p = std::aligned_alloc(static_cast<std::size_t>(align), (size + static_cast<std::size_t>(align) - 1) &
+                                                                        ~(static_cast<std::size_t>(align) - 1))) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+
+using SteadyTime = std::chrono::steady_clock;
+
+/**
+ * @brief Build a ring of 'steps' steps (One transition between each), then compile it.
+ */
+template <typename MakeStep, typename MakeTransition>
+void measure(const std::string &name, uint32_t steps, MakeStep make_step, MakeTransition make_transition) {
+  std::size_t allocations = g_allocations, bytes = g_bytes;
+  auto begin = SteadyTime::now();
+  std::vector<std::shared_ptr<Step>> chart;
+  chart.reserve(steps);
+  for (uint32_t i = 0; i < steps; i++) {
+    chart.push_back(make_step(i, i == 0 ? Step::INIT_STEP : Step::DEFAULT_STEP));
+  }
+  for (uint32_t i = 0; i < steps; i++) {
+    chart[i]->addTransition(make_transition(chart[(i + 1) % steps], chart[i]));
+  }
+  double build_ms = std::chrono::duration<double, std::milli>(SteadyTime::now() - begin).count();
+  allocations = g_allocations - allocations;
+  bytes = g_bytes - bytes;
+
+  std::unordered_map<unsigned int, std::shared_ptr<Step>> initial_steps = {{0, chart[0]}}, all_steps;
+  for (const auto &step : chart) {
+    all_steps.emplace(step->getStepId(), step);
+  }
+  begin = SteadyTime::now();
+  auto compiled = CompiledChart::compile(initial_steps, all_steps);
+  double compile_ms = std::chrono::duration<double, std::milli>(SteadyTime::now() - begin).count();
+  std::cout << std::fixed << std::setprecision(1) << name << ": " << double(allocations) / steps << " allocations/step, "
+            << double(bytes) / steps << " bytes/step, build: " << build_ms << "ms, compile: " << compile_ms
+            << "ms, compiled: " << double(compiled->memoryUsage()) / steps << " bytes/step" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  uint32_t steps = (argc > 1) ? std::stoul(argv[1]) : 100000;
+  measure(
+      "heap ", steps, [](unsigned int id, Step::StepType type) { return std::make_shared<Step>(id, type); },
+      [](const std::shared_ptr<Step> &next, const std::shared_ptr<Step> &previous) {
+        return Transition::mk_sp_transition({next}, {previous});
+      });
+  {
+    ChartArena arena;
+    measure(
+        "arena", steps, [&arena](unsigned int id, Step::StepType type) { return arena.makeStep(id, type); },
+        [&arena](const std::shared_ptr<Step> &next, const std::shared_ptr<Step> &previous) {
+          return arena.makeTransition({next}, {previous});
+        });
+    std::cout << "arena: " << double(arena.bytesUsed()) / steps << " bytes/step of objects (" << arena.objectsCount()
+              << " objects), the remaining allocations are the steps and transitions vectors" << std::endl;
+  }
+  return 0;
+}
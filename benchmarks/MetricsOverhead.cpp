@@ -0,0 +1,53 @@
+/*
+ * MetricsOverhead.cpp
+ *
+ * Cost of a counter increment from several threads: sharded 'Metrics' versus one shared atomic counter.
+ * Usage: sfc_MetricsOverhead [threads] [increments per thread]
+ */
+
+#include <sfc/metrics/Metrics.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SteadyTime = std::chrono::steady_clock;
+
+template <typename F> double nsPerIncrement(unsigned int threads_count, uint64_t increments, F increment) {
+  std::vector<std::thread> threads;
+  auto begin = SteadyTime::now();
+  for (unsigned int i = 0; i < threads_count; i++) {
+    threads.emplace_back([increments, &increment]() {
+      for (uint64_t j = 0; j < increments; j++) {
+        increment();
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(SteadyTime::now() - begin).count();
+  return elapsed / (threads_count * increments);
+}
+
+int main(int argc, char **argv) {
+  unsigned int threads_count = (argc > 1) ? std::stoul(argv[1]) : std::max(2u, std::thread::hardware_concurrency());
+  uint64_t increments = (argc > 2) ? std::stoull(argv[2]) : 2000000;
+
+  Metrics metrics;
+  double sharded = nsPerIncrement(threads_count, increments, [&metrics]() { metrics.add(Metrics::TRANSITIONS_EVALUATED); });
+  alignas(64) std::atomic_uint64_t shared_counter(0);
+  double shared = nsPerIncrement(threads_count, increments,
+                                 [&shared_counter]() { shared_counter.fetch_add(1, std::memory_order_relaxed); });
+
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << threads_count << " threads x " << increments << " increments" << std::endl;
+  std::cout << "sharded metrics: " << sharded << " ns/increment (total " << metrics.value(Metrics::TRANSITIONS_EVALUATED)
+            << ")" << std::endl;
+  std::cout << "shared atomic:   " << shared << " ns/increment (total " << shared_counter.load() << ")" << std::endl;
+  return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * ReplaySpeed.cpp
+ *
+ * Recording size and max speed replay throughput of a three steps loop.
+ * Usage: sfc_ReplaySpeed [cycles]
+ */
+
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/record/Recorder.hpp>
+#include <sfc/record/Replayer.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using SteadyTime = std::chrono::steady_clock;
+
+std::vector<std::shared_ptr<Transition>> build(Sequence &seq) {
+  std::vector<std::shared_ptr<Step>> steps;
+  for (unsigned int i = 0; i < 3; i++) {
+    steps.push_back(std::make_shared<Step>(i, i == 0 ? Step::INIT_STEP : Step::DEFAULT_STEP));
+    seq.addStep(steps.back());
+  }
+  std::vector<std::shared_ptr<Transition>> transitions;
+  for (unsigned int i = 0; i < 3; i++) {
+    transitions.push_back(Transition::mk_sp_transition({steps[(i + 1) % 3]}, {steps[i]}));
+    steps[i]->addTransition(transitions.back());
+  }
+  return transitions;
+}
+
+int main(int argc, char **argv) {
+  uint32_t cycles = (argc > 1) ? std::stoul(argv[1]) : 200000;
+
+  Sequence recorded;
+  auto transitions = build(recorded);
+  auto recorder = std::make_shared<Recorder>();
+  recorded.setRecorder(recorder);
+  Simulation sim(recorded);
+  sim.start();
+  for (uint32_t i = 0; i < cycles * 3; i++) {
+    sim.advance(std::chrono::microseconds(250));
+    transitions[i % 3]->setReceptivityState(true);
+    sim.tick();
+    transitions[i % 3]->setReceptivityState(false);
+  }
+  sim.stop();
+  Recording recording = recorder->recording();
+  std::cout << "Recorded " << recording.events().size() << " events in " << recorder->bytesCount() << " bytes ("
+            << std::fixed << std::setprecision(2) << double(recorder->bytesCount()) / recording.events().size()
+            << " bytes/event)" << std::endl;
+
+  Sequence replayed;
+  build(replayed);
+  Simulation replay_sim(replayed);
+  replay_sim.start();
+  Replayer replayer(recording);
+  auto begin = SteadyTime::now();
+  uint64_t inputs = replayer.replay(replay_sim);
+  double seconds = std::chrono::duration<double>(SteadyTime::now() - begin).count();
+  std::cout << "Replayed " << inputs << " inputs (" << replay_sim.activationsCount() << " activations) in " << seconds
+            << "s: " << std::setprecision(0) << inputs / seconds << " inputs/s" << std::endl;
+  replay_sim.stop();
+  return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Restart.cpp
+ *
+ * Start (until init step activation) and stop latencies, cold (New sequence) and warm (Restarted sequence).
+ * Usage: sfc_Restart [cycles]
+ */
+
+#include <sfc/Sequence.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+using SteadyTime = std::chrono::steady_clock;
+
+void build(Sequence &seq) {
+  auto init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  auto first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  init_step->addTransition(Transition::mk_sp_transition({first_step}, {init_step}));
+  first_step->addTransition(Transition::mk_sp_transition({init_step}, {first_step}));
+}
+
+struct Latencies {
+  double start_us = 0;
+  double stop_us = 0;
+};
+
+void cycle(Sequence &seq, Latencies &total) {
+  auto begin = SteadyTime::now();
+  std::thread t([&seq]() { seq.start(); });
+  seq.awaitStep(0);
+  auto started = SteadyTime::now();
+  seq.stop();
+  auto stopped = SteadyTime::now();
+  t.join();
+  total.start_us += std::chrono::duration<double, std::micro>(started - begin).count();
+  total.stop_us += std::chrono::duration<double, std::micro>(stopped - started).count();
+}
+
+void report(const std::string &name, const Latencies &total, uint32_t cycles) {
+  std::cout << std::left << std::setw(6) << name << std::fixed << std::setprecision(1)
+            << " start: " << total.start_us / cycles << "us  stop: " << total.stop_us / cycles << "us" << std::endl;
+}
+
+int main(int argc, char **argv) {
+  uint32_t cycles = (argc > 1) ? std::stoul(argv[1]) : 200;
+
+  Latencies cold;
+  for (uint32_t i = 0; i < cycles; i++) {
+    Sequence seq;
+    build(seq);
+    cycle(seq, cold);
+  }
+  Latencies warm;
+  Sequence seq;
+  build(seq);
+  for (uint32_t i = 0; i < cycles; i++) {
+    cycle(seq, warm);
+  }
+  std::cout << "Mean latencies over " << cycles << " cycles (" << std::thread::hardware_concurrency()
+            << " workers):" << std::endl;
+  report("cold", cold, cycles);
+  report("warm", warm, cycles);
+  return 0;
+}
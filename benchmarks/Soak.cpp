@@ -0,0 +1,261 @@
+/*
+ * Soak.cpp
+ *
+ * Long run of a random chart ('ChartGenerator') driven by random receptivity changes from several threads.
+ * Reports throughput (Activations/s), firing latency (From a transition being true with its source steps active, to
+ * its next step activation callback), and any broken invariant:
+ * - duplicated: a step notified active (Or inactive) twice in a row,
+ * - lost: no active step at all, or activation callbacks not matching the steps activations counts at the end,
+ * - overflow: more active steps than the chart can hold,
+ * - stuck: no activation for a while, though every transition keeps being toggled.
+ * Usage: sfc_Soak [seconds] [seed] [drivers] [max steps]
+ */
+
+#include <sfc/Sequence.hpp>
+#include <sfc/generator/ChartGenerator.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using SteadyTime = std::chrono::steady_clock;
+
+int64_t nowNs() { return std::chrono::duration_cast<std::chrono::nanoseconds>(SteadyTime::now().time_since_epoch()).count(); }
+
+/**
+ * @brief Latencies histogram: power of two buckets, in nanoseconds.
+ */
+struct Histogram {
+  static constexpr uint32_t BUCKETS_COUNT = 40;
+  std::atomic_uint64_t buckets[BUCKETS_COUNT] = {};
+  std::atomic<int64_t> max{0};
+
+  void add(int64_t ns) {
+    uint32_t bucket = 0;
+    while (bucket + 1 < BUCKETS_COUNT && (int64_t(1) << (bucket + 1)) <= ns) {
+      bucket++;
+    }
+    buckets[bucket]++;
+    int64_t previous = max.load();
+    while (ns > previous && !max.compare_exchange_weak(previous, ns)) {
+    }
+  }
+  /**
+   * @brief Upper bound of the bucket holding the 'ratio' quantile.
+   */
+  double quantileUs(double ratio) const {
+    uint64_t total = 0;
+    for (const auto &b : buckets) {
+      total += b;
+    }
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKETS_COUNT; i++) {
+      seen += buckets[i];
+      if (total && seen >= std::ceil(ratio * total)) {
+        return double(int64_t(1) << (i + 1)) / 1000;
+      }
+    }
+    return 0;
+  }
+};
+
+int main(int argc, char **argv) {
+  const uint32_t seconds = (argc > 1) ? std::stoul(argv[1]) : 30;
+  GeneratorConfig config;
+  config.seed = (argc > 2) ? std::stoul(argv[2]) : 7;
+  const uint32_t drivers_count = std::max<uint32_t>((argc > 3) ? std::stoul(argv[3]) : 4, 1);
+  config.max_steps = (argc > 4) ? std::stoul(argv[4]) : 300;
+  config.depth = 4;
+  config.length = 5;
+
+  GeneratedChart chart = ChartGenerator(config).generate();
+  std::cout << "Chart (seed " << config.seed << "): " << chart.steps_count << " steps, " << chart.transitions.size()
+            << " transitions, " << chart.simultaneous_count << " simultaneous, " << chart.exclusive_count
+            << " exclusive, " << chart.macros_count << " macros, " << chart.loops_count << " loops, up to "
+            << chart.max_active_steps << " active steps" << std::endl;
+
+  Sequence seq(std::max<uint32_t>(8, chart.max_active_steps + 2));
+  seq.setTransitionPollingDelay(50);
+  PoolPolicy policy;
+  policy.mode = PoolPolicy::ELASTIC;
+  policy.max_workers = 4 * (chart.max_active_steps + 2);
+  seq.setPoolPolicy(policy);
+  chart.addTo(seq);
+  if (!seq.isValid()) {
+    std::cerr << "Generated chart is invalid !" << std::endl;
+    return 2;
+  }
+
+  // Per step-id state, and per transition raise time (0 while false).
+  const uint32_t ids_count = chart.steps_count;
+  std::unique_ptr<std::atomic_int[]> states(new std::atomic_int[ids_count]);
+  std::unique_ptr<std::atomic<int64_t>[]> activated_at(new std::atomic<int64_t>[ids_count]);
+  std::unique_ptr<std::atomic_uint32_t[]> activations(new std::atomic_uint32_t[ids_count]);
+  std::vector<bool> is_macro(ids_count, false);
+  for (uint32_t id = 0; id < ids_count; id++) {
+    states[id] = 0;
+    activated_at[id] = 0;
+    activations[id] = 0;
+    auto step = seq.getStepById(id);
+    is_macro[id] = step && step->isMacroStep();
+  }
+  std::unordered_map<const Transition *, uint32_t> transition_indexes;
+  for (uint32_t i = 0; i < chart.transitions.size(); i++) {
+    transition_indexes[chart.transitions[i].get()] = i;
+  }
+  std::unique_ptr<std::atomic<int64_t>[]> raised_at(new std::atomic<int64_t>[chart.transitions.size()]);
+  for (uint32_t i = 0; i < chart.transitions.size(); i++) {
+    raised_at[i] = 0;
+  }
+
+  Histogram latencies;
+  std::atomic_uint64_t total_activations(0);
+  std::atomic_uint64_t duplicated(0);
+  seq.addStepChangedCallback([&](unsigned int id, bool state) {
+    if (id >= ids_count || is_macro[id]) {
+      // Macros flags are only notified when deactivated.
+      return;
+    }
+    const int64_t now = nowNs();
+    if (states[id].exchange(state ? 1 : 0) == (state ? 1 : 0)) {
+      duplicated++;
+    }
+    if (!state) {
+      return;
+    }
+    activations[id]++;
+    total_activations++;
+    activated_at[id] = now;
+    int64_t latency = -1;
+    auto incoming = chart.incoming.find(id);
+    if (incoming == chart.incoming.end()) {
+      return;
+    }
+    for (const auto &t : incoming->second) {
+      int64_t enabled_at = raised_at[transition_indexes.at(t.get())];
+      if (enabled_at == 0) {
+        continue;
+      }
+      for (const auto &v : t->validations()) {
+        auto source = v.lock();
+        if (source && source->getStepId() < ids_count) {
+          enabled_at = std::max<int64_t>(enabled_at, activated_at[source->getStepId()]);
+        }
+      }
+      if (enabled_at <= now && (latency < 0 || now - enabled_at < latency)) {
+        latency = now - enabled_at;
+      }
+    }
+    if (latency >= 0) {
+      latencies.add(latency);
+    }
+  });
+
+  std::thread runner([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &e) {
+      std::cerr << "Sequence stopped: " << e.what() << std::endl;
+    }
+  });
+  seq.awaitStep(0);
+
+  std::atomic_bool driving(true);
+  std::vector<std::thread> drivers;
+  for (uint32_t d = 0; d < drivers_count; d++) {
+    drivers.emplace_back([&, d]() {
+      std::mt19937 random(config.seed * 1000 + d);
+      std::vector<uint32_t> owned;
+      for (uint32_t i = d; i < chart.transitions.size(); i += drivers_count) {
+        owned.push_back(i);
+      }
+      while (driving && !owned.empty()) {
+        uint32_t i = owned[random() % owned.size()];
+        auto &t = chart.transitions[i];
+        if (t->getReceptivityState()) {
+          raised_at[i] = 0;
+          t->setReceptivityState(false);
+        } else {
+          raised_at[i] = nowNs();
+          t->setReceptivityState(true);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(random() % 200));
+      }
+    });
+  }
+
+  uint64_t lost = 0, overflow = 0, stuck = 0;
+  const auto begin = SteadyTime::now();
+  auto progress_at = begin;
+  uint64_t last_activations = 0, interval_activations = 0;
+  auto interval_begin = begin;
+  while (seq.isRunning() && SteadyTime::now() - begin < std::chrono::seconds(seconds)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto now = SteadyTime::now();
+    const auto active = seq.getSituation().getActivatedSteps();
+    if (active.empty()) {
+      lost++;
+    } else if (active.size() > chart.max_active_steps) {
+      overflow++;
+    }
+    const uint64_t count = total_activations;
+    if (count != last_activations) {
+      last_activations = count;
+      progress_at = now;
+    } else if (now - progress_at > std::chrono::seconds(2)) {
+      stuck++;
+      progress_at = now;
+      std::cout << "Stuck: no activation for 2s, active steps:";
+      for (auto id : active) {
+        std::cout << " #" << id;
+      }
+      std::cout << std::endl;
+    }
+    if (now - interval_begin >= std::chrono::seconds(5)) {
+      double elapsed = std::chrono::duration<double>(now - interval_begin).count();
+      std::cout << std::fixed << std::setprecision(0) << std::chrono::duration<double>(now - begin).count()
+                << "s: " << (count - interval_activations) / elapsed << " activations/s, latency p50: "
+                << std::setprecision(1) << latencies.quantileUs(0.5) << "us p99: " << latencies.quantileUs(0.99)
+                << "us max: " << latencies.max / 1000.0 << "us" << std::endl;
+      interval_activations = count;
+      interval_begin = now;
+    }
+  }
+  const bool stopped_early = !seq.isRunning();
+  driving = false;
+  for (auto &driver : drivers) {
+    driver.join();
+  }
+  seq.stop();
+  runner.join();
+
+  // Every activation must have been notified once.
+  uint64_t unnotified = 0;
+  for (uint32_t id = 0; id < ids_count; id++) {
+    auto step = seq.getStepById(id);
+    if (step && !is_macro[id]) {
+      unnotified += std::abs(int64_t(step->activationsCount()) - int64_t(activations[id].load()));
+    }
+  }
+  const double elapsed = std::chrono::duration<double>(SteadyTime::now() - begin).count();
+  std::cout << std::fixed << std::setprecision(0) << "Total: " << total_activations << " activations in "
+            << elapsed << "s (" << total_activations / elapsed << "/s), latency p50: " << std::setprecision(1)
+            << latencies.quantileUs(0.5) << "us p99: " << latencies.quantileUs(0.99)
+            << "us max: " << latencies.max / 1000.0 << "us" << std::endl;
+  std::cout << "Duplicated: " << duplicated << ", lost: " << lost << ", unnotified: " << unnotified
+            << ", overflow: " << overflow << ", stuck: " << stuck;
+  if (stopped_early) {
+    std::cout << ", stopped early (Stop code " << seq.getStopCode() << ")";
+  }
+  std::cout << std::endl;
+  return (duplicated || lost || unnotified || overflow || stuck || stopped_early) ? 1 : 0;
+}
@@ -0,0 +1,126 @@
+/*
+ * StopLatency.cpp
+ *
+ * 'Sequence::stop' latency, every engine wait being cancelled by the stop request:
+ * - polling: simultaneous branches all sleeping in their transitions polling (Long polling delay),
+ *   stop time compared with the polling delay.
+ * - action: stop called while an inline action runs, stop completion measured from the action return.
+ * Usage: sfc_StopLatency [cycles] [polling delay ms] [branches]
+ */
+
+#include <sfc/Sequence.hpp>
+#include <sfc/step/action/StepAction.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using SteadyTime = std::chrono::steady_clock;
+
+void report(const std::string &name, std::vector<double> &latencies_us) {
+  std::sort(latencies_us.begin(), latencies_us.end());
+  double mean = 0;
+  for (auto l : latencies_us) {
+    mean += l;
+  }
+  mean /= latencies_us.size();
+  std::cout << std::left << std::setw(8) << name << std::fixed << std::setprecision(1) << " mean: " << mean
+            << "us  p50: " << latencies_us[latencies_us.size() / 2] << "us  p99: "
+            << latencies_us[(latencies_us.size() * 99) / 100] << "us  max: " << latencies_us.back() << "us"
+            << std::endl;
+}
+
+/**
+ * @brief Init step, then 'branches' simultaneous steps polling a transition never true.
+ */
+void buildPolling(Sequence &seq, uint32_t branches, std::shared_ptr<Transition> &fork) {
+  auto init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  seq.addStep(init_step);
+  std::vector<std::weak_ptr<Step>> steps;
+  for (uint32_t i = 1; i <= branches; i++) {
+    auto step = std::make_shared<Step>(i, Step::DEFAULT_STEP);
+    seq.addStep(step);
+    steps.push_back(step);
+  }
+  fork = std::make_shared<Transition>(steps, std::vector<std::weak_ptr<Step>>{init_step});
+  init_step->addTransition(fork);
+  auto join = std::make_shared<Transition>(std::vector<std::weak_ptr<Step>>{init_step}, steps);
+  for (auto &step : steps) {
+    step.lock()->addTransition(join);
+  }
+}
+
+int main(int argc, char **argv) {
+  const uint32_t cycles = std::max<uint32_t>((argc > 1) ? std::stoul(argv[1]) : 100, 1);
+  const uint32_t polling_delay_ms = (argc > 2) ? std::stoul(argv[2]) : 100;
+  const uint32_t branches = std::max<uint32_t>((argc > 3) ? std::stoul(argv[3]) : 4, 2);
+
+  // Polling steps: without cancellation, each stop would wait up to the polling delay.
+  std::vector<double> polling;
+  {
+    Sequence seq(branches + 2);
+    seq.setTransitionPollingDelay(polling_delay_ms * 1000);
+    std::shared_ptr<Transition> fork;
+    buildPolling(seq, branches, fork);
+    for (uint32_t i = 0; i < cycles; i++) {
+      std::thread t([&seq]() { seq.start(); });
+      seq.awaitStep(0);
+      fork->setReceptivityState(true);
+      seq.awaitStep(branches);
+      fork->setReceptivityState(false);
+      // Let every branch fall asleep.
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      seq.stop();
+      t.join();
+      polling.push_back(std::chrono::duration<double, std::micro>(seq.getStopLatency()).count());
+    }
+  }
+
+  // Inline action running when stopping: stop returns right after it.
+  std::vector<double> action;
+  {
+    Sequence seq;
+    seq.setTransitionPollingDelay(polling_delay_ms * 1000);
+    std::atomic_bool running(false);
+    std::atomic<int64_t> returned_at(0);
+    auto timed = std::make_shared<StepAction>([&running, &returned_at]() {
+      running = true;
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      returned_at = SteadyTime::now().time_since_epoch().count();
+      running = false;
+    });
+    auto init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+    auto action_step = std::make_shared<Step>(1, Step::DEFAULT_STEP, std::vector<std::shared_ptr<StepAction>>{timed});
+    seq.addStep(init_step);
+    seq.addStep(action_step);
+    auto t1 = Transition::mk_sp_transition({action_step}, {init_step});
+    init_step->addTransition(t1);
+    action_step->addTransition(Transition::mk_sp_transition({init_step}, {action_step}));
+    for (uint32_t i = 0; i < cycles; i++) {
+      std::thread t([&seq]() { seq.start(); });
+      seq.awaitStep(0);
+      t1->setReceptivityState(true);
+      while (!running) {
+        std::this_thread::yield();
+      }
+      t1->setReceptivityState(false);
+      seq.stop();
+      const auto stopped = SteadyTime::now().time_since_epoch().count();
+      t.join();
+      action.push_back((stopped - returned_at) / 1000.0);
+    }
+  }
+
+  std::cout << "Stop latencies over " << cycles << " cycles (Polling delay " << polling_delay_ms << "ms, "
+            << branches << " branches):" << std::endl;
+  report("polling", polling);
+  report("action", action);
+  return 0;
+}
@@ -42,6 +42,7 @@ option(BUILD_SHARED     "Build shared if ON, static if OFF."     ON)
 option(DEBUG_MODE       "Enable 'debug mode' support."           OFF)
 option(BUILD_TESTS      "Build Tests."                           ON)
 option(BUILD_TOOLS      "Build Tools"                            ON)
+option(BUILD_BENCHMARKS "Build Benchmarks."                      OFF)
 option(BUILD_DOC        "Build documentation."                   OFF)
 option(CODE_COVERAGE    "Enable code coverage testing support."  ON)
 option(CONAN_BUILD      "Building from conan."                   OFF)
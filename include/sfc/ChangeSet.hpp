@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class Step;
+class Transition;
+
+/**
+ * @brief Chart modifications, applied at once to a (possibly running) sequence by 'Sequence::apply'.
+ * Nothing is modified before 'apply': the modified chart is built and validated off to the side first.
+ */
+class ChangeSet {
+public:
+  using StepTransition = std::pair<unsigned int, std::shared_ptr<Transition>>;
+
+private:
+  std::vector<std::shared_ptr<Step>> m_added_steps;
+  std::vector<unsigned int> m_removed_steps;
+  std::vector<StepTransition> m_added_transitions;
+  std::vector<StepTransition> m_removed_transitions;
+  std::unordered_map<unsigned int, unsigned int> m_active_steps_mapping;
+
+public:
+  /**
+   * @brief Add a new step (With its transitions, if any).
+   * @param step
+   * @return ChangeSet&
+   */
+  ChangeSet &addStep(std::shared_ptr<Step> step);
+  /**
+   * @brief Remove a step. It must not be referenced anymore by any transition.
+   * If it is active when applied, it must be mapped (See 'mapActiveStep').
+   * @param id
+   * @return ChangeSet&
+   */
+  ChangeSet &removeStep(unsigned int id);
+  /**
+   * @brief Add a next transition to step 'step_id' (Existing or added one).
+   * @param step_id
+   * @param transition
+   * @return ChangeSet&
+   */
+  ChangeSet &addTransition(unsigned int step_id, std::shared_ptr<Transition> transition);
+  /**
+   * @brief Remove a next transition from step 'step_id'.
+   * @param step_id
+   * @param transition
+   * @return ChangeSet&
+   */
+  ChangeSet &removeTransition(unsigned int step_id, std::shared_ptr<Transition> transition);
+  /**
+   * @brief If removed step 'from_id' is active when applied, 'to_id' is activated instead.
+   * @param from_id
+   * @param to_id
+   * @return ChangeSet&
+   */
+  ChangeSet &mapActiveStep(unsigned int from_id, unsigned int to_id);
+
+  const std::vector<std::shared_ptr<Step>> &addedSteps() const;
+  const std::vector<unsigned int> &removedSteps() const;
+  const std::vector<StepTransition> &addedTransitions() const;
+  const std::vector<StepTransition> &removedTransitions() const;
+  const std::unordered_map<unsigned int, unsigned int> &activeStepsMapping() const;
+  /**
+   * @brief To know if there is nothing to apply.
+   * @return true
+   * @return false
+   */
+  bool empty() const;
+};
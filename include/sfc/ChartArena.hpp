@@ -0,0 +1,53 @@
+#pragma once
+
+#include "sfc/step/Macro.hpp"
+#include "sfc/step/Step.hpp"
+#include "sfc/transition/Transition.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Monotonic arena to build big charts: steps and transitions (And their 'shared_ptr' control blocks)
+ * are carved out of large contiguous blocks instead of being separate heap allocations.
+ * - Objects are regular 'shared_ptr': they can be added to sequences and mixed with heap allocated ones.
+ * - Memory is only given back when the arena and every object built from it are gone (Objects keep the blocks alive).
+ * - Building is not thread-safe: build a chart from one thread (Releasing objects can be done from anywhere).
+ * - Adjacency of a built chart is stored contiguously by 'CompiledChart', which the engine reads from.
+ */
+class ChartArena {
+public:
+  class Resource;
+
+private:
+  std::shared_ptr<Resource> m_resource;
+
+public:
+  /**
+   * @brief Construct a new Chart Arena.
+   * @param block_size Size of the first block, next ones grow geometrically.
+   */
+  explicit ChartArena(std::size_t block_size = 64 * 1024);
+
+  std::shared_ptr<Step> makeStep(unsigned int step_id, Step::StepType step_type = Step::DEFAULT_STEP,
+                                 std::vector<std::shared_ptr<StepAction>> actions = {});
+  std::shared_ptr<Macro> makeMacro(unsigned int step_id, std::vector<std::shared_ptr<StepAction>> actions = {});
+  std::shared_ptr<Transition> makeTransition(std::initializer_list<std::weak_ptr<Step>> nexts,
+                                             std::initializer_list<std::weak_ptr<Step>> validations,
+                                             Transition::ValidationMode mode = Transition::ALL);
+  std::shared_ptr<Transition> makeTransition(std::vector<std::weak_ptr<Step>> nexts,
+                                             std::vector<std::weak_ptr<Step>> validations,
+                                             Transition::ValidationMode mode = Transition::ALL);
+
+  /**
+   * @brief Bytes handed out by the arena (Objects and control blocks).
+   * @return std::size_t
+   */
+  std::size_t bytesUsed() const;
+  /**
+   * @brief Objects built by the arena.
+   * @return std::size_t
+   */
+  std::size_t objectsCount() const;
+};
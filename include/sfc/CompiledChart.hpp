@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Step;
+class Transition;
+
+/**
+ * @brief Immutable, index-based view of a sequence chart.
+ * - Steps are sorted by id, transitions are numbered in discovery order (Steps order, then each step's transitions order),
+ *   so that indexes are stable for a same chart.
+ * - Adjacency lists are stored contiguously.
+ * - Macros are kept as steps, with the index of their first and last steps.
+ * - Enclosing steps are kept as steps, with the indexes of their enclosed and activation steps.
+ */
+class CompiledChart {
+public:
+  static constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  /**
+   * @brief Contiguous range of indexes.
+   */
+  struct Range {
+    const uint32_t *first;
+    const uint32_t *last;
+    const uint32_t *begin() const { return first; }
+    const uint32_t *end() const { return last; }
+    std::size_t size() const { return last - first; }
+  };
+
+  struct StepNode {
+    Step *step;
+    /**
+     * @brief Macro's first and last steps indexes (NONE if not a macro).
+     */
+    uint32_t macro_first = NONE;
+    uint32_t macro_last = NONE;
+    /**
+     * @brief Index of the enclosing step (NONE if not enclosed).
+     */
+    uint32_t enclosing = NONE;
+    /**
+     * @brief Next transitions, in 'm_adjacency'.
+     */
+    uint32_t transitions_begin = 0;
+    uint32_t transitions_end = 0;
+    /**
+     * @brief Enclosed steps, then activation steps among them, in 'm_adjacency' (Empty if not an enclosing step).
+     */
+    uint32_t enclosed_begin = 0;
+    uint32_t enclosed_end = 0;
+    uint32_t activations_begin = 0;
+    uint32_t activations_end = 0;
+  };
+
+  struct TransitionNode {
+    Transition *transition;
+    /**
+     * @brief Next steps, in 'm_adjacency'.
+     */
+    uint32_t nexts_begin = 0;
+    uint32_t nexts_end = 0;
+    /**
+     * @brief Validation steps, in 'm_adjacency'.
+     */
+    uint32_t validations_begin = 0;
+    uint32_t validations_end = 0;
+    /**
+     * @brief Arrivals needed before launching a next step ('validations' count in 'Transition::ALL' mode, else 1).
+     */
+    uint32_t required_count = 1;
+  };
+
+private:
+  /**
+   * @brief Keep steps and transitions alive.
+   */
+  std::vector<std::shared_ptr<Step>> m_step_refs;
+  std::vector<std::shared_ptr<Transition>> m_transition_refs;
+
+  std::vector<StepNode> m_steps;
+  std::vector<TransitionNode> m_transitions;
+  /**
+   * @brief All adjacency lists.
+   */
+  std::vector<uint32_t> m_adjacency;
+  std::unordered_map<unsigned int, uint32_t> m_step_indexes;
+  std::unordered_map<const Transition *, uint32_t> m_transition_indexes;
+  uint64_t m_fingerprint = 0;
+
+public:
+  /**
+   * @brief Next transitions to use instead of the steps' ones (To compile a modified chart off to the side).
+   */
+  using TransitionsOverrides = std::unordered_map<const Step *, std::vector<std::shared_ptr<Transition>>>;
+
+  /**
+   * @brief Build the chart from sequence's steps.
+   * @param initial_steps
+   * @param steps
+   * @param overrides Optional.
+   * @throw std::invalid_argument if a transition leads to, or is validated by, a step not in the sequence,
+   * or if it leads out of its enclosing step.
+   */
+  static std::shared_ptr<const CompiledChart> compile(const std::unordered_map<unsigned int, std::shared_ptr<Step>> &initial_steps,
+                                                      const std::unordered_map<unsigned int, std::shared_ptr<Step>> &steps,
+                                                      const TransitionsOverrides *overrides = nullptr);
+
+  /**
+   * @brief Structure hash: steps ids and types, macros, enclosing steps, adjacency and validation modes.
+   * Two charts with the same fingerprint have the same structure (Receptivities and actions are not part of it).
+   */
+  uint64_t fingerprint() const;
+  /**
+   * @brief Heap bytes of the compiled chart (Hash indexes are estimated).
+   * @return std::size_t
+   */
+  std::size_t memoryUsage() const;
+  uint32_t stepsCount() const;
+  uint32_t transitionsCount() const;
+  const StepNode &step(uint32_t index) const;
+  const TransitionNode &transition(uint32_t index) const;
+  /**
+   * @brief Get the Step index.
+   * @param id Step id.
+   * @return uint32_t NONE if unknown.
+   */
+  uint32_t stepIndex(unsigned int id) const;
+  /**
+   * @brief Get the Transition index.
+   * @param transition
+   * @return uint32_t NONE if unknown.
+   */
+  uint32_t transitionIndex(const Transition *transition) const;
+  /**
+   * @brief Next transitions indexes of a step.
+   */
+  Range nextTransitions(uint32_t step_index) const;
+  /**
+   * @brief Next steps indexes of a transition.
+   */
+  Range nexts(uint32_t transition_index) const;
+  /**
+   * @brief Validation steps indexes of a transition.
+   */
+  Range validations(uint32_t transition_index) const;
+  /**
+   * @brief Directly enclosed steps indexes of an enclosing step.
+   */
+  Range enclosed(uint32_t step_index) const;
+  /**
+   * @brief Activation steps indexes of an enclosing step.
+   */
+  Range activations(uint32_t step_index) const;
+};
@@ -1,8 +1,24 @@
 #pragma once
 
-#include "sfc/ctpl_stl.h"
+#include "sfc/ChangeSet.hpp"
+#include "sfc/CompiledChart.hpp"
+#include "sfc/clock/Clock.hpp"
+#include "sfc/executor/Executor.hpp"
+#include "sfc/input/InputRing.hpp"
+#include "sfc/metrics/Metrics.hpp"
+#include "sfc/persist/Persister.hpp"
+#include "sfc/profile/Profiler.hpp"
+#include "sfc/record/Recorder.hpp"
+#include "sfc/situation/SituationPublisher.hpp"
+#include "sfc/step/Enclosing.hpp"
 #include "sfc/step/Macro.hpp"
 #include "sfc/step/Step.hpp"
+#include "sfc/step/StepTiming.hpp"
+#include "sfc/step/action/ActionExecutor.hpp"
+#include "sfc/sync/StopToken.hpp"
+#include "sfc/trace/Tracer.hpp"
+#include "sfc/watchdog/Watchdog.hpp"
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
@@ -32,16 +48,23 @@ class StepActivation;
  */
 class Sequence {
   friend class StepActivation;
+  friend class Simulation;
 
-private:
+public:
   /**
-   * @brief To synchronize start/stop.
+   * @brief How step actions are run, and whether step activation waits for them.
+   * - INLINE_ACTIONS: Actions run on the step thread, before activation (Legacy behaviour).
+   * - WAIT_ALL_ACTIONS: Actions run on the 'ActionExecutor', activation waits for all of them.
+   * - WAIT_CRITICAL_ACTIONS: Actions run on the 'ActionExecutor', activation only waits for 'StepAction::CRITICAL' ones.
+   * - DETACHED_ACTIONS: Actions run on the 'ActionExecutor', activation does not wait at all.
    */
-  std::mutex start_stop_mutex;
+  enum ActionPolicy : uint8_t { INLINE_ACTIONS, WAIT_ALL_ACTIONS, WAIT_CRITICAL_ACTIONS, DETACHED_ACTIONS };
+
+private:
   /**
-   * @brief To protect access to 'm_steps_required_call_count' and 'm_steps_current_call_count'.
+   * @brief To synchronize start/stop.
    */
-  std::mutex map_mutex;
+  mutable std::mutex start_stop_mutex;
   /**
    * @brief To sync callbacks triggerring.
    */
@@ -50,6 +73,10 @@ private:
    * @brief To sync callbacks triggerring.
    */
   std::mutex step_cb_mutex;
+  /**
+   * @brief To sync watchdog callbacks triggerring.
+   */
+  std::mutex watchdog_cb_mutex;
 
   /**
    * @brief Thread pool size (threads count).
@@ -57,9 +84,199 @@ private:
   uint32_t m_thread_pool_size = 0;
   /**
    * @brief Sequence thead pool responsible for running all steps.
-   * If the pool is lacking idling threads, we considere the sequence as fucked (Crazy-looping).
+   * If the pool is lacking idling threads, we considere the sequence as fucked (Crazy-looping), unless
+   * 'm_pool_policy' says otherwise.
+   * Created at first start, kept parked across stop/start (Dropped when its settings change).
+   */
+  std::unique_ptr<Executor> m_thread_pool;
+  /**
+   * @brief Starts reusing parked workers.
+   */
+  uint64_t m_warm_starts = 0;
+  /**
+   * @brief Fingerprint of the last chart which passed 'isValid'.
+   */
+  bool m_chart_validated = false;
+  uint64_t m_validated_fingerprint = 0;
+  /**
+   * @brief Fingerprint of the chart the hot path containers were prepared for.
+   */
+  bool m_chart_prepared = false;
+  uint64_t m_prepared_fingerprint = 0;
+  /**
+   * @brief What to do when 'm_thread_pool' lacks workers, and runaway loops detection.
+   */
+  PoolPolicy m_pool_policy;
+  /**
+   * @brief Real-time settings, applied to 'm_thread_pool' workers at start.
+   */
+  RealTimeConfig m_rt_config;
+  /**
+   * @brief CPU placement settings, applied at start.
+   */
+  AffinityConfig m_affinity_config;
+  /**
+   * @brief Simultaneous branch index per step-id (Only computed when pinning branches).
+   */
+  std::unordered_map<unsigned int, unsigned int> m_step_branches;
+  /**
+   * @brief Real-time violations count: hot path having to allocate despite the start-time reservations
+   * (Step tasks pushed while every reserved executor slot is taken).
+   */
+  std::atomic_uint64_t m_rt_violations;
+
+  /**
+   * @brief Actions policy.
+   */
+  ActionPolicy m_action_policy = INLINE_ACTIONS;
+  /**
+   * @brief Actions workers count, used if the 'ActionExecutor' has to be created at start.
+   */
+  uint32_t m_action_workers_count = 2;
+  /**
+   * @brief Executor running steps actions (Unused with 'INLINE_ACTIONS' policy).
+   * Can be shared between several sequences.
+   */
+  std::shared_ptr<ActionExecutor> m_action_executor;
+
+  /**
+   * @brief Time source (A 'VirtualClock' while simulated).
+   */
+  std::shared_ptr<Clock> m_clock;
+  /**
+   * @brief Inputs and steps trace recorder (Optional).
+   */
+  std::shared_ptr<Recorder> m_recorder;
+  /**
+   * @brief Steps and join counters journal (Optional).
+   */
+  std::shared_ptr<Persister> m_persister;
+  /**
+   * @brief Execution tracer (Optional).
+   */
+  std::shared_ptr<Tracer> m_tracer;
+  /**
+   * @brief Coverage and firing frequencies profiler (Optional).
+   */
+  std::shared_ptr<Profiler> m_profiler;
+  /**
+   * @brief Receptivity changes pushed by another process (Optional).
+   */
+  std::shared_ptr<InputRing> m_input_ring;
+  /**
+   * @brief Taken by the steps loop draining 'm_input_ring' (Single consumer).
+   */
+  std::atomic_flag m_draining_inputs = ATOMIC_FLAG_INIT;
+  /**
+   * @brief Taken by the steps loop evaluating the transitions predicates (One at a time).
+   */
+  std::atomic_flag m_sampling_predicates = ATOMIC_FLAG_INIT;
+  /**
+   * @brief Chart compiled at last start.
+   */
+  std::shared_ptr<const CompiledChart> m_chart;
+  /**
+   * @brief Publishes consistent situations to readers (Observes 'm_chart' transitions).
    */
-  std::unique_ptr<ctpl::thread_pool> m_thread_pool;
+  SituationPublisher m_situation;
+  /**
+   * @brief Arrivals at a convergence, counted without lock: one decrement per branch, preset to 'required', the branch
+   * taking it to zero launches the step and re-arms it. Own cache line: converging branches run on different workers.
+   */
+  struct alignas(64) JoinCounter {
+    const uint32_t required;
+    std::atomic_uint32_t remaining;
+
+    explicit JoinCounter(uint32_t required_count) : required(required_count), remaining(required_count) {}
+    uint32_t arrivals() const { return required - remaining.load(); }
+    void reset(uint32_t arrivals = 0) { remaining.store(required - std::min(arrivals, required - 1)); }
+  };
+  /**
+   * @brief Epoch of an enclosing step's children: bumped when they are all killed (Deactivation, forcing).
+   * Each enclosed step run keeps the epoch it was launched with, and stops as soon as it changed.
+   */
+  struct alignas(64) Scope {
+    std::atomic_uint32_t epoch{0};
+    /**
+     * @brief Children restored by 'resume': the activation steps are not launched again.
+     */
+    std::atomic_bool resumed{false};
+  };
+  /**
+   * @brief Transitions predicates of a same sampling period, evaluated together.
+   */
+  struct SamplingGroup {
+    std::chrono::nanoseconds period;
+    std::vector<uint32_t> transitions;
+    /**
+     * @brief Next sampling time (Guarded by 'm_sampling_predicates').
+     */
+    mutable int64_t next_due = 0;
+  };
+  /**
+   * @brief Next steps launched by a step run, with their activations count at launch (See 'StepActivation::setNexts').
+   */
+  struct LaunchList {
+    std::vector<std::weak_ptr<Step>> steps;
+    std::vector<uint32_t> activations;
+  };
+  /**
+   * @brief Chart the steps loops read their next transitions from, replaced as a whole by 'apply' (Never modified).
+   */
+  struct LiveGraph {
+    uint64_t version;
+    std::shared_ptr<const CompiledChart> chart;
+    /**
+     * @brief Removed step-id -> step-id to activate instead (See 'ChangeSet::mapActiveStep').
+     */
+    std::unordered_map<unsigned int, unsigned int> mapping;
+    /**
+     * @brief Join counter per step index (nullptr if the step is never reached through a 'Transition::ALL' convergence).
+     * Counters of kept steps are shared with the previous graph: no arrival is lost while swapping.
+     */
+    std::vector<std::shared_ptr<JoinCounter>> joins;
+    /**
+     * @brief Scope per step index (nullptr if not an enclosing step), shared with the previous graph like 'joins'.
+     */
+    std::vector<std::shared_ptr<Scope>> scopes;
+    /**
+     * @brief Profiling counters of 'chart' (nullptr if not profiling).
+     */
+    std::shared_ptr<ProfileCounters> profile;
+    /**
+     * @brief Activation time and dwell times per step index.
+     * Copied from the previous graph for kept steps: swapping loses no dwell time.
+     */
+    std::shared_ptr<StepTiming[]> times;
+    /**
+     * @brief Condition variable per step index, notified by a step run deactivation to the next steps it launched.
+     */
+    std::unique_ptr<std::condition_variable[]> handoffs;
+    /**
+     * @brief Two launch lists per step index, used by activation parity: a run fills one, read by its deactivation
+     * until the launched steps are activated (Before the step is activated twice more). Reserved for the widest
+     * divergence of the step: filling them never allocates.
+     */
+    std::unique_ptr<LaunchList[]> launches;
+    /**
+     * @brief Macro step id to deactivate with the step, per step index (A macro's last one, 'CompiledChart::NONE' if
+     * none). Copied from the previous graph for kept steps, like 'times'.
+     */
+    std::shared_ptr<std::atomic_uint[]> macro_deactivations;
+    /**
+     * @brief Transitions with a predicate, grouped by sampling period (Shortest first).
+     */
+    std::vector<SamplingGroup> sampling;
+    /**
+     * @brief Loops activation windows and dwell timers of 'chart' (nullptr if no watchdog limit is set).
+     */
+    std::shared_ptr<Watchdog> watchdog;
+  };
+  std::shared_ptr<const LiveGraph> m_live_graph;
+  /**
+   * @brief Version of 'm_live_graph': steps loops only compare it with theirs, and reload the graph if it changed.
+   */
+  std::atomic_uint64_t m_graph_version;
 
   /**
    * @brief Wait delay between each transition polling validity check.
@@ -71,6 +288,14 @@ private:
    * @brief Running state.
    */
   std::atomic_bool m_running;
+  /**
+   * @brief Requested with every 'm_running' clear: wakes every engine wait at once.
+   */
+  StopToken m_stop;
+  /**
+   * @brief Duration of the last 'stop' call, in nanoseconds.
+   */
+  std::atomic<int64_t> m_stop_latency{0};
   /**
    * @brief Running state.
    */
@@ -79,6 +304,10 @@ private:
    * @brief Currently running steps count.
    */
   std::atomic_uint32_t m_running_steps;
+  /**
+   * @brief Engine counters, kept across runs.
+   */
+  Metrics m_metrics;
 
   /**
    * @brief To sync steps maps access.
@@ -95,14 +324,6 @@ private:
    * @brief All steps.
    */
   std::unordered_map<unsigned int, std::shared_ptr<Step>> m_steps;
-  /**
-   * @brief Required call count per step-id, before effectively launching the step.
-   */
-  std::unordered_map<unsigned int, unsigned int> m_steps_required_call_count;
-  /**
-   * @brief Current call count per step-id, resetted when launching the step.
-   */
-  std::unordered_map<unsigned int, unsigned int> m_steps_current_call_count;
   /**
    * @brief Callbacks to trigger when the sequence state changed (running or not).
    */
@@ -112,9 +333,13 @@ private:
    */
   std::vector<std::function<void(unsigned int, bool)>> m_step_changed_callbacks;
   /**
-   * @brief Callbacks to trigger when the current step changes.
+   * @brief Loops activation rates and steps dwell limits.
+   */
+  WatchdogConfig m_watchdog_config;
+  /**
+   * @brief Callbacks to trigger on watchdog violations.
    */
-  std::unordered_map<unsigned int, unsigned int> m_macro_deactivations;
+  std::vector<std::function<void(const WatchdogEvent &)>> m_watchdog_callbacks;
 
   /**
    * @brief Run 'Sequential function chart' from start.
@@ -123,10 +348,48 @@ private:
   void run();
   /**
    * @brief Run 'Sequential function chart' from step 'step_id'.
+   * @param epoch Epoch of the enclosing step's scope when launched (Enclosed steps only).
    * @throw std::invalid_argument if step_id is not in 'm_initial_steps'.
    */
   void run(unsigned int step_id, std::shared_ptr<Step> previous_step = nullptr,
-           std::shared_ptr<std::condition_variable> cond_var = nullptr);
+           std::shared_ptr<std::condition_variable> cond_var = nullptr, std::shared_ptr<const LiveGraph> graph = nullptr,
+           uint32_t epoch = 0);
+  /**
+   * @brief Kill the children of an enclosing step, nested ones included, in one pass: their scopes epochs are bumped
+   * and their join counters cleared.
+   * @param graph
+   * @param enclosing_index
+   */
+  void killScope(const LiveGraph &graph, uint32_t enclosing_index);
+  /**
+   * @brief Launch the step mapped to removed step 'step_id', instead of it.
+   * @param step_id
+   * @param current_step The removed step.
+   * @param cond_var
+   * @param graph Graph without 'step_id'.
+   * @param launch Set to the launch list of the mapped step its next run does not use, filled with it and its
+   * activations count before launching it.
+   * @param epoch Scope epoch of the removed step.
+   * @return true if a step was launched.
+   */
+  bool handOver(unsigned int step_id, const std::shared_ptr<Step> &current_step,
+                const std::shared_ptr<std::condition_variable> &cond_var, const std::shared_ptr<const LiveGraph> &graph,
+                LaunchList *&launch, uint32_t epoch);
+
+  /**
+   * @brief Compile the chart and check that the sequence can be started.
+   * Validity checks are skipped if the chart structure is the one of the last validated chart.
+   * @return std::shared_ptr<const CompiledChart>
+   * @throw std::logic_error if all transitions are true.
+   * @throw std::runtime_error if the sequence is invalid.
+   */
+  std::shared_ptr<const CompiledChart> compileStartable();
+
+  /**
+   * @brief Install 'chart' and set the sequence running (Executors created or drained). 'start_stop_mutex' must be held.
+   * @param chart
+   */
+  void launch(std::shared_ptr<const CompiledChart> chart);
 
   /**
    * @brief Trigger all callbacks of 'm_sequence_changed_callbacks'
@@ -139,11 +402,105 @@ private:
    * @param state
    */
   void fireStepChanged(unsigned int id, bool state);
+  /**
+   * @brief Apply 'm_rt_config' and 'm_affinity_config' to newly created workers.
+   */
+  void prepareExecutor();
+  /**
+   * @brief Steps workers cap: the elastic pool one, else the pool size.
+   * @return uint32_t
+   */
+  uint32_t maxWorkers() const;
+  /**
+   * @brief Make sure a worker is available for one more step, following 'm_pool_policy'.
+   * @return true if the step can be pushed.
+   */
+  bool reserveWorker();
+  /**
+   * @brief Apply the receptivity changes pushed into 'm_input_ring', unless another steps loop is already doing it.
+   * @param chart Gives the transitions of the pushed ids (Unknown ones are ignored).
+   */
+  void drainInputs(const CompiledChart &chart);
+  /**
+   * @brief Evaluate the predicates of the sampling groups which are due, unless another steps loop is already doing it.
+   * @param graph
+   */
+  void samplePredicates(const LiveGraph &graph);
+  /**
+   * @brief Expire the watchdog dwell timers which are due, reporting the steps still active over their limit.
+   * @param graph
+   */
+  void pollWatchdog(const LiveGraph &graph);
+  /**
+   * @brief Count a watchdog violation and trigger the watchdog callbacks, then stop the sequence if configured so.
+   * @param event
+   * @return true if this call stopped the sequence (Its stop code set, 'fireSequenceChanged' left to the caller).
+   */
+  bool reportViolation(const WatchdogEvent &event);
+  /**
+   * @brief Reserve the executor task slots of the hot path (Real-time mode): launch lists and macros slots are
+   * allocated with the live graph.
+   */
+  void prepareRealTime();
+  /**
+   * @brief Push a step task to 'm_thread_pool', counting a real-time violation if it had to be allocated.
+   * @param f
+   */
+  template <typename F> void pushStep(F &&f) {
+    if (!m_thread_pool->push(std::forward<F>(f)) && m_rt_config.enabled()) {
+      m_rt_violations++;
+    }
+  }
+  /**
+   * @brief Timing of step 'id' in 'graph'.
+   * @param graph
+   * @param id
+   * @return const StepTiming* nullptr if never started ('graph' is nullptr).
+   * @throw std::invalid_argument if id is not a step of 'graph'.
+   */
+  const StepTiming *stepTiming(const LiveGraph *graph, unsigned int id) const;
+  /**
+   * @brief Compute 'm_step_branches' (Branches pinning, tracing).
+   */
+  void prepareBranches();
+  /**
+   * @brief To know if steps have to be pinned on their simultaneous branch core.
+   * @return true
+   * @return false
+   */
+  bool pinBranches() const;
+  /**
+   * @brief Make 'chart' the live and published one, and observe its transitions (Forwarding to 'm_recorder').
+   * Transitions which are no more in the chart are not observed anymore.
+   * @param chart
+   * @param mapping Active steps mapping (See 'LiveGraph').
+   * @param keep_joins Keep the join counters of the current live graph (Else they start from zero).
+   */
+  void installChart(std::shared_ptr<const CompiledChart> chart,
+                    const std::unordered_map<unsigned int, unsigned int> &mapping = {}, bool keep_joins = false);
+  /**
+   * @brief Stop observing 'm_chart' transitions.
+   */
+  void detachObservers();
+  /**
+   * @brief Check the steps modified by a change set, in the changed chart.
+   * Local checks only (No simultaneous divergences nor loop checks): the whole chart is checked at next start.
+   * @param chart Changed chart.
+   * @param changed_steps Added steps, and steps whose transitions changed.
+   * @param removed_steps
+   * @param mapping
+   * @throw std::runtime_error if the changed chart would be invalid.
+   */
+  void validateChanges(const CompiledChart &chart, const std::vector<std::shared_ptr<Step>> &changed_steps,
+                       const std::vector<std::shared_ptr<Step>> &removed_steps,
+                       const std::unordered_map<unsigned int, unsigned int> &mapping) const;
 
 public:
   static constexpr uint32_t NORMAL_STOP = 0;
   static constexpr uint32_t CRAZY_LOOPING_STOP = 666;
   static constexpr uint32_t CRAZY_PARALLELISM_STOP = 667;
+  static constexpr uint32_t EXECUTOR_EXHAUSTED_STOP = 668;
+  static constexpr uint32_t DWELL_TIMEOUT_STOP = 669;
 
   /**
    * @brief Default constructor.
@@ -169,11 +526,259 @@ public:
    * @param delay
    */
   void setTransitionPollingDelay(unsigned int delay);
+  /**
+   * @brief Get the Clock used by the sequence (A 'VirtualClock' while simulated, see 'Simulation').
+   * @return std::shared_ptr<Clock>
+   */
+  std::shared_ptr<Clock> getClock() const;
+
+  /**
+   * @brief Get the Action Policy.
+   * @return ActionPolicy
+   */
+  ActionPolicy getActionPolicy() const;
+  /**
+   * @brief Set the Action Policy.
+   * The 'ActionExecutor' is created at start if needed (and not already set).
+   * @param policy
+   * @param workers_count Actions workers count, if the executor has to be created.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setActionPolicy(ActionPolicy policy, uint32_t workers_count = 2);
+  /**
+   * @brief Get the Action Executor.
+   * @return std::shared_ptr<ActionExecutor> nullptr if not yet created.
+   */
+  std::shared_ptr<ActionExecutor> getActionExecutor() const;
+  /**
+   * @brief Set the Action Executor, to share it between several sequences.
+   * @param executor
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setActionExecutor(std::shared_ptr<ActionExecutor> executor);
+  /**
+   * @brief Get the Watchdog Config.
+   * @return const WatchdogConfig&
+   */
+  const WatchdogConfig &getWatchdogConfig() const;
+  /**
+   * @brief Set the Watchdog Config: loops activation rates and steps dwell limits, checked while running (Not simulated).
+   * Runaway loops stop the sequence as crazy-looping ('CRAZY_LOOPING_STOP'), steps active too long with
+   * 'DWELL_TIMEOUT_STOP' (Unless 'WatchdogConfig::stop_on_violation' is false): see 'addWatchdogCallback' to be told.
+   * Without loops limit, 'PoolPolicy::max_activations' is used (See 'setPoolPolicy').
+   * @param config
+   * @throw std::runtime_error if the sequence is running.
+   */
+  void setWatchdogConfig(const WatchdogConfig &config);
+  /**
+   * @brief Get the Pool Policy.
+   * @return const PoolPolicy&
+   */
+  const PoolPolicy &getPoolPolicy() const;
+  /**
+   * @brief Set the Pool Policy: how steps launches deal with busy workers, and runaway loops detection.
+   * @param policy
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setPoolPolicy(const PoolPolicy &policy);
+  /**
+   * @brief Get the Real Time Config.
+   * @return const RealTimeConfig&
+   */
+  const RealTimeConfig &getRealTimeConfig() const;
+  /**
+   * @brief Set the Real Time Config (Opt-in soft real-time mode).
+   * When enabled, at start:
+   * - Steps workers get the configured scheduling policy/priority and prefaulted stacks.
+   * - Process memory is locked if requested.
+   * - Every container touched by the hot path is reserved/pre-populated.
+   * @note The initial step runs on the thread calling 'start', which is left untouched.
+   * @param config
+   * @throw std::runtime_error if sequence is running.
+   * @throw std::invalid_argument if the prefaulted stack does not fit in the workers stack.
+   */
+  void setRealTimeConfig(const RealTimeConfig &config);
+  /**
+   * @brief Get the Real Time Violations count: allocations left on the hot path (See 'm_rt_violations').
+   * @return uint64_t
+   */
+  uint64_t getRealTimeViolations() const;
+  /**
+   * @brief Get the count of starts which reused parked workers (No thread spawned).
+   * @return uint64_t
+   */
+  uint64_t getWarmStartsCount() const;
+  /**
+   * @brief Get the Affinity Config.
+   * @return const AffinityConfig&
+   */
+  const AffinityConfig &getAffinityConfig() const;
+  /**
+   * @brief Set the Affinity Config.
+   * @param config
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setAffinityConfig(const AffinityConfig &config);
+  /**
+   * @brief Get the actual steps workers placement.
+   * @return std::vector<WorkerPlacement> Empty if never started (Or settings changed since).
+   */
+  std::vector<WorkerPlacement> getWorkersPlacement();
+  /**
+   * @brief Get the simultaneous branch index of a step (Only computed when pinning branches).
+   * @param id
+   * @return int -1 if unknown.
+   */
+  int getStepBranch(unsigned int id) const;
+  /**
+   * @brief Get the Recorder.
+   * @return std::shared_ptr<Recorder> nullptr if not recording.
+   */
+  std::shared_ptr<Recorder> getRecorder() const;
+  /**
+   * @brief Set the Recorder.
+   * Every receptivity change and step activation change is recorded, from the next start.
+   * Receptivity changes keep being recorded while stopped, until the recorder is removed.
+   * @param recorder nullptr to stop recording.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setRecorder(std::shared_ptr<Recorder> recorder);
+  /**
+   * @brief Get the Tracer.
+   * @return std::shared_ptr<Tracer> nullptr if not tracing.
+   */
+  std::shared_ptr<Tracer> getTracer() const;
+  /**
+   * @brief Set the Tracer.
+   * From the next start, steps runs (Worker, branch, actions, handoff wait, callbacks) and transitions firings are traced.
+   * @param tracer nullptr to stop tracing.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setTracer(std::shared_ptr<Tracer> tracer);
+  /**
+   * @brief Get the Profiler.
+   * @return std::shared_ptr<Profiler> nullptr if not profiling.
+   */
+  std::shared_ptr<Profiler> getProfiler() const;
+  /**
+   * @brief Set the Profiler.
+   * From the next start, steps activations and transitions evaluations and firings are counted (Simulations included).
+   * @param profiler nullptr to stop profiling.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setProfiler(std::shared_ptr<Profiler> profiler);
+  /**
+   * @brief Get the Persister.
+   * @return std::shared_ptr<Persister> nullptr if not persisting.
+   */
+  std::shared_ptr<Persister> getPersister() const;
+  /**
+   * @brief Set the Persister.
+   * From the next start, steps activations and join counters are journaled, and checkpointed (See 'Persister').
+   * @note Starting takes a checkpoint of the new run: 'Persister::recover' must be called before.
+   * @param persister nullptr to stop persisting.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setPersister(std::shared_ptr<Persister> persister);
+  /**
+   * @brief Get the InputRing.
+   * @return std::shared_ptr<InputRing> nullptr if none.
+   */
+  std::shared_ptr<InputRing> getInputRing() const;
+  /**
+   * @brief Set the InputRing.
+   * While running, receptivity changes pushed into it are applied by the transitions polling (Simulation ticks included),
+   * transition ids being the compiled chart ones (See 'getCompiledChart').
+   * @param input_ring nullptr to stop reading it.
+   * @throw std::runtime_error if sequence is running.
+   */
+  void setInputRing(std::shared_ptr<InputRing> input_ring);
+  /**
+   * @brief Get the chart compiled at last start (Gives the transitions indexes used by the 'Recorder' and the 'Situation').
+   * @return std::shared_ptr<const CompiledChart> nullptr if never compiled.
+   */
+  std::shared_ptr<const CompiledChart> getCompiledChart() const;
+  /**
+   * @brief Get the engine counters (Transitions evaluated and fired, activations, empty polls, callbacks time).
+   * @return const Metrics&
+   */
+  const Metrics &getMetrics() const;
+  /**
+   * @brief Get the engine counters, plus the gauges of the sequence and of its executors
+   * (Active and running steps, queue depths, idle workers...), e.g. for a 'PrometheusExporter'.
+   * @param labels Added to every sample.
+   * @return std::vector<MetricSample>
+   */
+  std::vector<MetricSample> collectMetrics(const std::string &labels = "") const;
+  /**
+   * @brief Get a consistent copy of the current situation (Active steps and receptivities), without locking.
+   * Never sees a handoff in progress (Previous step deactivated, next one not yet activated).
+   * @return Situation Empty if never started.
+   */
+  Situation getSituation() const;
+  /**
+   * @brief Non-retrying version of 'getSituation'.
+   * @param situation Filled, even if inconsistent.
+   * @return true if 'situation' is consistent.
+   */
+  bool tryGetSituation(Situation &situation) const;
+  /**
+   * @brief Sleep until 'predicate' is true on a consistent situation (No polling: woken up on each change).
+   * @note Timeouts are in real time, even while simulated.
+   * @param predicate
+   * @param timeout 'std::chrono::nanoseconds::max()' to wait forever.
+   * @return false on timeout.
+   */
+  bool awaitSituation(const std::function<bool(const Situation &)> &predicate,
+                      std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const;
+  /**
+   * @brief Sleep until step 'id' activation state is 'active'.
+   * Can be called before start: waits for the sequence to be started.
+   * @param id
+   * @param active
+   * @param timeout 'std::chrono::nanoseconds::max()' to wait forever.
+   * @return false on timeout.
+   * @throw std::invalid_argument if id is not a sequence step.
+   */
+  bool awaitStep(unsigned int id, bool active = true,
+                 std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const;
+  /**
+   * @brief Sleep until one of 'ids' activation state is 'active'.
+   * @param ids
+   * @param active
+   * @param timeout 'std::chrono::nanoseconds::max()' to wait forever.
+   * @return int The first matching id (In 'ids' order), -1 on timeout.
+   * @throw std::invalid_argument if an id is not a sequence step.
+   */
+  int awaitAny(const std::vector<unsigned int> &ids, bool active = true,
+               std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const;
+  /**
+   * @brief Sleep until no transition can be crossed (No active step with a true next transition).
+   * @param timeout 'std::chrono::nanoseconds::max()' to wait forever.
+   * @return false on timeout.
+   */
+  bool awaitStable(std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max()) const;
   /**
    * @brief Add Step to Sequence.
    * @param step
    */
   void addStep(std::shared_ptr<Step> step);
+  /**
+   * @brief Apply chart modifications at once, even while running.
+   * The changed chart is compiled and checked off to the side (Only the changed region), then swapped in:
+   * each running step picks it up at its next transitions polling, and an active removed step hands over to its mapped step.
+   * @param changes
+   * @note Transitions indexes (Used by the 'Recorder' and the 'Situation') are the ones of the new compiled chart.
+   * Situations read once it returned are the ones of the new chart.
+   * @throw std::invalid_argument if a step id is already used, or unknown, or if a transition refers to a removed step.
+   * @throw std::runtime_error if the changed chart would be invalid (Nothing is modified then).
+   */
+  void apply(const ChangeSet &changes);
+  /**
+   * @brief Get the version of the chart steps run from (Incremented at each start and 'apply').
+   * @return uint64_t
+   */
+  uint64_t getGraphVersion() const;
 
   /**
    * @brief Check the consistency of the sequence:
@@ -217,6 +822,16 @@ public:
    */
   void clearStepChangedCallback();
 
+  /**
+   * @brief Add new callback to 'm_watchdog_callbacks' (Called by the thread detecting the violation).
+   * @param cb
+   */
+  void addWatchdogCallback(std::function<void(const WatchdogEvent &)> cb);
+  /**
+   * @brief Clear all of 'm_watchdog_callbacks'
+   */
+  void clearWatchdogCallback();
+
   /**
    * @brief Return true if step_id is in sequence.
    * @param id
@@ -244,14 +859,54 @@ public:
    * @return std::vector<unsigned int>
    */
   const std::vector<std::shared_ptr<Step>> getActivatedSteps() const;
+  /**
+   * @brief Grafcet X.T: time since the activation of step 'id', on the sequence clock.
+   * @param id
+   * @return std::chrono::nanoseconds 0 if not active.
+   * @throw std::invalid_argument if id is not a step of the running (Or last run) chart.
+   */
+  std::chrono::nanoseconds getStepElapsed(unsigned int id) const;
+  /**
+   * @brief Dwell times of step 'id' (Activation to deactivation), since the last start.
+   * @param id
+   * @return DwellHistogram Empty if never started.
+   * @throw std::invalid_argument if id is not a step of the running (Or last run) chart.
+   */
+  DwellHistogram getStepDwell(unsigned int id) const;
 
   /**
    * @brief Start 'Sequential function chart'.
    */
   void start(unsigned int init_step_id = 0);
 
+  /**
+   * @brief Start 'Sequential function chart' from a persisted state (See 'Persister::recover').
+   * Every active step of 'snapshot' is run again (Its actions included), join counters are restored.
+   * @param snapshot
+   * @throw std::invalid_argument if 'snapshot' is empty, or is not a state of this chart.
+   */
+  void resume(const Snapshot &snapshot);
+
+  /**
+   * @brief Grafcet forcing order: put the child charts of an enclosing step in the situation 'steps'.
+   * Every enclosed step is deactivated (Nested ones included), then 'steps' are activated.
+   * Not to be called from the actions of the forced steps themselves.
+   * @param enclosing_id Active enclosing step.
+   * @param steps Directly enclosed steps to activate (Empty: children are only killed).
+   * @throw std::invalid_argument if 'enclosing_id' is not an enclosing step, or a step is not directly enclosed by it.
+   * @throw std::runtime_error if the sequence or the enclosing step is not running.
+   */
+  void force(unsigned int enclosing_id, const std::vector<unsigned int> &steps);
+
   /**
    * @brief Stop 'Sequential function chart'.
+   * Every engine wait (Transitions polling, previous step handoff, actions, backpressure) is cancelled at once:
+   * returns as soon as the running actions return (Not interrupted), whatever the polling delay.
    */
   void stop(bool fire = true);
+  /**
+   * @brief Get the duration of the last 'stop' call (Until every step run returned).
+   * @return std::chrono::nanoseconds
+   */
+  std::chrono::nanoseconds getStopLatency() const;
 };
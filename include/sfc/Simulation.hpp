@@ -0,0 +1,238 @@
+#pragma once
+
+#include "sfc/CompiledChart.hpp"
+#include "sfc/Sequence.hpp"
+#include "sfc/clock/Clock.hpp"
+#include "sfc/persist/Snapshot.hpp"
+#include "sfc/profile/Profiler.hpp"
+#include "sfc/step/StepTiming.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Deterministic, single-threaded execution of a sequence against a 'VirtualClock'.
+ * - Each 'tick' is one transition polling period: every active step evaluates its transitions once,
+ *   in activation order, then virtual time moves forward by the sequence polling delay.
+ * - Steps, transitions, actions and callbacks are the sequence's ones, actions always run inline.
+ * - When a tick crosses nothing, virtual time jumps directly to the next predicates sampling (See
+ *   'Transition::setPredicate'), or to the end of the simulated duration if no predicate: hours of timed behaviour are
+ *   simulated in milliseconds. Timed conditions (e.g. on 'Sequence::getStepElapsed') are only seen on time if they
+ *   are predicates, receptivities set between calls are seen by the next tick.
+ * - No thread is spawned: receptivities are set between calls, by the test or by the actions themselves.
+ * - 'evolve' is the Grafcet synchronous evolution: crossable transitions are crossed together, again and again from
+ *   the new situation until a stable one, at the same instant. 'runSynchronous' runs it in real time, as an
+ *   alternative engine to the threaded one ('Sequence::start').
+ */
+class Simulation {
+private:
+  Sequence &seq;
+  /**
+   * @brief Virtual time source, installed into the sequence while simulating.
+   */
+  std::shared_ptr<VirtualClock> m_clock;
+  /**
+   * @brief Clock of the sequence before simulating, restored at stop.
+   */
+  std::shared_ptr<Clock> m_previous_clock;
+  std::shared_ptr<const CompiledChart> m_chart;
+  /**
+   * @brief Version of the sequence live graph 'm_chart' comes from (See 'Sequence::apply').
+   */
+  uint64_t m_graph_version = 0;
+  /**
+   * @brief Profiling counters of 'm_chart' (nullptr if not profiling).
+   */
+  std::shared_ptr<ProfileCounters> m_profile;
+  /**
+   * @brief Activation and dwell times of 'm_chart' steps (See 'Sequence::getStepElapsed').
+   */
+  std::shared_ptr<StepTiming[]> m_times;
+
+  /**
+   * @brief Per step index: activation state.
+   */
+  std::vector<uint8_t> m_active;
+  /**
+   * @brief Join counters of 'm_chart' (Those of the live graph: read by the persister checkpoints).
+   */
+  std::vector<std::shared_ptr<Sequence::JoinCounter>> m_joins;
+  /**
+   * @brief Per step index: macro to deactivate when this step (a macro's last one) deactivates.
+   */
+  std::vector<uint32_t> m_macro_deactivations;
+  /**
+   * @brief Per step index: evolution it was last activated in (Tells transient steps, See 'evolve').
+   */
+  std::vector<uint64_t> m_activation_evolutions;
+  /**
+   * @brief Active steps indexes, in activation order.
+   */
+  std::vector<uint32_t> m_active_steps;
+  /**
+   * @brief Scratch buffers (Avoid allocating on every tick).
+   */
+  std::vector<uint32_t> m_evaluated_steps;
+  std::vector<uint32_t> m_to_activate;
+
+  uint64_t m_ticks = 0;
+  uint64_t m_fired_count = 0;
+  uint64_t m_activations_count = 0;
+  uint64_t m_evolutions = 0;
+  bool m_evolving = false;
+  uint64_t m_transient_count = 0;
+
+  /**
+   * @brief Activate a step (And the activation steps of an enclosing step, if 'propagate').
+   */
+  void activate(uint32_t step_index, bool propagate = true);
+  /**
+   * @brief Deactivate a step (And every step enclosed by an enclosing step).
+   */
+  void deactivate(uint32_t step_index);
+  /**
+   * @brief Deactivate the children of an enclosing step, nested ones included, and clear their join counters.
+   */
+  void killChildren(uint32_t enclosing_index);
+  /**
+   * @brief Cross every crossable transition of the active steps at once, then activate the next steps.
+   * @return true if at least one transition was crossed.
+   */
+  bool cross();
+  /**
+   * @brief Reset per step states for 'm_chart', install the virtual clock and set the sequence running.
+   */
+  void launch();
+  /**
+   * @brief Switch to the sequence live graph, changed by 'Sequence::apply' (At a tick boundary).
+   * Per step states are carried over by step id, active removed steps are replaced by their mapped ones.
+   */
+  void adoptGraph();
+  /**
+   * @brief Time of the next predicates sampling of the live graph, if before 'deadline' (Never before now).
+   */
+  std::chrono::nanoseconds nextSampling(std::chrono::nanoseconds deadline) const;
+
+public:
+  /**
+   * @brief Construct a new Simulation of 'seq'.
+   * @param seq Must outlive the simulation.
+   * @param start Initial virtual time.
+   */
+  Simulation(Sequence &seq, std::chrono::nanoseconds start = std::chrono::nanoseconds(0));
+  /**
+   * @brief Destroy the Simulation. Stop it if needed.
+   */
+  ~Simulation();
+
+  /**
+   * @brief Start simulating from 'init_step_id', same checks than 'Sequence::start'.
+   * @param init_step_id
+   * @throw std::logic_error, std::runtime_error Like 'Sequence::start'.
+   * @throw std::invalid_argument if init_step_id is not a sequence step.
+   */
+  void start(unsigned int init_step_id = 0);
+  /**
+   * @brief Start simulating from a persisted state, like 'Sequence::resume'.
+   * @note Virtual time starts at the simulation start time: construct it with 'snapshot.time' to continue from there.
+   * @param snapshot
+   * @throw std::invalid_argument if 'snapshot' is not a state of this chart.
+   */
+  void resume(const Snapshot &snapshot);
+  /**
+   * @brief Grafcet forcing order, at once (See 'Sequence::force').
+   * @param enclosing_id Active enclosing step.
+   * @param steps Directly enclosed steps to activate.
+   * @throw std::invalid_argument if 'enclosing_id' is not an enclosing step, or a step is not directly enclosed by it.
+   * @throw std::runtime_error if the simulation or the enclosing step is not running.
+   */
+  void force(unsigned int enclosing_id, const std::vector<unsigned int> &steps);
+  /**
+   * @brief Stop simulating.
+   */
+  void stop();
+
+  /**
+   * @brief One transition polling period.
+   * @return true if at least one transition was crossed.
+   */
+  bool tick();
+  /**
+   * @brief Grafcet synchronous evolution, for the current input image (Receptivities, input ring drained once):
+   * all crossable transitions are crossed together, then the ones of the new situation, until no transition can be
+   * crossed anymore. Virtual time does not move, the whole evolution is published at once, and steps activated then
+   * deactivated by the same evolution (Transient steps) never wait for a polling period (See 'transientCount').
+   * @param max_rounds Give up after this crossing rounds count (Unstable chart: a cycle of true transitions).
+   * @return true if a stable situation is reached.
+   */
+  bool evolve(uint32_t max_rounds = 1000);
+  /**
+   * @brief Synchronous evolution in real time, on the calling thread: 'evolve' once per polling delay, virtual time
+   * following the steady clock. Returns (Stopped) once the sequence is stopped, by 'Sequence::stop' or an action.
+   */
+  void runSynchronous();
+  /**
+   * @brief Simulate 'duration' of virtual time: ticks, then jumps to the next predicates sampling when a tick crosses
+   * nothing.
+   * @param duration
+   */
+  void advance(std::chrono::nanoseconds duration);
+  /**
+   * @brief Simulate until 'predicate' is true, or until 'timeout' of virtual time elapsed (Like 'advance': 'predicate'
+   * is checked after each tick and each jump).
+   * @param predicate
+   * @param timeout
+   * @return true if 'predicate' is true.
+   */
+  bool runUntil(const std::function<bool()> &predicate, std::chrono::nanoseconds timeout = std::chrono::hours(24));
+  /**
+   * @brief Simulate until no transition can be crossed anymore.
+   * @param max_ticks Give up after this ticks count (A chart can loop forever).
+   * @return true if stable.
+   */
+  bool runUntilStable(uint64_t max_ticks = 1000000);
+
+  /**
+   * @brief Current virtual time.
+   * @return std::chrono::nanoseconds
+   */
+  std::chrono::nanoseconds now() const;
+  /**
+   * @brief Get the Clock.
+   * @return std::shared_ptr<VirtualClock>
+   */
+  std::shared_ptr<VirtualClock> getClock() const;
+  /**
+   * @brief Get the simulated chart.
+   * @return std::shared_ptr<const CompiledChart> nullptr if never started.
+   */
+  std::shared_ptr<const CompiledChart> getCompiledChart() const;
+  /**
+   * @brief Active steps ids, in activation order.
+   * @return std::vector<unsigned int>
+   */
+  std::vector<unsigned int> getActivatedSteps() const;
+
+  /**
+   * @brief Evaluated polling periods count.
+   */
+  uint64_t ticksCount() const;
+  /**
+   * @brief Crossed transitions count.
+   */
+  uint64_t firedCount() const;
+  /**
+   * @brief Steps activations count.
+   */
+  uint64_t activationsCount() const;
+  /**
+   * @brief Synchronous evolutions count (See 'evolve').
+   */
+  uint64_t evolutionsCount() const;
+  /**
+   * @brief Steps activated then deactivated by one synchronous evolution.
+   */
+  uint64_t transientCount() const;
+};
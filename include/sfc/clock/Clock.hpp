@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Time source of the engine.
+ * Every time-dependent feature reads the time through it, so that it can be driven by a 'VirtualClock'.
+ */
+class Clock {
+public:
+  virtual ~Clock() = default;
+
+  /**
+   * @brief Current monotonic time, since an unspecified epoch.
+   * @return std::chrono::nanoseconds
+   */
+  virtual std::chrono::nanoseconds now() const = 0;
+};
+
+/**
+ * @brief Real time, based on 'std::chrono::steady_clock'.
+ */
+class SteadyClock : public Clock {
+public:
+  std::chrono::nanoseconds now() const override;
+};
+
+/**
+ * @brief Virtual time, only moving when explicitly advanced.
+ */
+class VirtualClock : public Clock {
+private:
+  /**
+   * @brief Current time, in nanoseconds.
+   */
+  std::atomic<int64_t> m_now;
+
+public:
+  /**
+   * @brief Construct a new Virtual Clock.
+   * @param start Initial time.
+   */
+  VirtualClock(std::chrono::nanoseconds start = std::chrono::nanoseconds(0));
+
+  std::chrono::nanoseconds now() const override;
+  /**
+   * @brief Move time forward.
+   * @param duration
+   * @throw std::invalid_argument if duration is negative.
+   */
+  void advance(std::chrono::nanoseconds duration);
+  /**
+   * @brief Move time forward up to 'time'.
+   * @param time
+   * @throw std::invalid_argument if 'time' is in the past.
+   */
+  void advanceTo(std::chrono::nanoseconds time);
+};
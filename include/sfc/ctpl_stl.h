@@ -19,13 +19,15 @@
 #ifndef __ctpl_stl_thread_pool_H__
 #define __ctpl_stl_thread_pool_H__
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <exception>
 #include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <thread>
 #include <vector>
 
@@ -37,31 +39,58 @@
 namespace ctpl {
 
 namespace detail {
+// ring buffer: no allocation while it holds at most its capacity (doubled when full)
 template <typename T> class Queue {
 public:
   bool push(T const &value) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    this->q.push(value);
+    if (this->count == this->ring.size())
+      this->grow(std::max<std::size_t>(2 * this->ring.size(), 16));
+    this->ring[(this->head + this->count) % this->ring.size()] = value;
+    ++this->count;
     return true;
   }
   // deletes the retrieved element, do not use for non integral types
   bool pop(T &v) {
     std::unique_lock<std::mutex> lock(this->mutex);
-    if (this->q.empty())
+    if (this->count == 0)
       return false;
-    v = this->q.front();
-    this->q.pop();
+    v = this->ring[this->head];
+    this->head = (this->head + 1) % this->ring.size();
+    --this->count;
     return true;
   }
   bool empty() {
     std::unique_lock<std::mutex> lock(this->mutex);
-    return this->q.empty();
+    return this->count == 0;
+  }
+  // room for capacity elements
+  void reserve(std::size_t capacity) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (capacity > this->ring.size())
+      this->grow(capacity);
   }
 
 private:
-  std::queue<T> q;
+  void grow(std::size_t capacity) {
+    std::vector<T> grown(capacity);
+    for (std::size_t i = 0; i < this->count; ++i)
+      grown[i] = this->ring[(this->head + i) % this->ring.size()];
+    this->ring.swap(grown);
+    this->head = 0;
+  }
+
+  std::vector<T> ring;
+  std::size_t head = 0;
+  std::size_t count = 0;
   std::mutex mutex;
 };
+
+// a queued function: deleted once run, unless borrowed (owned by its pusher)
+struct Job {
+  std::function<void(int id)> *f = nullptr;
+  bool borrowed = false;
+};
 } // namespace detail
 
 class thread_pool {
@@ -77,16 +106,49 @@ public:
   ~thread_pool() { this->stop(true); }
 
   // get the number of running threads in the pool
-  int size() { return static_cast<int>(this->threads.size()); }
+  int size() { return this->nThreads; }
 
   // number of idle threads
   int n_idle() { return this->nWaiting; }
   std::thread &get_thread(int i) { return *this->threads[i]; }
 
+  // call f(index, thread) for each thread still in the pool, under the threads lock: none retires meanwhile
+  template <typename F> void for_each_thread(F &&f) {
+    std::lock_guard<std::mutex> lock(this->threadsMutex);
+    for (int i = 0, n = static_cast<int>(this->threads.size()); i < n; ++i) {
+      if (!*this->flags[i])
+        f(i, *this->threads[i]);
+    }
+  }
+
+  // elastic pool: threads beyond the first minThreads ones retire (last one first) after idleTimeout without task
+  void set_idle_timeout(int minThreads, std::chrono::milliseconds idleTimeout) {
+    this->minThreads = minThreads;
+    this->idleTimeout = idleTimeout.count();
+  }
+
+  // add one thread, if the pool has less than maxThreads ones
+  // prepare(index) is called before the new thread starts
+  // returns false if the pool is full or stopped
+  template <typename F> bool grow(int maxThreads, F &&prepare) {
+    std::lock_guard<std::mutex> lock(this->threadsMutex);
+    int i = static_cast<int>(this->threads.size());
+    if (i >= maxThreads || this->isDone || this->isStop)
+      return false;
+    this->threads.resize(i + 1);
+    this->flags.resize(i + 1);
+    this->flags[i] = std::make_shared<std::atomic<bool>>(false);
+    prepare(i);
+    this->set_thread(i);
+    this->nThreads = i + 1;
+    return true;
+  }
+
   // change the number of threads in the pool
   // should be called from one thread, otherwise be careful to not interleave, also with this->stop()
   // nThreads must be >= 0
   void resize(int nThreads) {
+    std::lock_guard<std::mutex> threadsLock(this->threadsMutex);
     if (!this->isStop && !this->isDone) {
       int oldNThreads = static_cast<int>(this->threads.size());
       if (oldNThreads <= nThreads) { // if the number of threads is increased
@@ -110,27 +172,40 @@ public:
         this->threads.resize(nThreads); // safe to delete because the threads are detached
         this->flags.resize(nThreads); // safe to delete because the threads have copies of shared_ptr of the flags, not originals
       }
+      this->nThreads = nThreads;
     }
   }
 
   // empty the queue
   void clear_queue() {
-    std::function<void(int id)> *_f;
-    while (this->q.pop(_f))
-      delete _f; // empty the queue
+    detail::Job _j;
+    while (this->q.pop(_j))
+      if (!_j.borrowed)
+        delete _j.f; // empty the queue
   }
 
   // pops a functional wrapper to the original function
   std::function<void(int)> pop() {
-    std::function<void(int id)> *_f = nullptr;
-    this->q.pop(_f);
-    std::unique_ptr<std::function<void(int id)>> func(_f); // at return, delete the function even if an exception occurred
+    detail::Job _j;
+    this->q.pop(_j);
+    std::unique_ptr<std::function<void(int id)>> func(_j.borrowed ? nullptr : _j.f); // at return, delete the function even if an exception occurred
     std::function<void(int)> f;
-    if (_f)
-      f = *_f;
+    if (_j.f)
+      f = *_j.f;
     return f;
   }
 
+  // queue room for capacity functions: pushing no more than that does not grow it
+  void reserve(int capacity) { this->q.reserve(capacity); }
+
+  // run f, which stays owned by the caller (not deleted, must outlive its run): no allocation while the queue has room
+  // exceptions thrown by f are dropped
+  void push_borrowed(std::function<void(int id)> *f) {
+    this->q.push({f, true});
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->cv.notify_one();
+  }
+
   // wait for all computing threads to finish and stop all threads
   // may be called asynchronously to not pause the calling thread while waiting
   // if isWait == true, all the functions in the queue are run, otherwise the queue is cleared without running the functions
@@ -139,8 +214,11 @@ public:
       if (this->isStop)
         return;
       this->isStop = true;
-      for (int i = 0, n = this->size(); i < n; ++i) {
-        *this->flags[i] = true; // command the threads to stop
+      {
+        std::lock_guard<std::mutex> threadsLock(this->threadsMutex);
+        for (int i = 0, n = static_cast<int>(this->flags.size()); i < n; ++i) {
+          *this->flags[i] = true; // command the threads to stop
+        }
       }
       this->clear_queue(); // empty the queue
     } else {
@@ -152,22 +230,28 @@ public:
       std::unique_lock<std::mutex> lock(this->mutex);
       this->cv.notify_all(); // stop all waiting threads
     }
-    for (int i = 0; i < static_cast<int>(this->threads.size()); ++i) { // wait for the computing threads to finish
-      if (this->threads[i]->joinable())
-        this->threads[i]->join();
+    // taken out of the pool first: a computing thread may be growing it
+    std::vector<std::unique_ptr<std::thread>> stopped;
+    {
+      std::lock_guard<std::mutex> threadsLock(this->threadsMutex);
+      stopped.swap(this->threads);
+      this->flags.clear();
+      this->nThreads = 0;
+    }
+    for (auto &thread : stopped) { // wait for the computing threads to finish
+      if (thread->joinable())
+        thread->join();
     }
     // if there were no threads in the pool but some functors in the queue, the functors are not deleted by the threads
     // therefore delete them here
     this->clear_queue();
-    this->threads.clear();
-    this->flags.clear();
   }
 
   template <typename F, typename... Rest> auto push(F &&f, Rest &&...rest) -> std::future<decltype(f(0, rest...))> {
     auto pck = std::make_shared<std::packaged_task<decltype(f(0, rest...))(int)>>(
         std::bind(std::forward<F>(f), std::placeholders::_1, std::forward<Rest>(rest)...));
     auto _f = new std::function<void(int id)>([pck](int id) { (*pck)(id); });
-    this->q.push(_f);
+    this->q.push({_f, false});
     std::unique_lock<std::mutex> lock(this->mutex);
     this->cv.notify_one();
     return pck->get_future();
@@ -178,7 +262,7 @@ public:
   template <typename F> auto push(F &&f) -> std::future<decltype(f(0))> {
     auto pck = std::make_shared<std::packaged_task<decltype(f(0))(int)>>(std::forward<F>(f));
     auto _f = new std::function<void(int id)>([pck](int id) { (*pck)(id); });
-    this->q.push(_f);
+    this->q.push({_f, false});
     std::unique_lock<std::mutex> lock(this->mutex);
     this->cv.notify_one();
     return pck->get_future();
@@ -195,24 +279,42 @@ private:
     std::shared_ptr<std::atomic<bool>> flag(this->flags[i]); // a copy of the shared ptr to the flag
     auto f = [this, i, flag /* a copy of the shared ptr to the flag */]() {
       std::atomic<bool> &_flag = *flag;
-      std::function<void(int id)> *_f;
-      bool isPop = this->q.pop(_f);
+      detail::Job _j;
+      bool isPop = this->q.pop(_j);
       while (true) {
-        while (isPop) {                                          // if there is anything in the queue
-          std::unique_ptr<std::function<void(int id)>> func(_f); // at return, delete the function even if an exception occurred
-          (*_f)(i);
+        while (isPop) { // if there is anything in the queue
+          // at return, delete the function even if an exception occurred
+          std::unique_ptr<std::function<void(int id)>> func(_j.borrowed ? nullptr : _j.f);
+          if (_j.borrowed) {
+            try {
+              (*_j.f)(i);
+            } catch (...) {
+            }
+          } else {
+            (*_j.f)(i);
+          }
           if (_flag)
             return; // the thread is wanted to stop, return even if the queue is not empty yet
           else
-            isPop = this->q.pop(_f);
+            isPop = this->q.pop(_j);
         }
         // the queue is empty here, wait for the next command
         std::unique_lock<std::mutex> lock(this->mutex);
         ++this->nWaiting;
-        this->cv.wait(lock, [this, &_f, &isPop, &_flag]() {
-          isPop = this->q.pop(_f);
+        auto ready = [this, &_j, &isPop, &_flag]() {
+          isPop = this->q.pop(_j);
           return isPop || this->isDone || _flag;
-        });
+        };
+        if (i >= this->minThreads && this->idleTimeout > 0) {
+          while (!this->cv.wait_for(lock, std::chrono::milliseconds(this->idleTimeout), ready)) {
+            if (this->retire(i)) {
+              --this->nWaiting;
+              return; // detached and out of the pool
+            }
+          }
+        } else {
+          this->cv.wait(lock, ready);
+        }
         --this->nWaiting;
         if (!isPop)
           return; // if the queue is empty and this->isDone == true or *flag then return
@@ -221,7 +323,22 @@ private:
     this->threads[i].reset(new std::thread(f)); // compiler may not support std::make_unique()
   }
 
+  // called by idle thread i: only the last thread retires, so that threads indexes stay contiguous
+  bool retire(int i) {
+    std::unique_lock<std::mutex> threadsLock(this->threadsMutex, std::try_to_lock);
+    if (!threadsLock || this->isDone || this->isStop || i != static_cast<int>(this->threads.size()) - 1)
+      return false;
+    this->threads[i]->detach();
+    this->threads.pop_back();
+    this->flags.pop_back(); // the thread has its own copy of the flag
+    this->nThreads = i;
+    return true;
+  }
+
   void init() {
+    this->nThreads = 0;
+    this->minThreads = 0;
+    this->idleTimeout = 0;
     this->nWaiting = 0;
     this->isStop = false;
     this->isDone = false;
@@ -229,10 +346,14 @@ private:
 
   std::vector<std::unique_ptr<std::thread>> threads;
   std::vector<std::shared_ptr<std::atomic<bool>>> flags;
-  detail::Queue<std::function<void(int id)> *> q;
+  detail::Queue<detail::Job> q;
   std::atomic<bool> isDone;
   std::atomic<bool> isStop;
   std::atomic<int> nWaiting; // how many threads are waiting
+  std::atomic<int> nThreads;
+  std::atomic<int> minThreads;
+  std::atomic<int64_t> idleTimeout; // milliseconds, 0 to never retire
+  std::mutex threadsMutex;  // threads and flags vectors
 
   std::mutex mutex;
   std::condition_variable cv;
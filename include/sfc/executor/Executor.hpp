@@ -0,0 +1,364 @@
+#pragma once
+
+#include "sfc/ctpl_stl.h"
+#include "sfc/sync/Futex.hpp"
+#include "sfc/sync/StopToken.hpp"
+#include <sched.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Soft real-time settings applied to executor workers.
+ */
+struct RealTimeConfig {
+  /**
+   * @brief Workers stack left unprefaulted, for the frames below the prefault ('prefault_stack_size' limit).
+   */
+  static constexpr std::size_t STACK_MARGIN = 64 * 1024;
+
+  enum SchedPolicy : uint8_t { SCHED_POLICY_OTHER, SCHED_POLICY_FIFO, SCHED_POLICY_RR };
+
+  /**
+   * @brief Workers scheduling policy.
+   */
+  SchedPolicy policy = SCHED_POLICY_OTHER;
+  /**
+   * @brief Workers scheduling priority (Only meaningful with FIFO/RR policies).
+   */
+  int priority = 0;
+  /**
+   * @brief Lock all current and future process memory (mlockall).
+   */
+  bool lock_memory = false;
+  /**
+   * @brief Stack bytes touched by each worker at start, so its stack is already faulted-in when running steps.
+   */
+  std::size_t prefault_stack_size = 0;
+
+  /**
+   * @brief To know if at least one setting differs from the default (non real-time) ones.
+   * @return true
+   * @return false
+   */
+  bool enabled() const { return policy != SCHED_POLICY_OTHER || lock_memory || prefault_stack_size > 0; }
+};
+
+/**
+ * @brief CPU placement of the engine threads.
+ * - 'cpus': CPU set for the engine threads (Steps workers and actions workers). Empty means no pinning.
+ * - 'transition_cpu': If set (>= 0), an isolated core reserved to steps workers, which evaluate the transitions.
+ *   Actions workers then stay on 'cpus'.
+ * - 'pin_branches': Without 'transition_cpu', each simultaneous branch is kept on a consistent core of 'cpus'.
+ */
+struct AffinityConfig {
+  std::vector<int> cpus;
+  int transition_cpu = -1;
+  bool pin_branches = false;
+
+  /**
+   * @brief To know if any pinning is requested.
+   * @return true
+   * @return false
+   */
+  bool enabled() const { return !cpus.empty() || transition_cpu >= 0; }
+};
+
+/**
+ * @brief What happens when a step is launched while all steps workers are busy.
+ * - STOP_ON_EXHAUSTION: The sequence is stopped as crazy-looping (Legacy behaviour: pools sized for the worst case).
+ * - ELASTIC: A worker is spawned, up to 'max_workers'. Spawned workers retire after 'idle_timeout' without task.
+ * - BACKPRESSURE: The launching step waits up to 'backpressure_timeout' for a worker to be freed.
+ * A sequence still lacking workers is then stopped ('Sequence::EXECUTOR_EXHAUSTED_STOP').
+ * Runaway loops are told apart by their activation rate instead: a loop activated more than 'max_activations' times
+ * within 'rate_window' stops the sequence as crazy-looping (Any mode, 0 to disable). Checked by the watchdog, as its
+ * loops limit when 'WatchdogConfig::max_loop_activations' is not set (See 'Sequence::setWatchdogConfig').
+ */
+struct PoolPolicy {
+  enum Mode : uint8_t { STOP_ON_EXHAUSTION, ELASTIC, BACKPRESSURE };
+
+  Mode mode = STOP_ON_EXHAUSTION;
+  /**
+   * @brief Hard cap of the elastic pool (0 for 4 times the sequence pool size).
+   */
+  uint32_t max_workers = 0;
+  std::chrono::milliseconds idle_timeout{1000};
+  std::chrono::milliseconds backpressure_timeout{1000};
+  uint32_t max_activations = 0;
+  std::chrono::milliseconds rate_window{100};
+};
+
+/**
+ * @brief Where a worker is allowed to run, and where it was last seen running.
+ */
+struct WorkerPlacement {
+  /**
+   * @brief CPU on which the worker started its last task (-1 if it never ran one).
+   */
+  int last_cpu = -1;
+  /**
+   * @brief CPUs the worker is allowed to run on.
+   */
+  std::vector<int> allowed_cpus;
+};
+
+/**
+ * @brief Set the CPU affinity of a thread.
+ * @param thread Native thread handle.
+ * @param cpus CPUs to run on.
+ * @return true on success.
+ */
+bool setThreadAffinity(std::thread::native_handle_type thread, const std::vector<int> &cpus);
+/**
+ * @brief Get the CPU affinity of a thread.
+ * @param thread Native thread handle.
+ * @return std::vector<int> Allowed CPUs.
+ */
+std::vector<int> getThreadAffinity(std::thread::native_handle_type thread);
+
+/**
+ * @brief Workers running the steps of a sequence.
+ * Wraps 'ctpl::thread_pool' and owns its workers settings.
+ * Outlives the sequence stop/start: 'drain' waits for the running steps, then workers stay parked.
+ */
+class Executor {
+private:
+  /**
+   * @brief Executor whose task is running on the current thread (nullptr outside tasks).
+   */
+  static thread_local const Executor *s_current;
+  /**
+   * @brief Index of the worker running the current thread's task (-1 outside tasks).
+   */
+  static thread_local int s_worker;
+  /**
+   * @brief Pushed tasks not yet finished.
+   */
+  std::atomic_uint32_t m_in_flight;
+  /**
+   * @brief Pushed tasks not yet started.
+   */
+  std::atomic_uint32_t m_queued;
+  /**
+   * @brief Finished tasks.
+   */
+  std::atomic_uint64_t m_tasks_count;
+  /**
+   * @brief Bumped at the end of each task, for 'drain'.
+   */
+  Futex m_task_done;
+  /**
+   * @brief Task bookkeeping, also when the task throws.
+   */
+  struct TaskScope {
+    Executor &executor;
+    TaskScope(Executor &executor, int worker_id) : executor(executor) {
+      s_current = &executor;
+      s_worker = worker_id;
+    }
+    ~TaskScope() {
+      s_current = nullptr;
+      s_worker = -1;
+      executor.m_tasks_count.fetch_add(1, std::memory_order_relaxed);
+      executor.m_in_flight--;
+      executor.m_task_done.bump();
+    }
+  };
+
+  /**
+   * @brief Underlying pool.
+   */
+  ctpl::thread_pool m_pool;
+  /**
+   * @brief Workers count cap (Per worker arrays are sized for it).
+   */
+  uint32_t m_max_workers;
+  /**
+   * @brief Per worker CPU on which its last task started.
+   */
+  std::unique_ptr<std::atomic_int[]> m_last_cpus;
+  /**
+   * @brief Per worker CPU it is currently pinned to by 'pinCurrentWorker' (-1 if none).
+   */
+  std::unique_ptr<std::atomic_int[]> m_pinned_cpus;
+  /**
+   * @brief Preallocated task (See 'reserveTasks'): constructed in place, queued through its borrowed 'runner'.
+   */
+  struct TaskSlot {
+    static constexpr std::size_t SIZE = 128;
+
+    alignas(std::max_align_t) unsigned char storage[SIZE];
+    void (*invoke)(void *, int) = nullptr;
+    void (*destroy)(void *) = nullptr;
+    std::function<void(int)> runner;
+  };
+  std::unique_ptr<TaskSlot[]> m_slots;
+  uint32_t m_slots_count = 0;
+  /**
+   * @brief Free slots indexes (Reserved for all of them: never grown by 'push').
+   */
+  std::vector<uint32_t> m_free_slots;
+  std::mutex m_slots_mutex;
+
+  /**
+   * @brief Take a free task slot.
+   * @return TaskSlot* nullptr if none is free.
+   */
+  TaskSlot *acquireSlot();
+  void runSlot(uint32_t index, int worker_id);
+  /**
+   * @brief Run 'fn' exactly once on each worker (Blocks until all workers ran it).
+   * @param fn
+   */
+  void runOnEachWorker(std::function<void(int)> fn);
+
+  /**
+   * @brief Wait until a worker is free, while 'running' returns true.
+   */
+  bool awaitWorker(std::chrono::nanoseconds timeout, const std::function<bool()> &running);
+
+public:
+  /**
+   * @brief Construct a new Executor and spawn its workers (Returns once they are all idle).
+   * @param workers_count
+   * @param max_workers Cap of 'grow' (Not growing if not above 'workers_count').
+   * @param idle_timeout Delay after which an idle grown worker retires (0 to keep them).
+   */
+  Executor(uint32_t workers_count, uint32_t max_workers = 0,
+           std::chrono::milliseconds idle_timeout = std::chrono::milliseconds(0));
+  /**
+   * @brief Destroy the Executor. Wait for all queued tasks.
+   */
+  ~Executor();
+
+  /**
+   * @brief Queue a task. 'f' is called with the worker index.
+   * A task fitting in a free reserved slot (See 'reserveTasks') is queued without allocation, else it is allocated.
+   * @param f
+   * @return true if queued in a reserved slot (No allocation).
+   */
+  template <typename F> bool push(F &&f) {
+    m_in_flight++;
+    m_queued++;
+    using Task = typename std::decay<F>::type;
+    if constexpr (sizeof(Task) <= TaskSlot::SIZE && alignof(Task) <= alignof(std::max_align_t)) {
+      if (TaskSlot *slot = acquireSlot()) {
+        new (slot->storage) Task(std::forward<F>(f));
+        slot->invoke = [](void *task, int id) { (*static_cast<Task *>(task))(id); };
+        slot->destroy = [](void *task) { static_cast<Task *>(task)->~Task(); };
+        m_pool.push_borrowed(&slot->runner);
+        return true;
+      }
+    }
+    m_pool.push([this, f = std::forward<F>(f)](int id) mutable {
+      m_queued--;
+      TaskScope scope(*this, id);
+      m_last_cpus[id] = sched_getcpu();
+      f(id);
+    });
+    return false;
+  }
+  /**
+   * @brief Preallocate 'capacity' task slots, and the queue room for them: a real-time hot path then pushes its
+   * tasks without allocating, as long as no more than 'capacity' of them are pending. Tasks thrown exceptions are
+   * dropped, like the allocated ones.
+   * @param capacity
+   * @return false if reserved tasks are pending (Slots kept as they are).
+   */
+  bool reserveTasks(uint32_t capacity);
+
+  /**
+   * @brief Wait until every pushed task is finished. Workers stay alive, parked.
+   * Called from a task, that task is not waited for.
+   */
+  void drain();
+  /**
+   * @brief Pushed tasks not yet finished.
+   * @return uint32_t
+   */
+  uint32_t inFlightCount() const;
+  /**
+   * @brief Pushed tasks waiting for a worker (Queue depth).
+   * @return uint32_t
+   */
+  uint32_t queuedCount() const;
+  /**
+   * @brief Finished tasks count, since construction.
+   * @return uint64_t
+   */
+  uint64_t tasksCount() const;
+
+  /**
+   * @brief Spawn one more worker, unless the cap is reached.
+   * @return true if a worker was spawned.
+   */
+  bool grow();
+  /**
+   * @brief Wait until a worker is free for one more task (Idle workers outnumber queued tasks).
+   * @param timeout
+   * @param stop Waiting is aborted as soon as it is requested (Woken at once).
+   * @return true if a worker is free.
+   */
+  bool awaitWorker(std::chrono::nanoseconds timeout, const StopToken &stop);
+
+  /**
+   * @brief Index of the worker running the calling task.
+   * @return int -1 if not called from a task.
+   */
+  static int currentWorker();
+  /**
+   * @brief Stack size of the workers (Default threads stack size).
+   * @return std::size_t
+   */
+  static std::size_t workerStackSize();
+
+  /**
+   * @brief Workers count.
+   * @return uint32_t
+   */
+  uint32_t size();
+  /**
+   * @brief Idle workers count.
+   * @return uint32_t
+   */
+  uint32_t idleCount();
+
+  /**
+   * @brief Apply real-time settings to all workers (and the process for 'lock_memory').
+   * Each failing setting is reported on std::cerr.
+   * @param config
+   * @return true if all settings were applied.
+   */
+  bool applyRealTime(const RealTimeConfig &config);
+
+  /**
+   * @brief Pin all workers on 'cpus' (Workers stopping are skipped, none retires meanwhile).
+   * @param cpus
+   * @return true on success.
+   */
+  bool applyAffinity(const std::vector<int> &cpus);
+  /**
+   * @brief Pin the calling worker on 'cpu' (No-op if already pinned there).
+   * Must be called from a task running on worker 'worker_id'.
+   * @param worker_id
+   * @param cpu
+   */
+  void pinCurrentWorker(int worker_id, int cpu);
+  /**
+   * @brief Get the actual placement of every worker (Workers stopping are skipped, none retires meanwhile).
+   * @return std::vector<WorkerPlacement>
+   */
+  std::vector<WorkerPlacement> placement();
+
+  /**
+   * @brief Stop workers.
+   * @param wait If true, wait for all queued tasks before returning.
+   */
+  void stop(bool wait = true);
+};
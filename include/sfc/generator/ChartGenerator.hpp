@@ -0,0 +1,137 @@
+#pragma once
+
+#include "sfc/step/Step.hpp"
+#include "sfc/transition/Transition.hpp"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+class Sequence;
+
+/**
+ * @brief Shape of the random charts made by 'ChartGenerator'.
+ * Ratios are the chances of each block kind (The remaining one being a plain step).
+ */
+struct GeneratorConfig {
+  uint32_t seed = 0;
+  /**
+   * @brief Nesting levels of divergences (Divergences inside divergence branches...).
+   */
+  uint32_t depth = 3;
+  /**
+   * @brief Max blocks count of each sequence of blocks (Top level one and divergence branches).
+   */
+  uint32_t length = 4;
+  /**
+   * @brief Max branches count of simultaneous, and exclusive divergences (At least 2 branches each).
+   */
+  uint32_t simultaneous_fanout = 3;
+  uint32_t exclusive_fanout = 3;
+  /**
+   * @brief Max steps count of macros (At least 2 steps each).
+   */
+  uint32_t macro_steps = 3;
+  double simultaneous_ratio = 0.2;
+  double exclusive_ratio = 0.2;
+  double macro_ratio = 0.1;
+  /**
+   * @brief Chance of a block to be looped: followed by a step which may go back to the block's first step.
+   */
+  double loop_ratio = 0.1;
+  /**
+   * @brief Steps budget: once reached, sequences end and blocks are plain steps (Open divergences are still joined,
+   * so it can be slightly overshot).
+   */
+  uint32_t max_steps = 10000;
+};
+
+/**
+ * @brief A generated chart: all steps and transitions, and what is known of its shape.
+ */
+struct GeneratedChart {
+  /**
+   * @brief Top level steps, to add to a sequence (Macros steps are added with their macro).
+   */
+  std::vector<std::shared_ptr<Step>> steps;
+  /**
+   * @brief All transitions, macros inner ones included (Receptivities to drive).
+   */
+  std::vector<std::shared_ptr<Transition>> transitions;
+  /**
+   * @brief Transitions leading to each step-id (Macros: to the macro).
+   */
+  std::unordered_map<unsigned int, std::vector<std::shared_ptr<Transition>>> incoming;
+  uint32_t steps_count = 0;
+  uint32_t simultaneous_count = 0;
+  uint32_t exclusive_count = 0;
+  uint32_t macros_count = 0;
+  uint32_t loops_count = 0;
+  /**
+   * @brief Max count of simultaneously active steps, macros flags included.
+   */
+  uint32_t max_active_steps = 0;
+
+  /**
+   * @brief Add the steps to 'seq'.
+   * @param seq
+   * @throw std::invalid_argument if a step id is already used (See 'Sequence::addStep').
+   */
+  void addTo(Sequence &seq) const;
+};
+
+/**
+ * @brief Random valid charts generator, for tests and soak runs at scale.
+ * Charts are nested blocks: plain steps, simultaneous divergences (Joined by one 'Transition::ALL' transition),
+ * exclusive divergences, macros and loops back to non-init steps. The top level sequence of blocks starts at init
+ * step #0 and goes back to it. Same config (Seed included), same chart, whatever the standard library: values are
+ * derived from the 'std::mt19937' output only.
+ */
+class ChartGenerator {
+private:
+  /**
+   * @brief Part of the chart entered by one step, and left by one step.
+   */
+  struct Segment {
+    std::shared_ptr<Step> entry;
+    std::shared_ptr<Step> exit;
+    uint32_t width;
+    /**
+     * @brief The entry is the target of a loop.
+     */
+    bool looped = false;
+  };
+
+  GeneratorConfig m_config;
+  std::mt19937 m_random;
+  GeneratedChart m_chart;
+  unsigned int m_next_id = 0;
+
+  /**
+   * @brief Random value in [min, max].
+   */
+  uint32_t uniform(uint32_t min, uint32_t max);
+  /**
+   * @brief Random value in [0, 1).
+   */
+  double chance();
+  bool budgetLeft(uint32_t steps) const;
+  std::shared_ptr<Step> makeStep();
+  std::shared_ptr<Transition> connect(const std::vector<std::shared_ptr<Step>> &from,
+                                      const std::vector<std::shared_ptr<Step>> &to);
+  Segment sequence(uint32_t depth);
+  Segment block(uint32_t depth);
+  Segment simultaneous(uint32_t depth);
+  Segment exclusive(uint32_t depth);
+  Segment macro();
+
+public:
+  explicit ChartGenerator(const GeneratorConfig &config = GeneratorConfig());
+
+  /**
+   * @brief Generate a new chart (The next ones differ: the random engine goes on).
+   * @return GeneratedChart
+   */
+  GeneratedChart generate();
+};
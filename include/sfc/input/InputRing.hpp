@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/**
+ * @brief Single-producer single-consumer ring of receptivity changes, in a memory mapped file shared with another
+ * process (e.g. a fieldbus driver). A file under '/dev/shm' keeps it in memory only.
+ * - Records are (Transition id, value): ids are the transition indexes of the compiled chart
+ *   (See 'Sequence::getCompiledChart', 'CompiledChart::transitionIndex').
+ * - Pushing and draining are a few stores and one release/acquire cursor each: no copy through the kernel, no system
+ *   call, no lock. Both processes map the same file, with this class.
+ * - The producer never waits: a full ring drops the record (See 'droppedCount').
+ * - Attached with 'Sequence::setInputRing', the engine drains it from its transitions polling (Or simulation ticks).
+ */
+class InputRing {
+private:
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+  };
+  /**
+   * @brief Shared cursors, each on its own cache line: records pushed (Producer), drained (Consumer), dropped.
+   */
+  struct alignas(64) Cursor {
+    std::atomic_uint64_t value;
+  };
+
+  std::string m_path;
+  int m_fd = -1;
+  uint8_t *m_map = nullptr;
+  std::size_t m_map_size = 0;
+  uint32_t m_capacity = 0;
+  Cursor *m_head = nullptr;
+  Cursor *m_tail = nullptr;
+  Cursor *m_dropped = nullptr;
+  /**
+   * @brief Records: transition id (High 32 bits), value (Low bit).
+   */
+  uint64_t *m_slots = nullptr;
+
+public:
+  static constexpr char MAGIC[4] = {'S', 'F', 'C', 'I'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr std::size_t HEADER_SIZE = 64;
+
+  /**
+   * @brief Open (Or create) the ring file 'path'. Records already pushed are kept.
+   * @param path
+   * @param capacity Records count, rounded up to a power of two (Only used at creation, or if the file is not a ring).
+   * @throw std::runtime_error on I/O error.
+   */
+  InputRing(const std::string &path, uint32_t capacity = 4096);
+  /**
+   * @brief Destroy the InputRing (Unmapped, the file is left).
+   */
+  ~InputRing();
+  InputRing(const InputRing &) = delete;
+  InputRing &operator=(const InputRing &) = delete;
+
+  /**
+   * @brief Push a receptivity change (Producer side).
+   * @param transition_id
+   * @param value
+   * @return false if dropped (Ring full).
+   */
+  bool push(uint32_t transition_id, bool value);
+  /**
+   * @brief Pop all pushed records, in order (Consumer side).
+   * Records overwritten by a producer not checking the tail (More than 'capacity' pending) are counted as dropped.
+   * @param apply Called with each record.
+   * @return uint32_t Popped records count.
+   */
+  uint32_t drain(const std::function<void(uint32_t, bool)> &apply);
+
+  /**
+   * @brief Records pushed and not yet drained.
+   * @return uint32_t
+   */
+  uint32_t size() const;
+  uint32_t capacity() const;
+  /**
+   * @brief Records dropped by the producer (Ring full), or overwritten (See 'drain'), since creation.
+   * @return uint64_t
+   */
+  uint64_t droppedCount() const;
+  const std::string &path() const;
+};
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One exported value (See 'Sequence::collectMetrics' and 'PrometheusExporter').
+ */
+struct MetricSample {
+  enum Type : uint8_t { COUNTER, GAUGE };
+
+  /**
+   * @brief Metric family name (e.g. "sfc_transitions_fired_total").
+   */
+  std::string name;
+  std::string help;
+  Type type = COUNTER;
+  /**
+   * @brief Prometheus labels, without braces (e.g. "sequence=\"main\""). Empty if none.
+   */
+  std::string labels;
+  double value = 0;
+};
+
+/**
+ * @brief Engine counters of a sequence.
+ * - Counters are sharded: each thread adds to its own cache line (Relaxed atomics, no lock, no false sharing),
+ *   and shards are summed on read. Threads beyond 'SHARDS_COUNT' share shards, which stays correct.
+ * - Reads are not a consistent snapshot across counters: each one is monotonic on its own.
+ */
+class Metrics {
+public:
+  enum Counter : uint8_t {
+    /**
+     * @brief Receptivities read by the steps loops.
+     */
+    TRANSITIONS_EVALUATED,
+    TRANSITIONS_FIRED,
+    STEPS_ACTIVATED,
+    /**
+     * @brief Polling loops iterations (or simulation ticks) which fired no transition.
+     */
+    EMPTY_POLLS,
+    /**
+     * @brief Step changed callbacks calls, and time spent in them.
+     */
+    CALLBACKS,
+    CALLBACKS_NANOSECONDS,
+    /**
+     * @brief Transitions predicates evaluated by the engine (See 'Transition::setPredicate').
+     */
+    PREDICATES_SAMPLED,
+    /**
+     * @brief Watchdog violations: runaway loops and steps over their dwell limit (See 'WatchdogConfig').
+     */
+    WATCHDOG_VIOLATIONS,
+    COUNTERS_COUNT
+  };
+  static constexpr uint32_t SHARDS_COUNT = 16;
+
+private:
+  struct alignas(64) Shard {
+    std::atomic_uint64_t values[COUNTERS_COUNT] = {};
+  };
+  Shard m_shards[SHARDS_COUNT];
+
+  /**
+   * @brief Next shard to assign.
+   */
+  static uint32_t nextShard();
+
+public:
+  /**
+   * @brief Shard of the calling thread, in [0, SHARDS_COUNT), assigned at its first use
+   * (Constant initialized: no guard on the hot path). Also used by other per-thread counters.
+   */
+  static uint32_t shardIndex() {
+    static thread_local uint32_t shard = SHARDS_COUNT;
+    if (shard == SHARDS_COUNT) {
+      shard = nextShard();
+    }
+    return shard;
+  }
+
+  /**
+   * @brief Add to a counter (Wait-free).
+   * @param counter
+   * @param value
+   */
+  void add(Counter counter, uint64_t value = 1) {
+    m_shards[shardIndex()].values[counter].fetch_add(value, std::memory_order_relaxed);
+  }
+  /**
+   * @brief Sum of all shards.
+   * @param counter
+   * @return uint64_t
+   */
+  uint64_t value(Counter counter) const;
+  /**
+   * @brief Reset all counters (Not atomic with concurrent 'add').
+   */
+  void reset();
+
+  /**
+   * @brief Prometheus name of a counter.
+   */
+  static const char *name(Counter counter);
+  static const char *help(Counter counter);
+  /**
+   * @brief All counters as samples.
+   * @param labels
+   * @return std::vector<MetricSample>
+   */
+  std::vector<MetricSample> samples(const std::string &labels = "") const;
+};
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "sfc/metrics/Metrics.hpp"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Local export of metrics in the Prometheus text format (No network dependency).
+ * - 'writeFile': for a node exporter textfile collector (Written aside, then renamed: readers never see half a file).
+ * - 'serve': a Unix socket; each connection gets the current text, then is closed (e.g. 'socat - UNIX:<path>').
+ * Samples are gathered from every added source at each export, nothing is cached.
+ */
+class PrometheusExporter {
+public:
+  using Source = std::function<std::vector<MetricSample>()>;
+
+private:
+  mutable std::mutex m_sources_mutex;
+  std::vector<Source> m_sources;
+
+  std::string m_socket_path;
+  int m_socket = -1;
+  std::atomic_bool m_serving;
+  std::thread m_server;
+
+  void serverLoop();
+
+public:
+  PrometheusExporter();
+  /**
+   * @brief Destroy the exporter: stop serving.
+   */
+  ~PrometheusExporter();
+
+  /**
+   * @brief Add a metrics source (e.g. '[&seq]() { return seq.collectMetrics("sequence=\"main\""); }').
+   * @param source
+   */
+  void addSource(Source source);
+
+  /**
+   * @brief Format samples. Samples of a same family are grouped under one HELP/TYPE header, in first seen order.
+   * @param samples
+   * @return std::string
+   */
+  static std::string format(const std::vector<MetricSample> &samples);
+  /**
+   * @brief Gather and format all sources.
+   * @return std::string
+   */
+  std::string text() const;
+  /**
+   * @brief Write 'text' to 'path' (Through "<path>.tmp" and a rename).
+   * @param path
+   * @throw std::runtime_error on I/O error.
+   */
+  void writeFile(const std::string &path) const;
+  /**
+   * @brief Serve 'text' on a Unix socket, from a dedicated thread (An existing socket file is replaced).
+   * @param socket_path
+   * @throw std::runtime_error if already serving, or on socket error.
+   */
+  void serve(const std::string &socket_path);
+  /**
+   * @brief Stop serving and remove the socket file (No-op if not serving).
+   */
+  void stopServing();
+};
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One journal entry: a step activation change or a join counter change (Absolute values).
+ */
+struct JournalEntry {
+  enum Kind : uint8_t { STEP = 0, JOIN = 1 };
+
+  Kind kind;
+  unsigned int id;
+  /**
+   * @brief Activation state (STEP), or arrivals count (JOIN).
+   */
+  uint32_t value;
+  std::chrono::nanoseconds time;
+};
+
+/**
+ * @brief Append-only write-ahead log of a sequence, in a memory mapped file.
+ * - Appending is a slot reservation (One atomic increment) and a few stores: no lock and no system call.
+ *   Entries reach the page cache at once (They survive a process crash), 'sync' makes them durable.
+ * - The file holds two regions, used by alternate generations: 'rotate' starts a new generation in the other region,
+ *   leaving the previous one untouched until the next rotation (A snapshot must cover it by then).
+ * - Each slot carries its generation, written last: stale or partially written slots are never read as entries.
+ * - Appending is possible once the first generation is started by 'rotate'. A full region drops entries
+ *   (See 'overflowCount'), and its generation is marked in the file as overflowed (See 'overflowed').
+ */
+class Journal {
+private:
+  struct Slot {
+    std::atomic_uint32_t generation;
+    uint32_t id;
+    uint32_t value;
+    uint32_t kind;
+    int64_t time;
+  };
+
+  struct Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+  };
+
+  std::string m_path;
+  int m_fd = -1;
+  uint8_t *m_map = nullptr;
+  std::size_t m_map_size = 0;
+  uint32_t m_capacity = 0;
+  /**
+   * @brief Generation (High 32 bits) and next slot (Low 32 bits), reserved at once.
+   */
+  std::atomic_uint64_t m_cursor;
+  std::atomic_uint64_t m_overflows;
+  /**
+   * @brief A generation was started by 'rotate': dropped entries are lost ones.
+   */
+  std::atomic_bool m_started;
+  std::mutex m_rotate_mutex;
+
+  Slot *region(uint64_t generation) const;
+  /**
+   * @brief Overflow mark of a generation's region, after the header: the overflowed generation, 0 if none.
+   */
+  std::atomic_uint32_t *overflowMark(uint64_t generation) const;
+
+public:
+  static constexpr char MAGIC[4] = {'S', 'F', 'C', 'W'};
+  static constexpr uint32_t VERSION = 1;
+  static constexpr std::size_t HEADER_SIZE = 64;
+
+  /**
+   * @brief Open (Or create) the journal file 'path'. Existing entries are kept, until rotated over.
+   * @param path
+   * @param capacity Entries per region (Only used at creation, or if the file is not a journal).
+   * @throw std::runtime_error on I/O error.
+   */
+  Journal(const std::string &path, uint32_t capacity);
+  /**
+   * @brief Destroy the Journal (Unmapped, not synced).
+   */
+  ~Journal();
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  /**
+   * @brief Append an entry to the current generation.
+   * @return false if dropped (Region full: the generation is marked as overflowed, or no generation started).
+   */
+  bool append(JournalEntry::Kind kind, unsigned int id, uint32_t value, std::chrono::nanoseconds time);
+  /**
+   * @brief Start a new generation, in the other region.
+   * @return uint64_t The new generation.
+   */
+  uint64_t rotate();
+  /**
+   * @brief Flush written entries to the disk (Blocking: not to be called on the firing path).
+   */
+  void sync();
+
+  uint64_t generation() const;
+  /**
+   * @brief Entries count of the current generation (Capped to 'capacity').
+   */
+  uint32_t size() const;
+  uint32_t capacity() const;
+  /**
+   * @brief Dropped entries count (Region full, or no generation started).
+   */
+  uint64_t overflowCount() const;
+  /**
+   * @brief To know if entries of a generation were dropped (Persisted: still known once reopened).
+   * @param generation
+   * @return true
+   * @return false
+   */
+  bool overflowed(uint64_t generation) const;
+  /**
+   * @brief Read the entries of a generation, from 'offset'.
+   * @return std::vector<JournalEntry> Empty if the generation is not (anymore) in the file.
+   */
+  std::vector<JournalEntry> entries(uint64_t generation, uint32_t offset = 0) const;
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "sfc/persist/Journal.hpp"
+#include "sfc/persist/Snapshot.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief Persists a sequence state, to resume it after a crash (See 'Sequence::setPersister' and 'Sequence::resume').
+ * - Steps activation and join counters changes are appended to a 'Journal' ("<path>.wal") on the firing path.
+ * - A flusher thread syncs the journal every 'flush_period', and takes a checkpoint when it is half full (At once if it
+ *   overflowed): a 'Snapshot' ("<path>.snap") of the current state, after which the journal restarts in its other region.
+ * - 'recover' rebuilds the last state from the snapshot and the journal tail.
+ */
+class Persister {
+private:
+  std::string m_snapshot_path;
+  Journal m_journal;
+  std::chrono::milliseconds m_flush_period;
+  /**
+   * @brief Provides the current state: active steps and join counters (Set by the sequence).
+   */
+  std::function<Snapshot()> m_source;
+  std::mutex m_checkpoint_mutex;
+  /**
+   * @brief An entry was dropped: the flusher checkpoints without waiting for its period.
+   */
+  std::atomic_bool m_checkpoint_requested;
+  std::atomic<int64_t> m_last_time;
+  std::atomic_uint64_t m_checkpoints;
+
+  std::mutex m_flusher_mutex;
+  std::condition_variable m_flusher_cv;
+  bool m_stopping = false;
+  std::thread m_flusher;
+
+  void flusherLoop();
+  /**
+   * @brief Append to the journal, requesting a checkpoint if the entry is dropped.
+   */
+  void append(JournalEntry::Kind kind, unsigned int id, uint32_t value, std::chrono::nanoseconds time);
+
+public:
+  /**
+   * @brief Construct a new Persister, and start its flusher thread.
+   * @param path Files prefix.
+   * @param capacity Journal entries per region.
+   * @param flush_period
+   * @throw std::runtime_error on I/O error.
+   */
+  explicit Persister(const std::string &path, uint32_t capacity = 1 << 16,
+                     std::chrono::milliseconds flush_period = std::chrono::milliseconds(10));
+  /**
+   * @brief Destroy the Persister: stop the flusher thread, and sync the journal.
+   */
+  ~Persister();
+
+  /**
+   * @brief Rebuild the last persisted state. Must be called before the sequence is started again.
+   * @return Snapshot Empty if nothing was persisted.
+   * @throw std::invalid_argument if the snapshot file is corrupted.
+   * @throw std::runtime_error if the journal overflowed after the snapshot (Its tail was lost).
+   */
+  Snapshot recover() const;
+  /**
+   * @brief Save a snapshot of the current state, then restart the journal (Blocking: syncs the disk).
+   * @throw std::runtime_error if not attached to a sequence, or on I/O error.
+   */
+  void checkpoint();
+  /**
+   * @brief Sync the journal now, instead of waiting for the flusher (Blocking).
+   */
+  void flush();
+  /**
+   * @brief Set the active steps source (Done by 'Sequence::setPersister').
+   * @param source nullptr to detach.
+   */
+  void setSource(std::function<Snapshot()> source);
+
+  /**
+   * @brief Journal a step activation change.
+   */
+  void stepChanged(unsigned int step_id, bool state, std::chrono::nanoseconds time);
+  /**
+   * @brief Journal a join counter change.
+   */
+  void joinChanged(unsigned int step_id, uint32_t count, std::chrono::nanoseconds time);
+
+  /**
+   * @brief Time of the last journaled change.
+   */
+  std::chrono::nanoseconds lastTime() const;
+  uint64_t checkpointsCount() const;
+  const Journal &journal() const;
+};
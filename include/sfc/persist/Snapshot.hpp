@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct JournalEntry;
+
+/**
+ * @brief Persisted state of a running sequence: active steps and join counters, at a journal position.
+ * Binary format (Little endian):
+ * - Header: "SFCS" + format version (1 byte).
+ * - Chart fingerprint (8 bytes), journal generation (8 bytes), journal offset (4 bytes), time (8 bytes, ns).
+ * - Active steps count (4 bytes) then ids (4 bytes each), join counters count (4 bytes) then (id, count) pairs.
+ */
+struct Snapshot {
+  static constexpr char MAGIC[4] = {'S', 'F', 'C', 'S'};
+  static constexpr uint8_t VERSION = 1;
+
+  /**
+   * @brief Structure of the chart the state belongs to (See 'CompiledChart::fingerprint'). 0 if empty.
+   */
+  uint64_t fingerprint = 0;
+  /**
+   * @brief Journal entries following the state: from 'offset' in 'generation', then the whole next generation.
+   */
+  uint64_t generation = 0;
+  uint32_t offset = 0;
+  /**
+   * @brief Clock time of the last known change.
+   */
+  std::chrono::nanoseconds time{0};
+  /**
+   * @brief Sorted active steps ids (Macros included).
+   */
+  std::vector<unsigned int> active_steps;
+  /**
+   * @brief Non-zero join counters: step-id -> arrivals count.
+   */
+  std::vector<std::pair<unsigned int, unsigned int>> join_counters;
+
+  /**
+   * @brief To know if there is no state.
+   * @return true
+   * @return false
+   */
+  bool empty() const;
+  /**
+   * @brief Apply a journal entry (Entries are absolute values: applying one twice is harmless).
+   * @param entry
+   */
+  void apply(const JournalEntry &entry);
+
+  std::vector<uint8_t> encode() const;
+  /**
+   * @brief Decode a snapshot from memory.
+   * @throw std::invalid_argument if the data is not a (complete) snapshot.
+   */
+  static Snapshot decode(const uint8_t *data, std::size_t size);
+  /**
+   * @brief Write the snapshot durably: written aside, synced, then renamed over 'path'.
+   * @throw std::runtime_error on I/O error.
+   */
+  void save(const std::string &path) const;
+  /**
+   * @brief Load a snapshot file.
+   * @throw std::runtime_error if the file cannot be read.
+   * @throw std::invalid_argument if the file is not a snapshot.
+   */
+  static Snapshot load(const std::string &path);
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Coverage and firing frequencies of a chart, summed over one or several runs (See 'Profiler').
+ * - Steps are identified by their id, transitions by their source step id and their rank among its next transitions
+ *   (Their evaluation order), so that profiles of a same chart can be merged across runs and processes.
+ * - Text format, one record per line:
+ *   "sfc-profile 1", then "runs <count>",
+ *   "step <id> <activations>",
+ *   "transition <step id> <rank> <evaluations> <fired> <next ids, comma separated>".
+ */
+struct Profile {
+  struct TransitionCounts {
+    /**
+     * @brief Receptivity reads, by steps polling loops (or simulation ticks).
+     */
+    uint64_t evaluations = 0;
+    uint64_t fired = 0;
+    /**
+     * @brief Next steps ids, to tell the branch (And to check merges).
+     */
+    std::vector<unsigned int> nexts;
+  };
+  /**
+   * @brief Source step id, rank among its next transitions.
+   */
+  using TransitionKey = std::pair<unsigned int, uint32_t>;
+
+  uint64_t runs = 0;
+  std::map<unsigned int, uint64_t> activations;
+  std::map<TransitionKey, TransitionCounts> transitions;
+
+  /**
+   * @brief Add another profile's counts.
+   * @param other
+   * @param strict If false, a transition leading to other steps in 'other' (Changed chart) takes its counts instead.
+   * @throw std::invalid_argument if 'strict' and a same transition leads to other steps in 'other' (Another chart).
+   */
+  void merge(const Profile &other, bool strict = true);
+  /**
+   * @brief Transitions never fired, though their source step was activated (Dead branches candidates).
+   * @return std::vector<TransitionKey>
+   */
+  std::vector<TransitionKey> neverFired() const;
+
+  std::string encode() const;
+  /**
+   * @brief Decode a profile from its text.
+   * @throw std::invalid_argument if the text is not a profile.
+   */
+  static Profile decode(const std::string &text);
+  /**
+   * @brief Write the profile (Written aside, then renamed over 'path').
+   * @throw std::runtime_error on I/O error.
+   */
+  void save(const std::string &path) const;
+  /**
+   * @brief Load a profile file.
+   * @throw std::runtime_error if the file cannot be read.
+   * @throw std::invalid_argument if the file is not a profile.
+   */
+  static Profile load(const std::string &path);
+};
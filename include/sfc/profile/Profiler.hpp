@@ -0,0 +1,116 @@
+#pragma once
+
+#include "sfc/CompiledChart.hpp"
+#include "sfc/metrics/Metrics.hpp"
+#include "sfc/profile/Profile.hpp"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Live profiling counters of one compiled chart (Owned by a 'Profiler').
+ * - Per step activations, per (step, next transition) evaluations and firings.
+ * - Each thread counts in its own shard: a cache-line aligned block holding all counters of the chart,
+ *   so that threads never write to a same line. Shards are summed on read.
+ */
+class ProfileCounters {
+public:
+  static constexpr uint32_t SHARDS_COUNT = 8;
+
+private:
+  struct alignas(64) Line {
+    std::atomic_uint64_t values[8] = {};
+  };
+
+  std::shared_ptr<const CompiledChart> m_chart;
+  /**
+   * @brief First transition slot of each step (Its next transitions are contiguous), then the slots count.
+   */
+  std::vector<uint32_t> m_slots_begin;
+  /**
+   * @brief Counters per shard: activations (Steps count), evaluations then firings (Slots count each), in lines.
+   */
+  uint32_t m_lines_per_shard;
+  std::unique_ptr<Line[]> m_lines;
+
+  std::atomic_uint64_t &counter(uint32_t index) {
+    const uint32_t shard = Metrics::shardIndex() % SHARDS_COUNT;
+    return m_lines[shard * m_lines_per_shard + index / 8].values[index % 8];
+  }
+  uint64_t sum(uint32_t index) const;
+
+public:
+  explicit ProfileCounters(std::shared_ptr<const CompiledChart> chart);
+
+  const std::shared_ptr<const CompiledChart> &chart() const;
+
+  void stepActivated(uint32_t step_index) { counter(step_index).fetch_add(1, std::memory_order_relaxed); }
+  /**
+   * @param rank Rank of the transition among the step's next transitions.
+   */
+  void transitionEvaluated(uint32_t step_index, uint32_t rank) {
+    counter(m_chart->stepsCount() + m_slots_begin[step_index] + rank).fetch_add(1, std::memory_order_relaxed);
+  }
+  void transitionFired(uint32_t step_index, uint32_t rank) {
+    counter(m_chart->stepsCount() + m_slots_begin.back() + m_slots_begin[step_index] + rank)
+        .fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Add the summed counters to 'profile'.
+   * @param profile
+   */
+  void addTo(Profile &profile) const;
+};
+
+/**
+ * @brief Coverage and firing frequencies profiler (See 'Sequence::setProfiler').
+ * - A 'ProfileCounters' block is made for each chart the sequence runs (Live changes included), and all of them are
+ *   summed when the profile is read.
+ * - Counting only costs relaxed atomic additions on thread-private cache lines.
+ */
+class Profiler {
+private:
+  mutable std::mutex m_mutex;
+  std::vector<std::shared_ptr<ProfileCounters>> m_counters;
+  /**
+   * @brief Merged profile of previous runs (See 'load').
+   */
+  Profile m_base;
+  uint64_t m_runs = 0;
+
+public:
+  /**
+   * @brief Get the counters of 'chart' (Made at first call).
+   * @param chart
+   * @return std::shared_ptr<ProfileCounters>
+   */
+  std::shared_ptr<ProfileCounters> counters(const std::shared_ptr<const CompiledChart> &chart);
+  /**
+   * @brief Count a new run (Done at each start).
+   */
+  void runStarted();
+
+  /**
+   * @brief Profile of all runs: the loaded ones, plus the counted ones.
+   * @return Profile
+   */
+  Profile profile() const;
+  /**
+   * @brief Merge a saved profile into this one (e.g. the one of the previous runs, before saving again).
+   * @param path
+   * @throw std::runtime_error, std::invalid_argument (See 'Profile::load', 'Profile::merge').
+   */
+  void load(const std::string &path);
+  /**
+   * @brief Save 'profile'.
+   * @param path
+   * @throw std::runtime_error on I/O error.
+   */
+  void save(const std::string &path) const;
+  /**
+   * @brief Forget all counts.
+   */
+  void clear();
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "sfc/clock/Clock.hpp"
+#include "sfc/record/Recording.hpp"
+#include "sfc/transition/ReceptivityObserver.hpp"
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Records every receptivity change of a sequence's transitions, and the resulting step activation trace.
+ * - Attached with 'Sequence::setRecorder', transitions are identified by their 'CompiledChart' index.
+ * - Events are encoded in a small memory buffer, appended to the file when full (See 'Recording' for the format),
+ *   so that recording can stay enabled in production.
+ * - Without file, everything is kept in memory.
+ */
+class Recorder : public ReceptivityObserver {
+private:
+  mutable std::mutex m_mutex;
+  std::shared_ptr<Clock> m_clock;
+  std::string m_path;
+  std::ofstream m_file;
+  /**
+   * @brief Encoded events not yet written (Everything in memory mode).
+   */
+  std::vector<uint8_t> m_buffer;
+  std::chrono::nanoseconds m_last_time;
+  uint64_t m_events_count = 0;
+  uint64_t m_written_bytes = 0;
+
+  void append(RecordedEvent::Kind kind, uint32_t id, bool state);
+  void writeBuffer();
+
+public:
+  /**
+   * @brief Buffered bytes count before appending to the file.
+   */
+  static constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+
+  /**
+   * @brief Construct a new in-memory Recorder.
+   */
+  Recorder();
+  /**
+   * @brief Construct a new Recorder writing to 'path' (Truncated).
+   * @throw std::runtime_error if the file cannot be opened.
+   */
+  explicit Recorder(const std::string &path);
+  /**
+   * @brief Destroy the Recorder, flushing it.
+   */
+  ~Recorder() override;
+
+  void receptivityChanged(uint32_t transition_id, bool state) override;
+  /**
+   * @brief Record a step activation change.
+   */
+  void stepChanged(unsigned int step_id, bool state);
+  /**
+   * @brief Set the time source (The sequence's one, set when attached).
+   */
+  void setClock(std::shared_ptr<Clock> clock);
+
+  /**
+   * @brief Write buffered events to the file (No-op in memory mode).
+   */
+  void flush();
+  /**
+   * @brief Recorded events count.
+   */
+  uint64_t eventsCount() const;
+  /**
+   * @brief Encoded size, header included.
+   */
+  uint64_t bytesCount() const;
+  /**
+   * @brief Decode everything recorded so far (Flushes the file first).
+   * @return Recording
+   */
+  Recording recording();
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One recorded event: a receptivity change (input) or a step activation change (trace).
+ */
+struct RecordedEvent {
+  enum Kind : uint8_t { RECEPTIVITY = 0, STEP = 1 };
+
+  Kind kind;
+  bool state;
+  /**
+   * @brief Transition index in the 'CompiledChart' (RECEPTIVITY), or step id (STEP).
+   */
+  uint32_t id;
+  /**
+   * @brief Clock time of the event.
+   */
+  std::chrono::nanoseconds time;
+};
+
+/**
+ * @brief Decoded recording, as written by a 'Recorder'.
+ * Binary format (Append-only, little bytes count per event):
+ * - Header: "SFCR" + format version (1 byte).
+ * - Then, per event: tag (1 byte: bit 0 = state, bit 1 = kind), zigzag varint time delta with the previous event (ns),
+ *   varint id.
+ */
+class Recording {
+private:
+  std::vector<RecordedEvent> m_events;
+
+public:
+  static constexpr char MAGIC[4] = {'S', 'F', 'C', 'R'};
+  static constexpr uint8_t VERSION = 1;
+  static constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + 1;
+  static constexpr std::size_t NPOS = static_cast<std::size_t>(-1);
+
+  Recording() = default;
+  explicit Recording(std::vector<RecordedEvent> events);
+
+  /**
+   * @brief Decode a recording from memory.
+   * A truncated last event (Recorder killed while writing) is ignored.
+   * @throw std::invalid_argument if the header is not a known one.
+   */
+  static Recording decode(const uint8_t *data, std::size_t size);
+  /**
+   * @brief Load and decode a recording file.
+   * @throw std::runtime_error if the file cannot be read.
+   * @throw std::invalid_argument if the header is not a known one.
+   */
+  static Recording load(const std::string &path);
+
+  /**
+   * @brief Append the header to 'out'.
+   */
+  static void encodeHeader(std::vector<uint8_t> &out);
+  /**
+   * @brief Append one event to 'out'.
+   * @param previous_time Time of the previously encoded event (0 for the first one).
+   */
+  static void encode(std::vector<uint8_t> &out, const RecordedEvent &event, std::chrono::nanoseconds previous_time);
+
+  /**
+   * @brief All events, in recording order.
+   */
+  const std::vector<RecordedEvent> &events() const;
+  /**
+   * @brief Receptivity changes only.
+   */
+  std::vector<RecordedEvent> inputs() const;
+  /**
+   * @brief Step activation changes only.
+   */
+  std::vector<RecordedEvent> trace() const;
+
+  /**
+   * @brief Index of the first difference between two traces (Kind, id and state are compared, not times).
+   * @return std::size_t NPOS if identical.
+   */
+  static std::size_t firstDivergence(const std::vector<RecordedEvent> &a, const std::vector<RecordedEvent> &b);
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "sfc/record/Recording.hpp"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class Sequence;
+class Simulation;
+
+/**
+ * @brief Replays the receptivity changes of a 'Recording' into a sequence built like the recorded one
+ * (Same steps ids and transitions order, so that 'CompiledChart' indexes match).
+ * Inputs are applied at their recorded offset from the first recorded event.
+ * To compare the resulting behaviour, attach a 'Recorder' to the replayed sequence and diff the traces
+ * with 'Recording::firstDivergence'.
+ */
+class Replayer {
+private:
+  std::vector<RecordedEvent> m_inputs;
+  std::chrono::nanoseconds m_origin;
+  std::chrono::nanoseconds m_end;
+
+public:
+  /**
+   * @brief Construct a new Replayer.
+   * @param recording
+   */
+  explicit Replayer(const Recording &recording);
+
+  /**
+   * @brief Replay as fast as possible, on virtual time.
+   * The simulation must be started. Once all inputs applied, the simulation runs until the recording end.
+   * @param sim
+   * @return uint64_t Applied inputs count.
+   * @throw std::out_of_range if an input refers to an unknown transition.
+   */
+  uint64_t replay(Simulation &sim);
+  /**
+   * @brief Replay in real time, into a running sequence (Blocks the calling thread).
+   * The sequence must have been started with a 'Recorder' attached (See 'Sequence::getCompiledChart').
+   * @param seq
+   * @param cancel Optional, checked between inputs.
+   * @return uint64_t Applied inputs count.
+   * @throw std::runtime_error if the sequence has no compiled chart.
+   * @throw std::out_of_range if an input refers to an unknown transition.
+   */
+  uint64_t replay(Sequence &seq, const std::atomic_bool *cancel = nullptr);
+
+  /**
+   * @brief Inputs to replay.
+   */
+  const std::vector<RecordedEvent> &inputs() const;
+};
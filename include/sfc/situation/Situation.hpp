@@ -0,0 +1,52 @@
+#pragma once
+
+#include "sfc/CompiledChart.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Consistent copy of a sequence situation (Active steps and receptivities), see 'SituationPublisher'.
+ */
+struct Situation {
+  /**
+   * @brief Publication epoch, incremented by every change.
+   */
+  uint64_t epoch = 0;
+  /**
+   * @brief Chart giving the indexes of the bitsets below (nullptr if never started).
+   */
+  std::shared_ptr<const CompiledChart> chart;
+  /**
+   * @brief One bit per step index.
+   */
+  std::vector<uint64_t> steps;
+  /**
+   * @brief One bit per transition index.
+   */
+  std::vector<uint64_t> receptivities;
+
+  /**
+   * @brief Step activation state.
+   * @param id Step id.
+   * @return false if unknown.
+   */
+  bool isActivated(unsigned int id) const;
+  /**
+   * @brief Transition receptivity state.
+   * @param transition
+   * @return false if unknown.
+   */
+  bool getReceptivityState(const Transition *transition) const;
+  /**
+   * @brief To know if an active step has a true next transition (The sequence is about to evolve).
+   * @return true
+   * @return false
+   */
+  bool hasCrossableTransition() const;
+  /**
+   * @brief Active steps ids, sorted.
+   * @return std::vector<unsigned int>
+   */
+  std::vector<unsigned int> getActivatedSteps() const;
+};
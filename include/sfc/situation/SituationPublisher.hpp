@@ -0,0 +1,173 @@
+#pragma once
+
+#include "sfc/situation/Situation.hpp"
+#include "sfc/sync/Futex.hpp"
+#include "sfc/transition/ReceptivityObserver.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Publishes the situation of a sequence to readers, through snapshots taken when write sections are closed.
+ * - The engine updates atomic bitsets inside write sections. A write section can span a whole step handoff
+ *   (From transition crossing to next steps activation), so that readers never see a torn situation.
+ * - Writers sections can overlap (Simultaneous branches): a writers count is used instead of an odd sequence.
+ * - The writer closing the last section copies the bitsets to a spare snapshot, kept only if no section was opened
+ *   meanwhile (Else the next close publishes), then swaps it in.
+ * - Readers copy the last published snapshot (Wait-free): the published index and its readers count share a word,
+ *   so that a snapshot is never rewritten while read. The writer only waits if every spare snapshot is still read.
+ * - Waiters sleep on a 'Futex', bumped when a snapshot is published.
+ */
+class SituationPublisher : public ReceptivityObserver {
+private:
+  /**
+   * @brief Bitsets for one chart. Replaced at reset, freed once no reader nor writer can still hold it.
+   */
+  struct State {
+    std::shared_ptr<const CompiledChart> chart;
+    std::size_t steps_words;
+    std::size_t receptivities_words;
+    std::unique_ptr<std::atomic_uint64_t[]> steps;
+    std::unique_ptr<std::atomic_uint64_t[]> receptivities;
+  };
+
+  /**
+   * @brief Copy of the bitsets, published when the last write section was closed.
+   */
+  struct Snapshot {
+    uint64_t epoch = 0;
+    std::shared_ptr<const CompiledChart> chart;
+    std::vector<uint64_t> steps;
+    std::vector<uint64_t> receptivities;
+  };
+  static constexpr uint32_t SNAPSHOTS = 3;
+  /**
+   * @brief Low bits of 'm_published' for the snapshot index, the high ones counting its readers.
+   */
+  static constexpr uint64_t SNAPSHOT_MASK = 3;
+  static constexpr uint64_t SNAPSHOT_READER = 4;
+
+  /**
+   * @brief Scope of a state use (Writer): counted in the current grace period.
+   */
+  class Access;
+
+  std::atomic<State *> m_state;
+  /**
+   * @brief Users of the state per grace period. A replaced state is freed once both periods were drained:
+   * new users go to the other period, so draining never waits for more than the users already there.
+   */
+  mutable std::atomic_uint32_t m_users[2];
+  std::atomic_uint32_t m_grace;
+  std::mutex m_reset_mutex;
+  std::atomic_uint32_t m_writers;
+  std::atomic_uint64_t m_epoch;
+  Snapshot m_snapshots[SNAPSHOTS];
+  /**
+   * @brief Published snapshot index and its readers count: a reader takes the index and counts itself at once.
+   */
+  mutable std::atomic_uint64_t m_published;
+  /**
+   * @brief Readers still copying each snapshot: decremented by the readers, given the count of 'm_published' when the
+   * snapshot is replaced (Negative until then). A replaced snapshot can be rewritten once back to 0.
+   */
+  mutable std::atomic_int64_t m_readers[SNAPSHOTS];
+  /**
+   * @brief Publications asked by closed write sections: the first one publishes, and again for the ones asked
+   * meanwhile.
+   */
+  std::atomic_uint32_t m_publish_requests;
+  /**
+   * @brief Bumped when a snapshot is published, to wake up waiters.
+   */
+  mutable Futex m_changes;
+  /**
+   * @brief Observer to forward receptivity changes to (Not owned).
+   */
+  std::atomic<ReceptivityObserver *> m_forward;
+
+  static void setBit(std::atomic_uint64_t *words, uint32_t index, bool state);
+  /**
+   * @brief Wait until the users of both grace periods are gone.
+   */
+  void synchronize();
+  /**
+   * @brief Publish a snapshot of the bitsets, unless a write section is open (Its close publishes).
+   */
+  void publish();
+  /**
+   * @brief Copy the bitsets to a spare snapshot and swap it in, if no write section was opened meanwhile.
+   * @return true if published.
+   */
+  bool publishSnapshot();
+
+public:
+  SituationPublisher();
+  ~SituationPublisher();
+
+  /**
+   * @brief Publish a new chart, steps activations and receptivities read from the chart once published.
+   * The previous state is freed.
+   * @note To be called once the transitions observe this publisher with their new indexes: their changes are then
+   * either read here or published by them.
+   * @param chart
+   */
+  void reset(std::shared_ptr<const CompiledChart> chart);
+
+  /**
+   * @brief Open a write section (Can be nested and overlapped).
+   */
+  void beginWrite();
+  /**
+   * @brief Close a write section.
+   */
+  void endWrite();
+  /**
+   * @brief Publish a step activation change, in its own write section.
+   * @param id Step id, ignored if not in the chart.
+   */
+  void publishStep(unsigned int id, bool state);
+  /**
+   * @brief Publish a receptivity change, then forward it.
+   */
+  void receptivityChanged(uint32_t transition_id, bool state) override;
+  /**
+   * @brief Set the observer to forward receptivity changes to.
+   * @param observer nullptr for none.
+   */
+  void setForward(ReceptivityObserver *observer);
+
+  /**
+   * @brief Copy the last published snapshot (Wait-free), reusing the buffers of 'situation'.
+   * @param situation
+   * @return true (A published snapshot is always consistent).
+   */
+  bool tryRead(Situation &situation) const;
+  /**
+   * @brief Copy the last published snapshot (Wait-free): write sections still open are not seen.
+   * @return Situation
+   */
+  Situation read() const;
+  /**
+   * @brief Wait until a snapshot of 'chart' is published: its reset is not, if closed while another write section was
+   * open (Published when that one is closed).
+   * @param chart
+   */
+  void awaitChart(const std::shared_ptr<const CompiledChart> &chart) const;
+  /**
+   * @brief Current epoch.
+   */
+  uint64_t epoch() const;
+  /**
+   * @brief Current changes generation, to wait on.
+   */
+  uint32_t generation() const;
+  /**
+   * @brief Sleep until a snapshot is published after 'generation'.
+   * @param generation Read before checking the situation, so that no change is missed.
+   * @param timeout
+   * @return false on timeout.
+   */
+  bool waitChange(uint32_t generation, std::chrono::nanoseconds timeout) const;
+};
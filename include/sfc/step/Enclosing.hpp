@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "Step.hpp"
+
+/**
+ * @brief Grafcet enclosing step: a step owning child charts, which live and die with it.
+ * - When the enclosing step is activated, its activation steps (Marked '*' in Grafcet) are activated with it.
+ * - When it is deactivated, every enclosed step is deactivated, nested enclosing steps and their own children included.
+ * - Enclosed steps run on the sequence's executor, like any other step: no child sequence, no extra thread.
+ * - Child charts must loop inside the enclosing step: their transitions can't lead out of it.
+ */
+class Enclosing : public Step {
+private:
+  /**
+   * @brief All enclosed steps.
+   */
+  std::unordered_map<unsigned int, std::shared_ptr<Step>> m_enclosed_steps;
+  /**
+   * @brief Steps activated with the enclosing step, in adding order.
+   */
+  std::vector<std::shared_ptr<Step>> m_activation_steps;
+  /**
+   * @brief To sync steps maps access.
+   */
+  mutable std::mutex steps_mutex;
+
+public:
+  /**
+   * @brief Construct a new Enclosing step.
+   * @param step_id
+   * @param m_actions
+   */
+  Enclosing(unsigned int step_id, std::vector<std::shared_ptr<StepAction>> m_actions = {});
+
+  /**
+   * @brief Add a step to the child charts.
+   * @param step Not an init-step (Child charts are started by their activation steps).
+   * @param activation True if activated with the enclosing step (Not a macro).
+   * @throw std::invalid_argument if step is nullptr or an init-step, or if a macro is an activation step.
+   */
+  void addStep(std::shared_ptr<Step> step, bool activation = false);
+  /**
+   * @brief Return true if step_id is directly enclosed.
+   * @param id
+   * @return true
+   * @return false
+   */
+  bool containsStep(unsigned int id) const;
+  /**
+   * @brief Get all directly enclosed steps.
+   * @return const std::unordered_map<unsigned int, std::shared_ptr<Step>>&
+   */
+  const std::unordered_map<unsigned int, std::shared_ptr<Step>> &steps() const;
+  /**
+   * @brief Get the steps activated with the enclosing step.
+   * @return const std::vector<std::shared_ptr<Step>>&
+   */
+  const std::vector<std::shared_ptr<Step>> &activationSteps() const;
+};
@@ -19,6 +19,10 @@ private:
    * @brief Last added step.
    */
   std::shared_ptr<Step> m_last = nullptr;
+  /**
+   * @brief Definition transition -> this instance's one (Empty if not an instance).
+   */
+  std::unordered_map<const Transition *, std::shared_ptr<Transition>> m_instance_transitions;
   /**
    * @brief To sync steps maps access.
    */
@@ -65,6 +69,26 @@ public:
    */
   const std::unordered_map<unsigned int, std::shared_ptr<Step>> &steps() const;
 
+  /**
+   * @brief Make a new instance of this macro, to use it several times in a sequence.
+   * - Steps ids are remapped (Step id + 'id_offset'), each instance has its own steps and inner transitions,
+   *   so that instances states (Activations, receptivities, join counters...) never cross.
+   * - Step actions and transitions predicates are shared with this macro: only the (Small) steps and transitions are
+   *   allocated.
+   * - The exit transitions of this macro are not copied: add the instance's own ones with 'addTransition'.
+   * @param step_id Id of the instance.
+   * @param id_offset Added to each step id.
+   * @return std::shared_ptr<Macro>
+   * @throw std::invalid_argument if the macro is empty, contains a macro, or if an inner transition leaves it.
+   */
+  std::shared_ptr<Macro> instantiate(unsigned int step_id, unsigned int id_offset) const;
+  /**
+   * @brief Get the instance's transition made from a transition of the definition.
+   * @param definition_transition
+   * @return std::shared_ptr<Transition> nullptr if not an inner transition of the definition.
+   */
+  std::shared_ptr<Transition> transition(const std::shared_ptr<Transition> &definition_transition) const;
+
   /**
    * @brief To know if step is activated.
    * @return true
@@ -79,4 +103,10 @@ public:
    * @param t Transition to add.
    */
   void addTransition(std::shared_ptr<Transition> t) override;
+  /**
+   * @brief Remove transition from step (And from its last step).
+   * @param t Transition to remove.
+   * @return true if it was one of the step transitions.
+   */
+  bool removeTransition(const std::shared_ptr<Transition> &t) override;
 };
\ No newline at end of file
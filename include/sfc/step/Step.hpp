@@ -13,7 +13,7 @@ class Transition;
 class Step {
 
 public:
-  enum StepType : uint8_t { INIT_STEP, DEFAULT_STEP, END_STEP, MACRO_STEP };
+  enum StepType : uint8_t { INIT_STEP, DEFAULT_STEP, END_STEP, MACRO_STEP, ENCLOSING_STEP };
 
 protected:
   /**
@@ -28,6 +28,10 @@ protected:
    * @brief True if is activated (Currently running, all steps actions triggered).
    */
   std::atomic_bool m_activated;
+  /**
+   * @brief Activations count (A short activation can be missed by only checking 'm_activated').
+   */
+  std::atomic_uint32_t m_activations;
   /**
    * @brief Step Actions.
    */
@@ -66,6 +70,12 @@ public:
    * @return false
    */
   bool isMacroStep() const;
+  /**
+   * @brief To know if it's an enclosing step.
+   * @return true
+   * @return false
+   */
+  bool isEnclosingStep() const;
   /**
    * @brief To know if step is activated.
    * @return true
@@ -77,6 +87,11 @@ public:
    * @param activated
    */
   void setActivated(bool activated);
+  /**
+   * @brief Get the Activations count, since the step creation.
+   * @return uint32_t
+   */
+  uint32_t activationsCount() const;
   /**
    * @brief Get StepType.
    * @return StepType
@@ -100,6 +115,12 @@ public:
    * @param t Transition to add.
    */
   virtual void addTransition(std::shared_ptr<Transition> t);
+  /**
+   * @brief Remove transition from step.
+   * @param t Transition to remove.
+   * @return true if it was one of the step transitions.
+   */
+  virtual bool removeTransition(const std::shared_ptr<Transition> &t);
   /**
    * @brief Get the Next Transitions.
    * @return const std::vector<std::shared_ptr<Transition>>&
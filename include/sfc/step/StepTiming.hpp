@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Dwell times of a step (Time from activation to deactivation), as read from its 'StepTiming'.
+ * Power of two buckets, in microseconds: bucket 0 is below 1us, bucket i (i > 0) from 2^(i-1)us up to 2^i us,
+ * the last one is open.
+ */
+struct DwellHistogram {
+  static constexpr uint32_t BUCKETS_COUNT = 32;
+
+  uint64_t count = 0;
+  std::chrono::nanoseconds total{0};
+  std::chrono::nanoseconds max{0};
+  std::array<uint32_t, BUCKETS_COUNT> buckets = {};
+
+  /**
+   * @brief Bucket of a dwell time.
+   * @param dwell
+   * @return uint32_t
+   */
+  static uint32_t bucket(std::chrono::nanoseconds dwell);
+  /**
+   * @brief Upper bound of a bucket (The last one: 'max').
+   * @param bucket
+   * @return std::chrono::nanoseconds
+   */
+  std::chrono::nanoseconds upperBound(uint32_t bucket) const;
+  /**
+   * @brief Mean dwell time.
+   * @return std::chrono::nanoseconds 0 if never deactivated.
+   */
+  std::chrono::nanoseconds mean() const;
+  /**
+   * @brief Upper bound of the bucket holding the 'ratio' quantile (e.g. 0.99).
+   * @param ratio
+   * @return std::chrono::nanoseconds 0 if never deactivated.
+   */
+  std::chrono::nanoseconds quantile(double ratio) const;
+};
+
+/**
+ * @brief Activation time (X.T) and dwell times of one step, in the per step index block of a sequence live graph.
+ * Written by the thread running the step only (Activation, deactivation), read by anyone: no lock.
+ * Times are the sequence clock ones (Virtual while simulated).
+ */
+struct alignas(64) StepTiming {
+  /**
+   * @brief Activation time, -1 while inactive.
+   */
+  std::atomic<int64_t> activated_at{-1};
+  std::atomic_uint64_t total_ns{0};
+  std::atomic<int64_t> max_ns{0};
+  std::atomic_uint32_t buckets[DwellHistogram::BUCKETS_COUNT] = {};
+
+  void activated(std::chrono::nanoseconds now) { activated_at.store(now.count(), std::memory_order_release); }
+  /**
+   * @brief Clear the activation time and count its dwell time.
+   * @param now
+   */
+  void deactivated(std::chrono::nanoseconds now);
+  /**
+   * @brief Copy everything from 'other' (Carried over to a new live graph).
+   * @param other
+   */
+  void copyFrom(const StepTiming &other);
+  DwellHistogram histogram() const;
+};
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "sfc/step/action/StepAction.hpp"
+#include "sfc/sync/StopToken.hpp"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Dedicated, bounded set of workers running step actions.
+ * - Actions are queued by priority class, 'StepAction::CRITICAL' ones are always dequeued first.
+ * - Inside a same priority class, actions are run in submission order.
+ * - Decouples actions from the steps threads: a slow action no longer holds the worker evaluating transitions.
+ */
+class ActionExecutor {
+public:
+  /**
+   * @brief Completion handle of a batch of submitted actions (All actions of a step activation).
+   */
+  class Batch {
+    friend class ActionExecutor;
+
+  private:
+    std::mutex mutex;
+    std::condition_variable cond_var;
+    /**
+     * @brief Pending actions count, per priority class.
+     */
+    std::array<uint32_t, StepAction::PRIORITIES_COUNT> m_pending{};
+
+    void done(StepAction::Priority priority);
+
+  public:
+    /**
+     * @brief Wait for all actions having a priority higher or equal than 'priority' to be done.
+     * @param priority Lowest priority class to wait for.
+     * @param stop Give up waiting as soon as it is requested (Woken at once).
+     */
+    void wait(StepAction::Priority priority, const StopToken &stop);
+  };
+
+private:
+  struct Job {
+    std::shared_ptr<StepAction> action;
+    std::shared_ptr<Batch> batch;
+    /**
+     * @brief Priority at submission: the one counted as pending in 'batch' (The action one may change meanwhile).
+     */
+    StepAction::Priority priority;
+  };
+
+  /**
+   * @brief To protect queues access.
+   */
+  std::mutex queue_mutex;
+  /**
+   * @brief Notified when a job is queued or when stopping.
+   */
+  std::condition_variable queue_cond_var;
+  /**
+   * @brief One FIFO per priority class.
+   */
+  std::array<std::deque<Job>, StepAction::PRIORITIES_COUNT> m_queues;
+  /**
+   * @brief Workers.
+   */
+  std::vector<std::thread> m_workers;
+  /**
+   * @brief Stop requested.
+   */
+  bool m_stopping = false;
+  /**
+   * @brief Queued (not yet started) actions count.
+   */
+  std::atomic_uint32_t m_pending_count;
+  /**
+   * @brief Count of actions that threw.
+   */
+  std::atomic_uint64_t m_failed_count;
+
+  void work();
+
+public:
+  /**
+   * @brief Construct a new Action Executor and spawn its workers.
+   * @param workers_count Bounded workers count (at least one).
+   */
+  ActionExecutor(uint32_t workers_count = 2);
+  /**
+   * @brief Destroy the Action Executor. Already queued actions are run before joining workers.
+   */
+  ~ActionExecutor();
+
+  /**
+   * @brief Queue all 'actions' according to their priority class.
+   * @param actions
+   * @return std::shared_ptr<Batch> to wait for them.
+   */
+  std::shared_ptr<Batch> submit(const std::vector<std::shared_ptr<StepAction>> &actions);
+
+  /**
+   * @brief Pin all workers on 'cpus'.
+   * @param cpus
+   * @return true on success.
+   */
+  bool applyAffinity(const std::vector<int> &cpus);
+
+  /**
+   * @brief Workers count.
+   * @return uint32_t
+   */
+  uint32_t size() const;
+  /**
+   * @brief Queued (not yet started) actions count.
+   * @return uint32_t
+   */
+  uint32_t pendingCount() const;
+  /**
+   * @brief Count of actions that threw an exception.
+   * @return uint64_t
+   */
+  uint64_t failedCount() const;
+};
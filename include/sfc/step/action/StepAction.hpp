@@ -1,18 +1,42 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 
 using StepActionCallback = std::function<void()>;
 
 class StepAction {
+public:
+  /**
+   * @brief Priority class of the action, used by the 'ActionExecutor' to order pending actions.
+   * 'CRITICAL' actions are always dequeued first.
+   */
+  enum Priority : uint8_t { CRITICAL = 0, HIGH = 1, NORMAL = 2, LOW = 3 };
+  static constexpr uint8_t PRIORITIES_COUNT = 4;
+
 private:
   /* data */
   StepActionCallback m_action_callback = nullptr;
+  /**
+   * @brief Priority class.
+   */
+  Priority m_priority = NORMAL;
 
 public:
-  StepAction(StepActionCallback action_callback = nullptr);
+  StepAction(StepActionCallback action_callback = nullptr, Priority priority = NORMAL);
   ~StepAction() = default;
 
+  /**
+   * @brief Get the Priority.
+   * @return Priority
+   */
+  Priority getPriority() const;
+  /**
+   * @brief Set the Priority.
+   * @param priority
+   */
+  void setPriority(Priority priority);
+
   /**
    * @brief Execute Step Action !
    */
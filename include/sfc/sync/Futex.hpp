@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#ifndef __linux__
+#include <condition_variable>
+#include <mutex>
+#endif
+
+/**
+ * @brief 32 bits generation word that threads can sleep on until it changes.
+ * Linux futex, or a condition variable elsewhere. Bumping without waiter costs two atomic operations (No syscall).
+ */
+class Futex {
+private:
+  std::atomic_uint32_t m_word;
+  std::atomic_uint32_t m_waiters;
+#ifndef __linux__
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+#endif
+
+public:
+  Futex();
+
+  /**
+   * @brief Current generation.
+   */
+  uint32_t load() const;
+  /**
+   * @brief Increment the generation and wake all waiters.
+   */
+  void bump();
+  /**
+   * @brief Sleep while the generation is 'expected'.
+   * @param expected
+   * @param timeout 'std::chrono::nanoseconds::max()' to wait forever.
+   * @return false on timeout (Can wake up spuriously: callers re-check their condition).
+   */
+  bool wait(uint32_t expected, std::chrono::nanoseconds timeout = std::chrono::nanoseconds::max());
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "sfc/sync/Futex.hpp"
+#include <atomic>
+#include <chrono>
+#include <utility>
+
+/**
+ * @brief One stop request shared by every wait of an engine run: requesting it wakes them all at once.
+ * - Timed sleeps ('sleepFor') sleep on a futex bumped by the request (No polling of a flag).
+ * - Condition variable waits register a 'Callback' notifying them, for as long as they wait (Intrusive list: no
+ *   allocation, a spin lock held for a few pointer updates).
+ * Reset for the next run with 'reset'.
+ */
+class StopToken {
+public:
+  /**
+   * @brief Registration of a 'Callback': intrusive list node, no allocation.
+   */
+  class CallbackNode {
+    friend class StopToken;
+
+  private:
+    CallbackNode *m_prev = nullptr;
+    CallbackNode *m_next = nullptr;
+    void (*m_invoke)(CallbackNode *);
+    /**
+     * @brief Set by the stop request once the callback returned (Its destruction waits for it).
+     */
+    std::atomic_bool m_done;
+
+  protected:
+    explicit CallbackNode(void (*invoke)(CallbackNode *)) : m_invoke(invoke), m_done(false) {}
+    ~CallbackNode() = default;
+
+  public:
+    CallbackNode(const CallbackNode &) = delete;
+    CallbackNode &operator=(const CallbackNode &) = delete;
+  };
+
+  /**
+   * @brief Called once by the stop request, while registered (RAII).
+   * Called right away, by the constructor, if the stop is already requested.
+   * @note Callbacks run out of the token lock, but the destructor waits for a running one: they only notify (e.g. lock
+   * the waiter's mutex and 'notify_all'). To avoid a deadlock, construct it before locking that mutex (Destroyed after
+   * it is unlocked).
+   */
+  template <typename Fn> class Callback : private CallbackNode {
+  private:
+    const StopToken &m_token;
+    Fn m_fn;
+
+    static void invoke(CallbackNode *node) { static_cast<Callback *>(node)->m_fn(); }
+
+  public:
+    Callback(const StopToken &token, Fn fn) : CallbackNode(&invoke), m_token(token), m_fn(std::move(fn)) {
+      m_token.attach(*this);
+    }
+    ~Callback() { m_token.detach(*this); }
+  };
+
+private:
+  std::atomic_bool m_stop_requested;
+  mutable Futex m_futex;
+  /**
+   * @brief Spin lock of the callbacks list (Held for a few pointer updates only, never while calling a callback).
+   */
+  mutable std::atomic_flag m_lock = ATOMIC_FLAG_INIT;
+  mutable CallbackNode *m_callbacks = nullptr;
+  /**
+   * @brief Callback being called by the stop request.
+   */
+  mutable CallbackNode *m_running = nullptr;
+
+  void lock() const;
+  void unlock() const;
+  void attach(CallbackNode &node) const;
+  void detach(CallbackNode &node) const;
+
+public:
+  StopToken();
+
+  /**
+   * @brief To know if the stop is requested.
+   * @return true
+   * @return false
+   */
+  bool stopRequested() const { return m_stop_requested.load(std::memory_order_acquire); }
+  /**
+   * @brief Request the stop: wake every sleep and call every registered callback.
+   * @return true if this call requested it (false if already requested).
+   */
+  bool requestStop();
+  /**
+   * @brief Clear the stop request (Next run).
+   */
+  void reset();
+  /**
+   * @brief Sleep for 'duration', unless the stop is requested meanwhile.
+   * @param duration
+   * @return false if the stop is requested.
+   */
+  bool sleepFor(std::chrono::nanoseconds duration) const;
+};
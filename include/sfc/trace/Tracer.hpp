@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One traced span or flow point (See 'Tracer').
+ */
+struct TraceEvent {
+  enum Kind : uint8_t {
+    /**
+     * @brief Step activation, from its activation to its deactivation.
+     */
+    STEP,
+    /**
+     * @brief Step actions, run inline or waited for on the actions executor.
+     */
+    ACTIONS,
+    /**
+     * @brief Wait for the previous step deactivation (Handoff).
+     */
+    WAIT_PREVIOUS,
+    /**
+     * @brief Step changed callbacks round.
+     */
+    CALLBACKS,
+    /**
+     * @brief Transition firing (Arrow tail), and next step activation (Arrow head).
+     */
+    FLOW_START,
+    FLOW_END
+  };
+
+  Kind kind;
+  /**
+   * @brief Executor worker index (-1 for the thread which started the sequence, or a foreign thread).
+   */
+  int worker;
+  /**
+   * @brief Simultaneous branch of the step (-1 if unknown).
+   */
+  int branch;
+  unsigned int step_id;
+  std::chrono::nanoseconds begin;
+  std::chrono::nanoseconds end;
+  /**
+   * @brief Flow id (Flow events only).
+   */
+  uint64_t flow_id;
+};
+
+/**
+ * @brief Traces the execution of a sequence, to be looked at in 'chrome://tracing' or 'ui.perfetto.dev'.
+ * - Attached with 'Sequence::setTracer'. Each step run reports its activation, actions, handoff wait and callbacks,
+ *   on the track of the worker running it and on the track of its simultaneous branch.
+ * - Transition firings are linked to the next steps activations by flow arrows (One per converging branch).
+ * - Events are kept in memory up to 'capacity' (Further ones are counted as dropped), then exported as
+ *   Chrome trace-event JSON.
+ * - Times are real (Steady clock): a trace shows where the time went, even when a step waits for a virtual clock.
+ */
+class Tracer {
+private:
+  mutable std::mutex m_mutex;
+  std::size_t m_capacity;
+  std::vector<TraceEvent> m_events;
+  uint64_t m_dropped = 0;
+  uint64_t m_next_flow = 1;
+  /**
+   * @brief Flows fired towards a step, not yet ended by its activation.
+   */
+  std::unordered_map<unsigned int, std::vector<uint64_t>> m_pending_flows;
+
+  void push(const TraceEvent &event);
+
+public:
+  /**
+   * @brief Construct a new Tracer.
+   * @param capacity Kept events count (Reserved at once: tracing allocates nothing afterwards, but the flows).
+   */
+  explicit Tracer(std::size_t capacity = 1 << 18);
+
+  /**
+   * @brief Current (steady) time.
+   */
+  static std::chrono::nanoseconds now();
+
+  /**
+   * @brief Trace a span.
+   * @param kind STEP, ACTIONS, WAIT_PREVIOUS or CALLBACKS.
+   */
+  void span(TraceEvent::Kind kind, unsigned int step_id, int worker, int branch, std::chrono::nanoseconds begin,
+            std::chrono::nanoseconds end);
+  /**
+   * @brief Trace the firing of a transition from 'step_id' towards 'next_id'.
+   */
+  void flowStart(unsigned int step_id, unsigned int next_id, int worker, int branch, std::chrono::nanoseconds time);
+  /**
+   * @brief Trace the activation of 'step_id': ends the flows fired towards it.
+   */
+  void flowEnd(unsigned int step_id, int worker, int branch, std::chrono::nanoseconds time);
+
+  /**
+   * @brief Forget all events.
+   */
+  void clear();
+  /**
+   * @brief Copy of the kept events.
+   */
+  std::vector<TraceEvent> events() const;
+  uint64_t eventsCount() const;
+  uint64_t droppedCount() const;
+
+  /**
+   * @brief Export as Chrome trace-event JSON (Process 1: workers tracks, process 2: branches tracks).
+   * @param out
+   */
+  void writeChromeJson(std::ostream &out) const;
+  /**
+   * @brief Export as Chrome trace-event JSON to 'path'.
+   * @throw std::runtime_error if the file cannot be written.
+   */
+  void writeChromeJson(const std::string &path) const;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Notified on every effective receptivity change of an observed transition.
+ */
+class ReceptivityObserver {
+public:
+  virtual ~ReceptivityObserver() = default;
+
+  /**
+   * @brief Called by the thread changing the receptivity.
+   * @param transition_id Id given when attaching the observer.
+   * @param state New receptivity state.
+   */
+  virtual void receptivityChanged(uint32_t transition_id, bool state) = 0;
+};
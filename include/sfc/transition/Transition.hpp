@@ -1,7 +1,11 @@
 #pragma once
 
 #include "sfc/transition/Receptivity.hpp"
+#include "sfc/transition/ReceptivityObserver.hpp"
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -35,6 +39,20 @@ private:
    */
   ValidationMode m_validation_mode;
 
+  /**
+   * @brief Observer of receptivity changes (Not owned).
+   */
+  std::atomic<ReceptivityObserver *> m_observer;
+  /**
+   * @brief Id given to 'm_observer'.
+   */
+  std::atomic_uint32_t m_observer_id;
+  /**
+   * @brief Receptivity computed by the engine itself (Optional), every 'm_sampling_period'.
+   */
+  std::function<bool()> m_predicate;
+  std::chrono::microseconds m_sampling_period{0};
+
 public:
   static auto mk_sp_transition(std::initializer_list<std::weak_ptr<Step>> nexts,
                                std::initializer_list<std::weak_ptr<Step>> validations, ValidationMode mode = ALL) {
@@ -75,6 +93,49 @@ public:
   bool getReceptivityState() const;
   /**
    * @brief Set the associated receptivity state.
+   * The observer, if any, is notified when the state effectively changes.
    */
   void setReceptivityState(bool state);
+  /**
+   * @brief Set the receptivity changes observer.
+   * @param observer nullptr to detach. Must outlive its attachment.
+   * @param id Id given back to the observer on each change.
+   */
+  void setObserver(ReceptivityObserver *observer, uint32_t id = 0);
+  /**
+   * @brief Get the receptivity changes observer.
+   * @return ReceptivityObserver*
+   */
+  ReceptivityObserver *getObserver() const;
+  /**
+   * @brief Set the receptivity predicate: a cheap condition (e.g. an atomic read) the engine evaluates itself,
+   * instead of a thread calling 'setReceptivityState'.
+   * Predicates of a same sampling period are evaluated together, once per period, by one of the steps loops
+   * (Or simulation ticks). Each evaluation sets the receptivity state, like 'setReceptivityState'.
+   * Taken into account from the next start (Or 'Sequence::apply'): not to be changed while the sequence runs.
+   * @param predicate nullptr to remove it.
+   * @param period Sampling period (0: every transitions polling).
+   */
+  void setPredicate(std::function<bool()> predicate, std::chrono::microseconds period = std::chrono::microseconds(0));
+  /**
+   * @brief To know if the receptivity is given by a predicate.
+   * @return true
+   * @return false
+   */
+  bool hasPredicate() const;
+  /**
+   * @brief Get the predicate.
+   * @return const std::function<bool()>& Empty if none.
+   */
+  const std::function<bool()> &getPredicate() const;
+  /**
+   * @brief Get the predicate sampling period.
+   * @return std::chrono::microseconds
+   */
+  std::chrono::microseconds getSamplingPeriod() const;
+  /**
+   * @brief Evaluate the predicate, and set the receptivity state with its result.
+   * @return bool The receptivity state (Unchanged if no predicate).
+   */
+  bool sample();
 };
\ No newline at end of file
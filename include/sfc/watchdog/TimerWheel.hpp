@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Timers of a fixed set of keys: one slot per key, holding its deadline, re-armed in place.
+ * - Arming is lock-free and allocation free: a store to the key slot, then the earliest deadline lowered.
+ * - No thread: advanced by its users ('advance'), timers expiring at the first tick boundary after their deadline.
+ *   Only the earliest pending deadline is tracked: slots are walked once it is reached.
+ * - The deadline is the timer cookie: a timer re-armed or cancelled is never expired for its previous deadline.
+ */
+class TimerWheel {
+public:
+  struct Timer {
+    uint32_t key;
+    std::chrono::nanoseconds deadline;
+  };
+
+private:
+  static constexpr int64_t DISARMED = INT64_MIN;
+  static constexpr int64_t NEVER = INT64_MAX;
+
+  std::chrono::nanoseconds m_resolution;
+  uint32_t m_keys_count;
+  /**
+   * @brief Deadline per key, in nanoseconds (DISARMED if none).
+   */
+  std::unique_ptr<std::atomic<int64_t>[]> m_slots;
+  /**
+   * @brief Tick of the earliest pending deadline (NEVER if none).
+   */
+  std::atomic<int64_t> m_earliest;
+  std::atomic_uint32_t m_size;
+
+  int64_t expiryTick(int64_t deadline) const;
+  void lowerEarliest(int64_t tick);
+
+public:
+  /**
+   * @brief Construct a new Timer Wheel.
+   * @param resolution Tick duration (At least 1us).
+   * @param keys_count Keys are in [0, keys_count).
+   */
+  TimerWheel(std::chrono::nanoseconds resolution, uint32_t keys_count);
+
+  std::chrono::nanoseconds resolution() const;
+  /**
+   * @brief Armed timers count.
+   * @return uint32_t
+   */
+  uint32_t size() const;
+  /**
+   * @brief Arm the timer of a key, replacing its pending one if any.
+   * @param key
+   * @param deadline
+   */
+  void schedule(uint32_t key, std::chrono::nanoseconds deadline);
+  /**
+   * @brief Disarm the timer of a key, if still armed for 'deadline'.
+   * @param key
+   * @param deadline
+   * @return true if disarmed.
+   */
+  bool cancel(uint32_t key, std::chrono::nanoseconds deadline);
+  /**
+   * @brief To know if the earliest pending deadline is reached (Cheap: one load).
+   * @param now
+   * @return true
+   * @return false
+   */
+  bool due(std::chrono::nanoseconds now) const;
+  /**
+   * @brief Expire the timers up to 'now' (One caller at a time, concurrent arming allowed).
+   * @param now
+   * @param expired Called for each expired timer, already disarmed.
+   * @return uint32_t Expired timers count.
+   */
+  uint32_t advance(std::chrono::nanoseconds now, const std::function<void(const Timer &)> &expired);
+};
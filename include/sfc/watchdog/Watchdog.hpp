@@ -0,0 +1,168 @@
+#pragma once
+
+#include "sfc/watchdog/TimerWheel.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class CompiledChart;
+
+/**
+ * @brief Watchdog limits of a sequence (See 'Sequence::setWatchdogConfig').
+ * - Loops: a loop is a cycle of the chart (Its steps strongly connected through transitions, macros and enclosing steps
+ *   included). Its activations (Of any of its steps) are counted within 'rate_window': more than 'max_loop_activations'
+ *   is a runaway loop, whatever the pool size or load.
+ * - Dwell: a step active longer than its 'max_dwell' is stuck. Checked with a 'resolution' timer per step, re-armed at
+ *   each activation and expired by the steps polling loops (No thread).
+ */
+struct WatchdogConfig {
+  /**
+   * @brief Activations allowed per loop within 'rate_window' (0 to disable).
+   */
+  uint32_t max_loop_activations = 0;
+  std::chrono::milliseconds rate_window{100};
+  /**
+   * @brief Per loop limit, keyed by the id of any step of the loop (Overrides 'max_loop_activations', 0 disables).
+   */
+  std::unordered_map<unsigned int, uint32_t> loop_max_activations;
+  /**
+   * @brief Maximum dwell time per step id.
+   */
+  std::unordered_map<unsigned int, std::chrono::microseconds> max_dwell;
+  std::chrono::microseconds resolution{1000};
+  /**
+   * @brief Stop the sequence on violation ('Sequence::CRAZY_LOOPING_STOP', 'Sequence::DWELL_TIMEOUT_STOP'),
+   * else only report it.
+   */
+  bool stop_on_violation = true;
+
+  /**
+   * @brief To know if any limit is set.
+   * @return true
+   * @return false
+   */
+  bool enabled() const;
+};
+
+/**
+ * @brief Watchdog violation, given to the watchdog callbacks.
+ */
+struct WatchdogEvent {
+  enum Kind : uint8_t { LOOP_RATE, DWELL_TIMEOUT };
+
+  Kind kind;
+  /**
+   * @brief Step activated over the loop limit, or active over its dwell limit.
+   */
+  unsigned int step_id;
+  /**
+   * @brief Loop activations within the window (LOOP_RATE).
+   */
+  uint32_t activations = 0;
+  /**
+   * @brief Dwell time when detected (DWELL_TIMEOUT).
+   */
+  std::chrono::nanoseconds dwell{0};
+};
+
+/**
+ * @brief Watchdog of one compiled chart: loops activation windows and dwell timers, no lock on the firing path.
+ */
+class Watchdog {
+public:
+  static constexpr uint32_t NO_LOOP = UINT32_MAX;
+  static constexpr uint32_t NO_TIMER = UINT32_MAX;
+
+private:
+  struct alignas(64) LoopWindow {
+    std::atomic<int64_t> begin{0};
+    std::atomic_uint32_t count{0};
+    uint32_t max_activations = 0;
+  };
+
+  std::chrono::nanoseconds m_rate_window;
+  /**
+   * @brief Loop per step index (NO_LOOP if not in a loop).
+   */
+  std::vector<uint32_t> m_loops;
+  std::unique_ptr<LoopWindow[]> m_windows;
+  uint32_t m_loops_count = 0;
+  /**
+   * @brief Dwell timer key per step index (NO_TIMER if no dwell limit).
+   */
+  std::vector<uint32_t> m_dwell_keys;
+  /**
+   * @brief Step index and dwell limit (In nanoseconds) per dwell timer key.
+   */
+  std::vector<std::pair<uint32_t, int64_t>> m_dwell_limits;
+  /**
+   * @brief One timer per step with a dwell limit, its deadline telling the activation it was armed for.
+   */
+  std::unique_ptr<TimerWheel> m_wheel;
+  /**
+   * @brief Taken by the steps loop expiring the dwell timers (One at a time).
+   */
+  std::atomic_flag m_polling = ATOMIC_FLAG_INIT;
+
+public:
+  /**
+   * @brief Find the loops of 'chart' and index the limits of 'config' (Unknown steps ids are ignored).
+   * @param chart
+   * @param config
+   */
+  Watchdog(const CompiledChart &chart, const WatchdogConfig &config);
+
+  /**
+   * @brief Loops of a chart: strongly connected steps (Iterative Tarjan).
+   * @param chart
+   * @param loops_count Filled with the loops count.
+   * @return std::vector<uint32_t> Loop per step index (NO_LOOP if not in a loop).
+   */
+  static std::vector<uint32_t> findLoops(const CompiledChart &chart, uint32_t &loops_count);
+
+  uint32_t loopsCount() const;
+  /**
+   * @brief Get the loop of a step.
+   * @param step_index
+   * @return uint32_t NO_LOOP if not in a loop.
+   */
+  uint32_t loop(uint32_t step_index) const;
+  /**
+   * @brief Count a step activation (Firing path): in its loop window, and arm its dwell timer.
+   * @param step_index
+   * @param now
+   * @return uint32_t Loop activations within the window if this one is the first over the loop limit, else 0.
+   */
+  uint32_t activated(uint32_t step_index, std::chrono::nanoseconds now);
+  /**
+   * @brief Arm the dwell timer of a step activation, if the step has a dwell limit (Its previous one replaced).
+   * @param step_index
+   * @param activated_at Activation time, also telling this activation from the next ones.
+   */
+  void armDwell(uint32_t step_index, std::chrono::nanoseconds activated_at);
+  /**
+   * @brief Disarm the dwell timer of a step deactivation, if still armed for that activation.
+   * @param step_index
+   * @param activated_at
+   */
+  void disarmDwell(uint32_t step_index, std::chrono::nanoseconds activated_at);
+  /**
+   * @brief Expire the dwell timers up to 'now', unless another steps loop is already doing it.
+   * @param now
+   * @param still_active Called with each expired (step index, activation time): true if that activation is still the
+   * current one (Else the step was deactivated meanwhile).
+   * @param timeout Called for each step over its dwell limit, with its dwell time.
+   * @return uint32_t Steps over their dwell limit.
+   */
+  uint32_t poll(std::chrono::nanoseconds now, const std::function<bool(uint32_t, int64_t)> &still_active,
+                const std::function<void(uint32_t, std::chrono::nanoseconds)> &timeout);
+  /**
+   * @brief Armed dwell timers.
+   * @return uint32_t
+   */
+  uint32_t pendingTimers() const;
+};
@@ -0,0 +1,48 @@
+#include "sfc/ChangeSet.hpp"
+
+#include <stdexcept>
+
+ChangeSet &ChangeSet::addStep(std::shared_ptr<Step> step) {
+  if (!step) {
+    throw std::invalid_argument("Trying to add nullptr Step to change set !");
+  }
+  m_added_steps.push_back(step);
+  return *this;
+}
+
+ChangeSet &ChangeSet::removeStep(unsigned int id) {
+  m_removed_steps.push_back(id);
+  return *this;
+}
+
+ChangeSet &ChangeSet::addTransition(unsigned int step_id, std::shared_ptr<Transition> transition) {
+  if (!transition) {
+    throw std::invalid_argument("Trying to add nullptr Transition to change set !");
+  }
+  m_added_transitions.emplace_back(step_id, transition);
+  return *this;
+}
+
+ChangeSet &ChangeSet::removeTransition(unsigned int step_id, std::shared_ptr<Transition> transition) {
+  m_removed_transitions.emplace_back(step_id, transition);
+  return *this;
+}
+
+ChangeSet &ChangeSet::mapActiveStep(unsigned int from_id, unsigned int to_id) {
+  m_active_steps_mapping[from_id] = to_id;
+  return *this;
+}
+
+const std::vector<std::shared_ptr<Step>> &ChangeSet::addedSteps() const { return m_added_steps; }
+
+const std::vector<unsigned int> &ChangeSet::removedSteps() const { return m_removed_steps; }
+
+const std::vector<ChangeSet::StepTransition> &ChangeSet::addedTransitions() const { return m_added_transitions; }
+
+const std::vector<ChangeSet::StepTransition> &ChangeSet::removedTransitions() const { return m_removed_transitions; }
+
+const std::unordered_map<unsigned int, unsigned int> &ChangeSet::activeStepsMapping() const { return m_active_steps_mapping; }
+
+bool ChangeSet::empty() const {
+  return m_added_steps.empty() && m_removed_steps.empty() && m_added_transitions.empty() && m_removed_transitions.empty();
+}
@@ -0,0 +1,65 @@
+#include "sfc/ChartArena.hpp"
+
+#include <memory_resource>
+
+class ChartArena::Resource {
+public:
+  std::pmr::monotonic_buffer_resource pool;
+  std::size_t bytes = 0;
+  std::size_t objects = 0;
+
+  explicit Resource(std::size_t block_size) : pool(block_size) {}
+};
+
+namespace {
+/**
+ * @brief Allocator of the arena, given to 'allocate_shared': each control block holds a copy, keeping the arena alive.
+ */
+template <typename T> class ArenaAllocator {
+public:
+  using value_type = T;
+
+  std::shared_ptr<ChartArena::Resource> resource;
+
+  explicit ArenaAllocator(std::shared_ptr<ChartArena::Resource> resource) : resource(std::move(resource)) {}
+  template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : resource(other.resource) {}
+
+  T *allocate(std::size_t n) {
+    resource->bytes += n * sizeof(T);
+    resource->objects++;
+    return static_cast<T *>(resource->pool.allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T *p, std::size_t n) { resource->pool.deallocate(p, n * sizeof(T), alignof(T)); }
+
+  template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return resource == other.resource; }
+  template <typename U> bool operator!=(const ArenaAllocator<U> &other) const { return resource != other.resource; }
+};
+} // namespace
+
+ChartArena::ChartArena(std::size_t block_size) : m_resource(std::make_shared<Resource>(block_size)) {}
+
+std::shared_ptr<Step> ChartArena::makeStep(unsigned int step_id, Step::StepType step_type,
+                                           std::vector<std::shared_ptr<StepAction>> actions) {
+  return std::allocate_shared<Step>(ArenaAllocator<Step>(m_resource), step_id, step_type, std::move(actions));
+}
+
+std::shared_ptr<Macro> ChartArena::makeMacro(unsigned int step_id, std::vector<std::shared_ptr<StepAction>> actions) {
+  return std::allocate_shared<Macro>(ArenaAllocator<Macro>(m_resource), step_id, std::move(actions));
+}
+
+std::shared_ptr<Transition> ChartArena::makeTransition(std::initializer_list<std::weak_ptr<Step>> nexts,
+                                                       std::initializer_list<std::weak_ptr<Step>> validations,
+                                                       Transition::ValidationMode mode) {
+  return makeTransition(std::vector<std::weak_ptr<Step>>(nexts), std::vector<std::weak_ptr<Step>>(validations), mode);
+}
+
+std::shared_ptr<Transition> ChartArena::makeTransition(std::vector<std::weak_ptr<Step>> nexts,
+                                                       std::vector<std::weak_ptr<Step>> validations,
+                                                       Transition::ValidationMode mode) {
+  return std::allocate_shared<Transition>(ArenaAllocator<Transition>(m_resource), std::move(nexts), std::move(validations),
+                                          mode);
+}
+
+std::size_t ChartArena::bytesUsed() const { return m_resource->bytes; }
+
+std::size_t ChartArena::objectsCount() const { return m_resource->objects; }
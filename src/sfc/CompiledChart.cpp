@@ -0,0 +1,208 @@
+#include "sfc/CompiledChart.hpp"
+#include "sfc/step/Enclosing.hpp"
+#include "sfc/step/Macro.hpp"
+#include "sfc/step/Step.hpp"
+#include "sfc/transition/Transition.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+std::shared_ptr<const CompiledChart>
+CompiledChart::compile(const std::unordered_map<unsigned int, std::shared_ptr<Step>> &initial_steps,
+                       const std::unordered_map<unsigned int, std::shared_ptr<Step>> &steps,
+                       const TransitionsOverrides *overrides) {
+  auto chart = std::make_shared<CompiledChart>();
+  auto &refs = chart->m_step_refs;
+  refs.reserve(initial_steps.size() + steps.size());
+  for (const auto &p : initial_steps) {
+    refs.push_back(p.second);
+  }
+  for (const auto &p : steps) {
+    refs.push_back(p.second);
+  }
+  std::sort(refs.begin(), refs.end(), [](const auto &a, const auto &b) { return a->getStepId() < b->getStepId(); });
+
+  chart->m_steps.resize(refs.size());
+  chart->m_step_indexes.reserve(refs.size());
+  for (uint32_t i = 0; i < refs.size(); i++) {
+    chart->m_steps[i].step = refs[i].get();
+    chart->m_step_indexes[refs[i]->getStepId()] = i;
+  }
+
+  auto index_of = [&chart](const std::weak_ptr<Step> &s) {
+    auto step = s.lock();
+    uint32_t index = step ? chart->stepIndex(step->getStepId()) : NONE;
+    if (index == NONE || chart->m_steps[index].step != step.get()) {
+      throw std::invalid_argument("Transition refers to a step which is not part of the sequence !");
+    }
+    return index;
+  };
+
+  // Steps adjacency first, transitions are discovered on the way.
+  for (uint32_t i = 0; i < refs.size(); i++) {
+    auto &node = chart->m_steps[i];
+    if (refs[i]->isMacroStep()) {
+      auto macro = std::static_pointer_cast<Macro>(refs[i]);
+      node.macro_first = macro->first() ? index_of(macro->first()) : NONE;
+      node.macro_last = macro->last() ? index_of(macro->last()) : NONE;
+    }
+    if (refs[i]->isEnclosingStep()) {
+      auto enclosing = std::static_pointer_cast<Enclosing>(refs[i]);
+      std::vector<uint32_t> enclosed;
+      for (const auto &p : enclosing->steps()) {
+        enclosed.push_back(index_of(p.second));
+      }
+      std::sort(enclosed.begin(), enclosed.end());
+      node.enclosed_begin = chart->m_adjacency.size();
+      for (auto index : enclosed) {
+        chart->m_steps[index].enclosing = i;
+        chart->m_adjacency.push_back(index);
+      }
+      node.enclosed_end = chart->m_adjacency.size();
+      node.activations_begin = chart->m_adjacency.size();
+      for (const auto &step : enclosing->activationSteps()) {
+        chart->m_adjacency.push_back(index_of(step));
+      }
+      node.activations_end = chart->m_adjacency.size();
+    }
+    node.transitions_begin = chart->m_adjacency.size();
+    const std::vector<std::shared_ptr<Transition>> *transitions = &refs[i]->getNextTransitions();
+    if (overrides) {
+      auto it = overrides->find(refs[i].get());
+      if (it != overrides->end()) {
+        transitions = &it->second;
+      }
+    }
+    for (const auto &t : *transitions) {
+      auto it = chart->m_transition_indexes.find(t.get());
+      if (it == chart->m_transition_indexes.end()) {
+        it = chart->m_transition_indexes.emplace(t.get(), chart->m_transition_refs.size()).first;
+        chart->m_transition_refs.push_back(t);
+      }
+      chart->m_adjacency.push_back(it->second);
+    }
+    node.transitions_end = chart->m_adjacency.size();
+  }
+
+  // Macros steps are enclosed with their macro.
+  for (uint32_t i = 0; i < refs.size(); i++) {
+    if (refs[i]->isMacroStep() && chart->m_steps[i].enclosing != NONE) {
+      for (const auto &p : std::static_pointer_cast<Macro>(refs[i])->steps()) {
+        chart->m_steps[index_of(p.second)].enclosing = chart->m_steps[i].enclosing;
+      }
+    }
+  }
+
+  chart->m_transitions.resize(chart->m_transition_refs.size());
+  for (uint32_t i = 0; i < chart->m_transition_refs.size(); i++) {
+    const auto &t = chart->m_transition_refs[i];
+    auto &node = chart->m_transitions[i];
+    node.transition = t.get();
+    node.nexts_begin = chart->m_adjacency.size();
+    for (const auto &s : t->nexts()) {
+      chart->m_adjacency.push_back(index_of(s));
+    }
+    node.nexts_end = chart->m_adjacency.size();
+    node.validations_begin = chart->m_adjacency.size();
+    for (const auto &s : t->validations()) {
+      chart->m_adjacency.push_back(index_of(s));
+    }
+    node.validations_end = chart->m_adjacency.size();
+    node.required_count = (t->getValidationMode() == Transition::ALL) ? std::max<uint32_t>(t->validations().size(), 1) : 1;
+  }
+  chart->m_adjacency.shrink_to_fit();
+  for (const auto &node : chart->m_steps) {
+    for (auto t : chart->nextTransitions(&node - chart->m_steps.data())) {
+      for (auto index : chart->nexts(t)) {
+        if (chart->m_steps[index].enclosing != node.enclosing) {
+          throw std::invalid_argument("Transition leads out of its enclosing step ! That's forbidden !");
+        }
+      }
+    }
+  }
+
+  // FNV-1a.
+  uint64_t hash = 14695981039346656037ULL;
+  auto mix = [&hash](uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+      hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ULL;
+    }
+  };
+  for (const auto &node : chart->m_steps) {
+    mix(node.step->getStepId());
+    mix(node.step->type());
+    mix(node.macro_first);
+    mix(node.macro_last);
+    mix(node.enclosing);
+    mix(node.activations_end - node.activations_begin);
+    mix(node.transitions_end - node.transitions_begin);
+  }
+  for (const auto &node : chart->m_transitions) {
+    mix(node.transition->getValidationMode());
+    mix(node.nexts_end - node.nexts_begin);
+    mix(node.validations_end - node.validations_begin);
+  }
+  for (auto index : chart->m_adjacency) {
+    mix(index);
+  }
+  chart->m_fingerprint = hash;
+  return chart;
+}
+
+uint64_t CompiledChart::fingerprint() const { return m_fingerprint; }
+
+std::size_t CompiledChart::memoryUsage() const {
+  // Hash nodes: next pointer + key/value (Hash codes of integral and pointer keys are not cached).
+  auto hash_bytes = [](const auto &map) {
+    using Value = typename std::decay_t<decltype(map)>::value_type;
+    return map.bucket_count() * sizeof(void *) + map.size() * (sizeof(void *) + sizeof(Value));
+  };
+  return sizeof(CompiledChart) + m_step_refs.capacity() * sizeof(m_step_refs[0]) +
+         m_transition_refs.capacity() * sizeof(m_transition_refs[0]) + m_steps.capacity() * sizeof(StepNode) +
+         m_transitions.capacity() * sizeof(TransitionNode) + m_adjacency.capacity() * sizeof(uint32_t) +
+         hash_bytes(m_step_indexes) + hash_bytes(m_transition_indexes);
+}
+
+uint32_t CompiledChart::stepsCount() const { return m_steps.size(); }
+
+uint32_t CompiledChart::transitionsCount() const { return m_transitions.size(); }
+
+const CompiledChart::StepNode &CompiledChart::step(uint32_t index) const { return m_steps[index]; }
+
+const CompiledChart::TransitionNode &CompiledChart::transition(uint32_t index) const { return m_transitions[index]; }
+
+uint32_t CompiledChart::stepIndex(unsigned int id) const {
+  auto it = m_step_indexes.find(id);
+  return (it != m_step_indexes.end()) ? it->second : NONE;
+}
+
+uint32_t CompiledChart::transitionIndex(const Transition *transition) const {
+  auto it = m_transition_indexes.find(transition);
+  return (it != m_transition_indexes.end()) ? it->second : NONE;
+}
+
+CompiledChart::Range CompiledChart::nextTransitions(uint32_t step_index) const {
+  const auto &node = m_steps[step_index];
+  return {m_adjacency.data() + node.transitions_begin, m_adjacency.data() + node.transitions_end};
+}
+
+CompiledChart::Range CompiledChart::nexts(uint32_t transition_index) const {
+  const auto &node = m_transitions[transition_index];
+  return {m_adjacency.data() + node.nexts_begin, m_adjacency.data() + node.nexts_end};
+}
+
+CompiledChart::Range CompiledChart::validations(uint32_t transition_index) const {
+  const auto &node = m_transitions[transition_index];
+  return {m_adjacency.data() + node.validations_begin, m_adjacency.data() + node.validations_end};
+}
+
+CompiledChart::Range CompiledChart::enclosed(uint32_t step_index) const {
+  const auto &node = m_steps[step_index];
+  return {m_adjacency.data() + node.enclosed_begin, m_adjacency.data() + node.enclosed_end};
+}
+
+CompiledChart::Range CompiledChart::activations(uint32_t step_index) const {
+  const auto &node = m_steps[step_index];
+  return {m_adjacency.data() + node.activations_begin, m_adjacency.data() + node.activations_end};
+}
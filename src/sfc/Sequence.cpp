@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <chrono>
 #include <iostream>
+#include <map>
 
 /**
  * @brief RAII hack to unlock steps waiting for previous ones.
@@ -16,34 +17,150 @@ private:
   Step &step;
 
   std::mutex notif_mutex;
-  std::function<void()> notifications;
+  /**
+   * @brief Next steps launched by the run, with their activations count at launch, notified at deactivation.
+   * Filled by the run in the live graph ('setNexts', no copy): nothing to allocate.
+   */
+  bool notify = false;
+  std::shared_ptr<std::condition_variable> nexts_cond_var;
+  const Sequence::LaunchList *nexts = nullptr;
+  /**
+   * @brief Deactivation is a handoff: the published situation must not show it until next steps are activated.
+   */
+  bool handoff = false;
+  /**
+   * @brief Activation time, for the tracer (Traced once, at the first reset).
+   */
+  std::chrono::nanoseconds traced_begin{-1};
+  int worker = -1;
+  /**
+   * @brief Timings block holding 'timing' (Kept alive until the deactivation is timed).
+   */
+  std::shared_ptr<StepTiming[]> times;
+  StepTiming *timing = nullptr;
+  /**
+   * @brief Macros slots block holding 'macro': the macro to deactivate with the step.
+   */
+  std::shared_ptr<std::atomic_uint[]> macros;
+  std::atomic_uint *macro = nullptr;
+  /**
+   * @brief Watchdog of the graph 'timing' is in, to disarm the dwell timer of the step ('step_index' in it).
+   */
+  std::shared_ptr<Watchdog> watchdog;
+  uint32_t step_index = CompiledChart::NONE;
 
 public:
-  StepActivation(Sequence &seq, Step &step) : seq(seq), step(step) {
+  StepActivation(Sequence &seq, Step &step, const std::shared_ptr<const Sequence::LiveGraph> &graph, uint32_t step_index)
+      : seq(seq), step(step) {
+    seq.m_metrics.add(Metrics::STEPS_ACTIVATED);
+    rebind(graph, step_index);
+    if (timing) {
+      timing->activated(seq.m_clock->now());
+    }
+    if (seq.m_tracer) {
+      traced_begin = Tracer::now();
+      worker = Executor::currentWorker();
+      seq.m_tracer->flowEnd(step.getStepId(), worker, seq.getStepBranch(step.getStepId()), traced_begin);
+    }
     step.setActivated(true);
     seq.fireStepChanged(step.getStepId(), step.isActivated());
   }
   ~StepActivation() { reset(); }
 
   void reset() {
+    std::lock_guard<std::mutex> _lock(notif_mutex);
+    if (seq.m_tracer && traced_begin.count() >= 0) {
+      seq.m_tracer->span(TraceEvent::STEP, step.getStepId(), worker, seq.getStepBranch(step.getStepId()), traced_begin,
+                         Tracer::now());
+      traced_begin = std::chrono::nanoseconds(-1);
+    }
+    if (timing) {
+      if (watchdog) {
+        watchdog->disarmDwell(step_index, std::chrono::nanoseconds(timing->activated_at.load()));
+      }
+      // Before the deactivation: the next activation of the step is timed after it.
+      timing->deactivated(seq.m_clock->now());
+      timing = nullptr;
+    }
+    if (handoff) {
+      seq.m_situation.beginWrite();
+    }
     step.setActivated(false);
     seq.fireStepChanged(step.getStepId(), step.isActivated());
+    if (notify) {
+      notify = false;
+      notifyNexts();
+    }
+    if (handoff) {
+      seq.m_situation.endWrite();
+      handoff = false;
+    }
+  }
+
+  /**
+   * @brief Time the activation in 'new_graph' (Swapped by 'apply'), its activation time carried over.
+   */
+  void rebind(const std::shared_ptr<const Sequence::LiveGraph> &new_graph, uint32_t new_index) {
     std::lock_guard<std::mutex> _lock(notif_mutex);
-    if (notifications) {
-      notifications();
+    if (times && !timing) {
+      // Already deactivated.
+      return;
     }
+    StepTiming *new_timing = (new_index != CompiledChart::NONE) ? &new_graph->times[new_index] : nullptr;
+    if (timing && new_timing && timing != new_timing) {
+      new_timing->activated_at.store(timing->activated_at.load());
+    }
+    timing = new_timing;
+    times = new_graph->times;
+    std::atomic_uint *new_macro = (new_index != CompiledChart::NONE) ? &new_graph->macro_deactivations[new_index] : nullptr;
+    if (macro && new_macro && macro != new_macro && macro->load() != CompiledChart::NONE) {
+      new_macro->store(macro->load());
+    }
+    macro = new_macro;
+    macros = new_graph->macro_deactivations;
+    watchdog = new_graph->watchdog;
+    step_index = new_index;
   }
 
-  void setNotifications(std::function<void()> notif) {
+  void setNexts(const std::shared_ptr<std::condition_variable> &cond_var, const Sequence::LaunchList &launch,
+                bool is_handoff) {
     std::lock_guard<std::mutex> _lock(notif_mutex);
-    this->notifications = notif;
+    nexts_cond_var = cond_var;
+    nexts = &launch;
+    notify = true;
+    handoff = is_handoff;
+  }
+
+private:
+  void notifyNexts() {
+    const unsigned int macro_id = macro ? macro->exchange(CompiledChart::NONE) : CompiledChart::NONE;
+    if (macro_id != CompiledChart::NONE) {
+      if (auto macro_step = seq.getStepById(macro_id)) {
+        macro_step->setActivated(false);
+        seq.fireStepChanged(macro_step->getStepId(), macro_step->isActivated());
+      }
+    }
+    for (std::size_t i = 0; i < nexts->steps.size(); i++) {
+      if (auto next = nexts->steps[i].lock()) {
+        Step &launched = next->isMacroStep() ? *std::static_pointer_cast<Macro>(next)->first() : *next;
+        // A next step can already be done (Activated then deactivated): its activations count tells.
+        do {
+          nexts_cond_var->notify_all();
+        } while (seq.m_running && !next->isActivated() && launched.activationsCount() == nexts->activations[i]);
+      }
+    }
   }
 };
 
 Sequence::Sequence(uint32_t thread_pool_size)
-    : m_thread_pool_size(thread_pool_size), m_thread_pool(nullptr), m_running(false), m_running_steps(0) {}
+    : m_thread_pool_size(thread_pool_size), m_thread_pool(nullptr), m_rt_violations(0),
+      m_clock(std::make_shared<SteadyClock>()), m_graph_version(0), m_running(false), m_running_steps(0) {}
 
 Sequence::Sequence(const Sequence &toCopy) : Sequence() {
+  m_action_policy = toCopy.m_action_policy;
+  m_action_workers_count = toCopy.m_action_workers_count;
+  m_rt_config = toCopy.m_rt_config;
+  m_affinity_config = toCopy.m_affinity_config;
 
   for (auto init_step : toCopy.m_initial_steps) {
     m_initial_steps[init_step.first] = init_step.second;
@@ -54,12 +171,513 @@ Sequence::Sequence(const Sequence &toCopy) : Sequence() {
   }
 }
 
-Sequence::~Sequence() { stop(); }
+Sequence::~Sequence() {
+  stop();
+  if (m_persister) {
+    m_persister->setSource(nullptr);
+  }
+  m_thread_pool.reset(nullptr);
+  detachObservers();
+}
 
 unsigned int Sequence::getTransitionPollingDelay() const { return m_transition_polling_delay; }
 
 void Sequence::setTransitionPollingDelay(unsigned int delay) { this->m_transition_polling_delay = delay; }
 
+std::shared_ptr<Clock> Sequence::getClock() const { return m_clock; }
+
+std::shared_ptr<Recorder> Sequence::getRecorder() const { return m_recorder; }
+
+void Sequence::setRecorder(std::shared_ptr<Recorder> recorder) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change the recorder of a running sequence ! That's forbidden !");
+  }
+  m_situation.setForward(recorder.get());
+  m_recorder = recorder;
+}
+
+std::shared_ptr<Profiler> Sequence::getProfiler() const { return m_profiler; }
+
+void Sequence::setProfiler(std::shared_ptr<Profiler> profiler) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change the profiler of a running sequence ! That's forbidden !");
+  }
+  m_profiler = profiler;
+}
+
+std::shared_ptr<InputRing> Sequence::getInputRing() const { return m_input_ring; }
+
+void Sequence::setInputRing(std::shared_ptr<InputRing> input_ring) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change the input ring of a running sequence ! That's forbidden !");
+  }
+  m_input_ring = input_ring;
+}
+
+void Sequence::drainInputs(const CompiledChart &chart) {
+  if (!m_input_ring || m_draining_inputs.test_and_set(std::memory_order_acquire)) {
+    return;
+  }
+  m_input_ring->drain([&chart](uint32_t transition_id, bool value) {
+    if (transition_id < chart.transitionsCount()) {
+      chart.transition(transition_id).transition->setReceptivityState(value);
+    }
+  });
+  m_draining_inputs.clear(std::memory_order_release);
+}
+
+void Sequence::samplePredicates(const LiveGraph &graph) {
+  if (graph.sampling.empty() || m_sampling_predicates.test_and_set(std::memory_order_acquire)) {
+    return;
+  }
+  const int64_t now = m_clock->now().count();
+  for (const auto &group : graph.sampling) {
+    if (now < group.next_due) {
+      continue;
+    }
+    group.next_due = now + group.period.count();
+    for (auto t : group.transitions) {
+      graph.chart->transition(t).transition->sample();
+    }
+    m_metrics.add(Metrics::PREDICATES_SAMPLED, group.transitions.size());
+  }
+  m_sampling_predicates.clear(std::memory_order_release);
+}
+
+std::shared_ptr<Tracer> Sequence::getTracer() const { return m_tracer; }
+
+void Sequence::setTracer(std::shared_ptr<Tracer> tracer) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change the tracer of a running sequence ! That's forbidden !");
+  }
+  m_tracer = tracer;
+  // Branches are computed with the chart preparation.
+  m_chart_prepared = false;
+}
+
+std::shared_ptr<Persister> Sequence::getPersister() const { return m_persister; }
+
+void Sequence::setPersister(std::shared_ptr<Persister> persister) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change the persister of a running sequence ! That's forbidden !");
+  }
+  if (m_persister) {
+    m_persister->setSource(nullptr);
+  }
+  m_persister = persister;
+  if (m_persister) {
+    m_persister->setSource([this]() {
+      Snapshot snapshot;
+      Situation situation = getSituation();
+      snapshot.fingerprint = situation.chart ? situation.chart->fingerprint() : 0;
+      snapshot.active_steps = situation.getActivatedSteps();
+      std::sort(snapshot.active_steps.begin(), snapshot.active_steps.end());
+      // Read from the engine: nothing to keep on the firing path.
+      if (auto graph = std::atomic_load(&m_live_graph)) {
+        for (uint32_t i = 0; i < graph->chart->stepsCount(); i++) {
+          const uint32_t arrivals = graph->joins[i] ? graph->joins[i]->arrivals() : 0;
+          if (arrivals) {
+            snapshot.join_counters.emplace_back(graph->chart->step(i).step->getStepId(), arrivals);
+          }
+        }
+      }
+      snapshot.time = m_persister->lastTime();
+      return snapshot;
+    });
+  }
+}
+
+std::shared_ptr<const CompiledChart> Sequence::getCompiledChart() const { return std::atomic_load(&m_chart); }
+
+const Metrics &Sequence::getMetrics() const { return m_metrics; }
+
+std::vector<MetricSample> Sequence::collectMetrics(const std::string &labels) const {
+  std::vector<MetricSample> samples = m_metrics.samples(labels);
+  auto gauge = [&samples, &labels](const char *name, const char *help, double value) {
+    samples.push_back({name, help, MetricSample::GAUGE, labels, value});
+  };
+  gauge("sfc_running", "1 if the sequence is running.", m_running ? 1 : 0);
+  gauge("sfc_active_steps", "Active steps, macros included.", getSituation().getActivatedSteps().size());
+  gauge("sfc_running_steps", "Steps runs in progress (Polling or handing off).", m_running_steps.load());
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_thread_pool) {
+    gauge("sfc_executor_workers", "Steps workers.", m_thread_pool->size());
+    gauge("sfc_executor_idle_workers", "Idle steps workers.", m_thread_pool->idleCount());
+    gauge("sfc_executor_queue_depth", "Steps runs waiting for a worker.", m_thread_pool->queuedCount());
+    samples.push_back({"sfc_executor_tasks_total", "Steps runs done.", MetricSample::COUNTER, labels,
+                       static_cast<double>(m_thread_pool->tasksCount())});
+  }
+  if (m_action_executor) {
+    gauge("sfc_action_executor_workers", "Actions workers.", m_action_executor->size());
+    gauge("sfc_action_executor_queue_depth", "Actions waiting for a worker.", m_action_executor->pendingCount());
+    samples.push_back({"sfc_action_failures_total", "Actions which threw.", MetricSample::COUNTER, labels,
+                       static_cast<double>(m_action_executor->failedCount())});
+  }
+  return samples;
+}
+
+uint64_t Sequence::getGraphVersion() const { return m_graph_version.load(); }
+
+void Sequence::detachObservers() {
+  if (m_chart) {
+    for (uint32_t i = 0; i < m_chart->transitionsCount(); i++) {
+      Transition &transition = *m_chart->transition(i).transition;
+      if (transition.getObserver() == &m_situation) {
+        transition.setObserver(nullptr);
+      }
+    }
+  }
+}
+
+void Sequence::installChart(std::shared_ptr<const CompiledChart> chart,
+                            const std::unordered_map<unsigned int, unsigned int> &mapping, bool keep_joins) {
+  if (m_chart) {
+    for (uint32_t i = 0; i < m_chart->transitionsCount(); i++) {
+      Transition &transition = *m_chart->transition(i).transition;
+      if (chart->transitionIndex(&transition) == CompiledChart::NONE && transition.getObserver() == &m_situation) {
+        transition.setObserver(nullptr);
+      }
+    }
+  }
+  std::atomic_store(&m_chart, chart);
+  if (m_recorder) {
+    m_recorder->setClock(m_clock);
+  }
+  // Changes observed with the new indexes can still go to the previous state until it is replaced:
+  // readers keep the last published snapshot until then.
+  m_situation.beginWrite();
+  for (uint32_t i = 0; i < chart->transitionsCount(); i++) {
+    chart->transition(i).transition->setObserver(&m_situation, i);
+  }
+  // Receptivities read once observed: no change lost in between.
+  m_situation.reset(chart);
+  m_situation.endWrite();
+  auto graph = std::make_shared<LiveGraph>();
+  graph->version = m_graph_version.load() + 1;
+  graph->chart = chart;
+  graph->mapping = mapping;
+  graph->joins.resize(chart->stepsCount());
+  auto previous = keep_joins ? std::atomic_load(&m_live_graph) : nullptr;
+  for (uint32_t t = 0; t < chart->transitionsCount(); t++) {
+    if (chart->transition(t).required_count < 2) {
+      continue;
+    }
+    for (auto next : chart->nexts(t)) {
+      const auto &node = chart->step(next);
+      uint32_t target = (node.macro_first != CompiledChart::NONE) ? node.macro_first : next;
+      if (graph->joins[target]) {
+        continue;
+      }
+      uint32_t previous_index =
+          previous ? previous->chart->stepIndex(chart->step(target).step->getStepId()) : CompiledChart::NONE;
+      const uint32_t required = chart->transition(t).required_count;
+      if (previous_index != CompiledChart::NONE && previous->joins[previous_index] &&
+          previous->joins[previous_index]->required == required) {
+        graph->joins[target] = previous->joins[previous_index];
+      } else {
+        graph->joins[target] = std::make_shared<JoinCounter>(required);
+      }
+    }
+  }
+  graph->scopes.resize(chart->stepsCount());
+  for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+    if (chart->step(i).step->isEnclosingStep()) {
+      uint32_t previous_index = previous ? previous->chart->stepIndex(chart->step(i).step->getStepId()) : CompiledChart::NONE;
+      graph->scopes[i] = (previous_index != CompiledChart::NONE && previous->scopes[previous_index])
+                             ? previous->scopes[previous_index]
+                             : std::make_shared<Scope>();
+    }
+  }
+  if (m_profiler) {
+    graph->profile = m_profiler->counters(chart);
+  }
+  std::map<std::chrono::nanoseconds, std::vector<uint32_t>> periods;
+  for (uint32_t t = 0; t < chart->transitionsCount(); t++) {
+    const Transition &transition = *chart->transition(t).transition;
+    if (transition.hasPredicate()) {
+      periods[transition.getSamplingPeriod()].push_back(t);
+    }
+  }
+  for (auto &period : periods) {
+    graph->sampling.push_back({period.first, std::move(period.second)});
+  }
+  graph->times.reset(new StepTiming[chart->stepsCount()]);
+  graph->handoffs.reset(new std::condition_variable[chart->stepsCount()]);
+  graph->launches.reset(new LaunchList[2 * chart->stepsCount()]);
+  graph->macro_deactivations.reset(new std::atomic_uint[chart->stepsCount()]);
+  for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+    std::size_t widest = 1;
+    for (auto t : chart->nextTransitions(i)) {
+      widest = std::max(widest, chart->transition(t).transition->nexts().size());
+    }
+    for (uint32_t parity = 0; parity < 2; parity++) {
+      graph->launches[2 * i + parity].steps.reserve(widest);
+      graph->launches[2 * i + parity].activations.reserve(widest);
+    }
+    graph->macro_deactivations[i] = CompiledChart::NONE;
+  }
+  for (uint32_t i = 0; previous && i < chart->stepsCount(); i++) {
+    uint32_t previous_index = previous->chart->stepIndex(chart->step(i).step->getStepId());
+    if (previous_index != CompiledChart::NONE) {
+      graph->times[i].copyFrom(previous->times[previous_index]);
+      graph->macro_deactivations[i] = previous->macro_deactivations[previous_index].load();
+    }
+  }
+  // The pool policy activation rate is the loops limit, unless the watchdog config sets one.
+  WatchdogConfig watchdog_config = m_watchdog_config;
+  if (m_pool_policy.max_activations > 0 && watchdog_config.max_loop_activations == 0) {
+    watchdog_config.max_loop_activations = m_pool_policy.max_activations;
+    watchdog_config.rate_window = m_pool_policy.rate_window;
+  }
+  if (watchdog_config.enabled()) {
+    graph->watchdog = std::make_shared<Watchdog>(*chart, watchdog_config);
+    // Kept active steps: their dwell is still watched.
+    for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+      const int64_t since = graph->times[i].activated_at.load();
+      if (since >= 0) {
+        graph->watchdog->armDwell(i, std::chrono::nanoseconds(since));
+      }
+    }
+  }
+  std::atomic_store(&m_live_graph, std::shared_ptr<const LiveGraph>(graph));
+  m_graph_version.store(graph->version, std::memory_order_release);
+}
+
+const StepTiming *Sequence::stepTiming(const LiveGraph *graph, unsigned int id) const {
+  if (!graph) {
+    return nullptr;
+  }
+  uint32_t index = graph->chart->stepIndex(id);
+  if (index == CompiledChart::NONE) {
+    throw std::invalid_argument("Trying to get the timing of a step which is not part of the sequence !");
+  }
+  return &graph->times[index];
+}
+
+std::chrono::nanoseconds Sequence::getStepElapsed(unsigned int id) const {
+  auto graph = std::atomic_load(&m_live_graph);
+  const StepTiming *timing = stepTiming(graph.get(), id);
+  const int64_t since = timing ? timing->activated_at.load(std::memory_order_acquire) : -1;
+  return (since < 0) ? std::chrono::nanoseconds(0)
+                     : std::max(m_clock->now() - std::chrono::nanoseconds(since), std::chrono::nanoseconds(0));
+}
+
+DwellHistogram Sequence::getStepDwell(unsigned int id) const {
+  auto graph = std::atomic_load(&m_live_graph);
+  const StepTiming *timing = stepTiming(graph.get(), id);
+  return timing ? timing->histogram() : DwellHistogram();
+}
+
+Situation Sequence::getSituation() const { return m_situation.read(); }
+
+bool Sequence::tryGetSituation(Situation &situation) const { return m_situation.tryRead(situation); }
+
+bool Sequence::awaitSituation(const std::function<bool(const Situation &)> &predicate, std::chrono::nanoseconds timeout) const {
+  const auto start = std::chrono::steady_clock::now();
+  Situation situation;
+  while (true) {
+    // Generation first: a change happening after the check wakes us up.
+    uint32_t generation = m_situation.generation();
+    if (m_situation.tryRead(situation) && predicate(situation)) {
+      return true;
+    }
+    std::chrono::nanoseconds remaining = timeout;
+    if (timeout != std::chrono::nanoseconds::max()) {
+      remaining = timeout - (std::chrono::steady_clock::now() - start);
+      if (remaining <= std::chrono::nanoseconds(0)) {
+        return false;
+      }
+    }
+    m_situation.waitChange(generation, remaining);
+  }
+}
+
+namespace {
+void checkAwaitedStep(const Situation &situation, unsigned int id) {
+  if (situation.chart && situation.chart->stepIndex(id) == CompiledChart::NONE) {
+    throw std::invalid_argument("Trying to await an invalid step (Id not found) !");
+  }
+}
+} // namespace
+
+bool Sequence::awaitStep(unsigned int id, bool active, std::chrono::nanoseconds timeout) const {
+  return awaitSituation(
+      [id, active](const Situation &situation) {
+        checkAwaitedStep(situation, id);
+        return situation.chart && situation.isActivated(id) == active;
+      },
+      timeout);
+}
+
+int Sequence::awaitAny(const std::vector<unsigned int> &ids, bool active, std::chrono::nanoseconds timeout) const {
+  int found = -1;
+  awaitSituation(
+      [&ids, active, &found](const Situation &situation) {
+        for (auto id : ids) {
+          checkAwaitedStep(situation, id);
+          if (situation.chart && situation.isActivated(id) == active) {
+            found = id;
+            return true;
+          }
+        }
+        return false;
+      },
+      timeout);
+  return found;
+}
+
+bool Sequence::awaitStable(std::chrono::nanoseconds timeout) const {
+  return awaitSituation([](const Situation &situation) { return !situation.hasCrossableTransition(); }, timeout);
+}
+
+Sequence::ActionPolicy Sequence::getActionPolicy() const { return m_action_policy; }
+
+void Sequence::setActionPolicy(ActionPolicy policy, uint32_t workers_count) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change actions policy while sequence is running ! That's forbidden !");
+  }
+  m_action_policy = policy;
+  m_action_workers_count = workers_count;
+}
+
+std::shared_ptr<ActionExecutor> Sequence::getActionExecutor() const { return m_action_executor; }
+
+void Sequence::setActionExecutor(std::shared_ptr<ActionExecutor> executor) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change actions executor while sequence is running ! That's forbidden !");
+  }
+  m_action_executor = executor;
+  m_thread_pool.reset(nullptr);
+}
+
+const PoolPolicy &Sequence::getPoolPolicy() const { return m_pool_policy; }
+
+void Sequence::setPoolPolicy(const PoolPolicy &policy) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change pool policy while sequence is running ! That's forbidden !");
+  }
+  m_pool_policy = policy;
+  // Parked workers were sized for the previous cap.
+  m_thread_pool.reset(nullptr);
+}
+
+uint32_t Sequence::maxWorkers() const {
+  if (m_pool_policy.mode != PoolPolicy::ELASTIC) {
+    return m_thread_pool_size;
+  }
+  return m_pool_policy.max_workers ? std::max(m_pool_policy.max_workers, m_thread_pool_size) : 4 * m_thread_pool_size;
+}
+
+bool Sequence::reserveWorker() {
+  switch (m_pool_policy.mode) {
+  case PoolPolicy::ELASTIC:
+    if (m_thread_pool->idleCount() > m_thread_pool->queuedCount() || m_thread_pool->grow()) {
+      return true;
+    }
+    // At the cap: like a fixed pool.
+    return m_thread_pool->idleCount() > 0;
+  case PoolPolicy::BACKPRESSURE:
+    return m_thread_pool->awaitWorker(m_pool_policy.backpressure_timeout, m_stop);
+  default:
+    return m_thread_pool->idleCount() > 0 && m_running_steps <= m_thread_pool_size;
+  }
+}
+
+const WatchdogConfig &Sequence::getWatchdogConfig() const { return m_watchdog_config; }
+
+void Sequence::setWatchdogConfig(const WatchdogConfig &config) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change watchdog config while sequence is running ! That's forbidden !");
+  }
+  m_watchdog_config = config;
+}
+
+void Sequence::pollWatchdog(const LiveGraph &graph) {
+  bool stopped = false;
+  graph.watchdog->poll(
+      m_clock->now(),
+      [&graph](uint32_t index, int64_t activated_at) {
+        return graph.times[index].activated_at.load(std::memory_order_acquire) == activated_at;
+      },
+      [this, &graph, &stopped](uint32_t index, std::chrono::nanoseconds dwell) {
+        WatchdogEvent event{WatchdogEvent::DWELL_TIMEOUT, graph.chart->step(index).step->getStepId()};
+        event.dwell = dwell;
+        stopped = reportViolation(event) || stopped;
+      });
+  if (stopped) {
+    fireSequenceChanged(m_running);
+  }
+}
+
+bool Sequence::reportViolation(const WatchdogEvent &event) {
+  m_metrics.add(Metrics::WATCHDOG_VIOLATIONS);
+  {
+    std::lock_guard<std::mutex> lock(watchdog_cb_mutex);
+    for (auto &cb : m_watchdog_callbacks) {
+      cb(event);
+    }
+  }
+  if (!m_watchdog_config.stop_on_violation || !m_running.exchange(false)) {
+    return false;
+  }
+  m_stop.requestStop();
+  m_stop_code = (event.kind == WatchdogEvent::LOOP_RATE) ? CRAZY_LOOPING_STOP : DWELL_TIMEOUT_STOP;
+  return true;
+}
+
+const RealTimeConfig &Sequence::getRealTimeConfig() const { return m_rt_config; }
+
+void Sequence::setRealTimeConfig(const RealTimeConfig &config) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change real-time config while sequence is running ! That's forbidden !");
+  }
+  if (config.prefault_stack_size > 0 &&
+      config.prefault_stack_size + RealTimeConfig::STACK_MARGIN > Executor::workerStackSize()) {
+    throw std::invalid_argument("Trying to prefault more than the workers stack size ! That's forbidden !");
+  }
+  m_rt_config = config;
+  // Parked workers got the previous settings.
+  m_thread_pool.reset(nullptr);
+}
+
+uint64_t Sequence::getRealTimeViolations() const { return m_rt_violations; }
+
+uint64_t Sequence::getWarmStartsCount() const { return m_warm_starts; }
+
+const AffinityConfig &Sequence::getAffinityConfig() const { return m_affinity_config; }
+
+void Sequence::setAffinityConfig(const AffinityConfig &config) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_running) {
+    throw std::runtime_error("Trying to change affinity config while sequence is running ! That's forbidden !");
+  }
+  m_affinity_config = config;
+  m_thread_pool.reset(nullptr);
+}
+
+std::vector<WorkerPlacement> Sequence::getWorkersPlacement() {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (m_thread_pool) {
+    return m_thread_pool->placement();
+  }
+  return {};
+}
+
+int Sequence::getStepBranch(unsigned int id) const {
+  auto it = m_step_branches.find(id);
+  return (it != m_step_branches.end()) ? static_cast<int>(it->second) : -1;
+}
+
 using StepsMap = std::unordered_map<unsigned int, std::shared_ptr<Step>>;
 
 void Sequence::addStep(std::shared_ptr<Step> step) {
@@ -74,11 +692,45 @@ void Sequence::addStep(std::shared_ptr<Step> step) {
   if (step->isInitialStep()) {
     m_initial_steps[step->getStepId()] = step;
   } else if (step->isMacroStep()) {
-    /// @todo Copy the macro and all its steps ! Or not ?
-    /// How do we do when a macro is used by several sequences ?
+    // The same macro can't be added twice: use 'Macro::instantiate' to get instances with their own steps.
     auto macro = std::dynamic_pointer_cast<Macro>(step);
+    for (const auto &p : macro->steps()) {
+      if (m_initial_steps.count(p.first) || m_steps.count(p.first)) {
+        throw std::invalid_argument("Macro's step id already used in this sequence ! Use 'Macro::instantiate'.");
+      }
+    }
     m_steps.insert(macro->steps().begin(), macro->steps().end());
     m_steps[step->getStepId()] = step;
+  } else if (step->isEnclosingStep()) {
+    // Child charts (And their own children) are flattened into the sequence.
+    std::vector<std::shared_ptr<Step>> enclosed;
+    std::vector<std::shared_ptr<Step>> to_visit = {step};
+    while (!to_visit.empty()) {
+      auto current = to_visit.back();
+      to_visit.pop_back();
+      std::vector<std::shared_ptr<Step>> children;
+      if (current->isEnclosingStep()) {
+        for (const auto &p : std::static_pointer_cast<Enclosing>(current)->steps()) {
+          children.push_back(p.second);
+        }
+      } else if (current->isMacroStep()) {
+        for (const auto &p : std::static_pointer_cast<Macro>(current)->steps()) {
+          children.push_back(p.second);
+        }
+      }
+      for (const auto &child : children) {
+        if (m_initial_steps.count(child->getStepId()) || m_steps.count(child->getStepId()) ||
+            child->getStepId() == step->getStepId()) {
+          throw std::invalid_argument("Enclosed step id already used in this sequence !");
+        }
+        enclosed.push_back(child);
+        to_visit.push_back(child);
+      }
+    }
+    for (const auto &child : enclosed) {
+      m_steps[child->getStepId()] = child;
+    }
+    m_steps[step->getStepId()] = step;
   } else {
     m_steps[step->getStepId()] = step;
   }
@@ -102,6 +754,29 @@ bool checkMacro(Macro &current_step) {
   return ret;
 }
 
+bool checkEnclosing(Enclosing &current_step) {
+  /// Child charts are started by activation steps. Enclosed steps without transition are left by being killed.
+  bool ret = !current_step.activationSteps().empty();
+  if (!ret) {
+    std::cerr << "Enclosing step #" << current_step.getStepId() << " is missing activation steps !" << std::endl;
+  }
+  for (auto &step : current_step.steps()) {
+    for (const auto &t : step.second->getNextTransitions()) {
+      for (const auto &next : t->nexts()) {
+        auto next_step = next.lock();
+        if (!next_step || !current_step.containsStep(next_step->getStepId())) {
+          std::cerr << "Transition leads out of enclosing step #" << current_step.getStepId() << " !" << std::endl;
+          ret = false;
+        }
+      }
+    }
+    if (step.second->isEnclosingStep()) {
+      ret &= checkEnclosing(static_cast<Enclosing &>(*step.second));
+    }
+  }
+  return ret;
+}
+
 std::vector<std::shared_ptr<Transition>>
 getTransitionsFromStep(std::weak_ptr<Step> base_step, std::vector<std::weak_ptr<Step>> &traversed_steps,
                        const std::weak_ptr<Step> &s, std::vector<std::shared_ptr<Transition>> &transitions, uint32_t index = 0) {
@@ -190,6 +865,8 @@ bool loopCheck(Step &current_step, std::vector<unsigned int> &traversed_steps, b
 
   if (current_step.isMacroStep()) {
     ret &= checkMacro(static_cast<Macro &>(current_step));
+  } else if (current_step.isEnclosingStep()) {
+    ret &= checkEnclosing(static_cast<Enclosing &>(current_step));
   }
 
   if (check_traversed &&
@@ -226,6 +903,199 @@ bool loopCheck(Step &current_step, std::vector<unsigned int> &traversed_steps, b
   return ret;
 }
 
+void Sequence::apply(const ChangeSet &changes) {
+  std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  if (changes.empty()) {
+    return;
+  }
+  // Everything is staged on copies: the running chart is untouched until the swap.
+  StepsMap initial_steps;
+  StepsMap steps;
+  {
+    std::lock_guard<std::mutex> _steps_lock(steps_mutex);
+    initial_steps = m_initial_steps;
+    steps = m_steps;
+  }
+  auto find_step = [&initial_steps, &steps](unsigned int id) -> std::shared_ptr<Step> {
+    auto it = steps.find(id);
+    if (it != steps.end()) {
+      return it->second;
+    }
+    it = initial_steps.find(id);
+    return (it != initial_steps.end()) ? it->second : nullptr;
+  };
+
+  std::vector<std::shared_ptr<Step>> changed_steps;
+  std::vector<std::shared_ptr<Step>> removed_steps;
+  for (const auto &step : changes.addedSteps()) {
+    if (find_step(step->getStepId())) {
+      throw std::invalid_argument("Step id already used in this sequence !");
+    }
+    if (step->isInitialStep()) {
+      initial_steps[step->getStepId()] = step;
+    } else {
+      if (step->isMacroStep()) {
+        for (const auto &p : std::static_pointer_cast<Macro>(step)->steps()) {
+          if (find_step(p.first)) {
+            throw std::invalid_argument("Step id already used in this sequence !");
+          }
+          steps[p.first] = p.second;
+        }
+      }
+      steps[step->getStepId()] = step;
+    }
+    changed_steps.push_back(step);
+  }
+  for (auto id : changes.removedSteps()) {
+    auto step = find_step(id);
+    if (!step) {
+      throw std::invalid_argument("Trying to remove a step which is not in this sequence !");
+    }
+    initial_steps.erase(id);
+    steps.erase(id);
+    removed_steps.push_back(step);
+    if (step->isMacroStep()) {
+      for (const auto &p : std::static_pointer_cast<Macro>(step)->steps()) {
+        steps.erase(p.first);
+        removed_steps.push_back(p.second);
+      }
+    }
+  }
+
+  CompiledChart::TransitionsOverrides overrides;
+  auto transitions_of = [&overrides](const std::shared_ptr<Step> &step) -> std::vector<std::shared_ptr<Transition>> & {
+    auto it = overrides.find(step.get());
+    if (it == overrides.end()) {
+      it = overrides.emplace(step.get(), step->getNextTransitions()).first;
+    }
+    return it->second;
+  };
+  for (const auto &p : changes.addedTransitions()) {
+    auto step = find_step(p.first);
+    if (!step) {
+      throw std::invalid_argument("Trying to add a transition to a step which is not in this sequence !");
+    }
+    transitions_of(step).push_back(p.second);
+    if (step->isMacroStep()) {
+      transitions_of(std::static_pointer_cast<Macro>(step)->last()).push_back(p.second);
+    }
+    changed_steps.push_back(step);
+  }
+  for (const auto &p : changes.removedTransitions()) {
+    auto step = find_step(p.first);
+    auto erase = [&p](std::vector<std::shared_ptr<Transition>> &transitions) {
+      auto it = std::find(transitions.begin(), transitions.end(), p.second);
+      if (it == transitions.end()) {
+        return false;
+      }
+      transitions.erase(it);
+      return true;
+    };
+    if (!step || !erase(transitions_of(step))) {
+      throw std::invalid_argument("Trying to remove a transition which is not a next one of the step !");
+    }
+    if (step->isMacroStep()) {
+      erase(transitions_of(std::static_pointer_cast<Macro>(step)->last()));
+    }
+    changed_steps.push_back(step);
+  }
+
+  // Throws if a transition still refers to a removed step.
+  auto chart = CompiledChart::compile(initial_steps, steps, &overrides);
+  validateChanges(*chart, changed_steps, removed_steps, changes.activeStepsMapping());
+
+  {
+    std::lock_guard<std::mutex> _steps_lock(steps_mutex);
+    m_initial_steps.swap(initial_steps);
+    m_steps.swap(steps);
+    for (const auto &p : changes.addedTransitions()) {
+      find_step(p.first)->addTransition(p.second);
+    }
+    for (const auto &p : changes.removedTransitions()) {
+      find_step(p.first)->removeTransition(p.second);
+    }
+    if (!m_running) {
+      return;
+    }
+    // Only the changed region was checked: the validated fingerprint is not carried over, next start runs all the
+    // checks.
+    installChart(chart, changes.activeStepsMapping(), true);
+  }
+  // Steps lock released: a handoff open meanwhile can close, publishing the new chart.
+  m_situation.awaitChart(chart);
+}
+
+void Sequence::validateChanges(const CompiledChart &chart, const std::vector<std::shared_ptr<Step>> &changed_steps,
+                               const std::vector<std::shared_ptr<Step>> &removed_steps,
+                               const std::unordered_map<unsigned int, unsigned int> &mapping) const {
+  bool ret = true;
+  for (const auto &step : changed_steps) {
+    uint32_t index = chart.stepIndex(step->getStepId());
+    if (index == CompiledChart::NONE) {
+      // Removed by the same change set.
+      continue;
+    }
+    if (step->isMacroStep() && !checkMacro(static_cast<Macro &>(*step))) {
+      std::cerr << "Macro #" << step->getStepId() << " is missing steps or transitions !" << std::endl;
+      ret = false;
+    }
+    if (chart.nextTransitions(index).size() == 0) {
+      std::cerr << "Step #" << step->getStepId() << " has no next transition !" << std::endl;
+      ret = false;
+    }
+    for (auto t : chart.nextTransitions(index)) {
+      if (chart.nexts(t).size() == 0 || chart.validations(t).size() == 0) {
+        std::cerr << "Transition is missing 'nexts' or 'validations' ! " << std::endl;
+        ret = false;
+      }
+    }
+    // Breadth-first walk: an init-step must still be reachable.
+    std::vector<uint32_t> to_visit = {index};
+    std::vector<bool> visited(chart.stepsCount(), false);
+    visited[index] = true;
+    bool reaches_init = false;
+    for (std::size_t i = 0; i < to_visit.size() && !reaches_init; i++) {
+      const auto &node = chart.step(to_visit[i]);
+      if (i > 0 && node.step->isInitialStep()) {
+        reaches_init = true;
+        break;
+      }
+      std::vector<uint32_t> nexts;
+      if (node.macro_first != CompiledChart::NONE) {
+        nexts.push_back(node.macro_first);
+      }
+      for (auto t : chart.nextTransitions(to_visit[i])) {
+        nexts.insert(nexts.end(), chart.nexts(t).begin(), chart.nexts(t).end());
+      }
+      for (auto next : nexts) {
+        if (!visited[next]) {
+          visited[next] = true;
+          to_visit.push_back(next);
+        }
+      }
+    }
+    if (!reaches_init) {
+      std::cerr << "Step #" << step->getStepId() << " does not loop through an init-step !" << std::endl;
+      ret = false;
+    }
+  }
+  for (const auto &step : removed_steps) {
+    if (!step->isActivated()) {
+      continue;
+    }
+    auto it = mapping.find(step->getStepId());
+    uint32_t index = (it != mapping.end()) ? chart.stepIndex(it->second) : CompiledChart::NONE;
+    if (index == CompiledChart::NONE || chart.step(index).step->isMacroStep()) {
+      std::cerr << "Active step #" << step->getStepId() << " is removed without being mapped to a remaining step !"
+                << std::endl;
+      ret = false;
+    }
+  }
+  if (!ret) {
+    throw std::runtime_error("Trying to apply changes making the sequence invalid !");
+  }
+}
+
 bool Sequence::isValid() const {
   /// @todo Consistency checks !
   std::lock_guard<std::mutex> _lock(steps_mutex);
@@ -273,6 +1143,16 @@ void Sequence::clearStepChangedCallback() {
   m_step_changed_callbacks.clear();
 }
 
+void Sequence::addWatchdogCallback(std::function<void(const WatchdogEvent &)> cb) {
+  std::lock_guard<std::mutex> lock(watchdog_cb_mutex);
+  m_watchdog_callbacks.push_back(cb);
+}
+
+void Sequence::clearWatchdogCallback() {
+  std::lock_guard<std::mutex> lock(watchdog_cb_mutex);
+  m_watchdog_callbacks.clear();
+}
+
 bool Sequence::containsStep(unsigned int id) {
   std::lock_guard<std::mutex> _lock(steps_mutex);
   return m_initial_steps.count(id) || m_steps.count(id);
@@ -320,114 +1200,288 @@ const std::vector<std::shared_ptr<Step>> Sequence::getActivatedSteps() const {
 
 void Sequence::run() { run(m_initial_steps[0]->getStepId()); }
 
-void Sequence::run(unsigned int step_id, std::shared_ptr<Step> previous_step, std::shared_ptr<std::condition_variable> cond_var) {
+void Sequence::run(unsigned int step_id, std::shared_ptr<Step> previous_step, std::shared_ptr<std::condition_variable> cond_var,
+                   std::shared_ptr<const LiveGraph> graph, uint32_t epoch) {
   m_running_steps++;
   if (m_running) {
     steps_mutex.lock();
     auto it = m_steps.find(step_id);
     if (it == m_steps.end() && ((it = m_initial_steps.find(step_id)) == m_initial_steps.end())) {
+      // Removed by 'apply' before being launched: its mapped step is run instead.
+      auto live = std::atomic_load(&m_live_graph);
+      auto mapped = live ? live->mapping.find(step_id) : decltype(live->mapping.end())();
+      steps_mutex.unlock();
+      if (live && mapped != live->mapping.end()) {
+        m_running_steps--;
+        run(mapped->second, previous_step, cond_var, live, epoch);
+        return;
+      }
       throw std::invalid_argument("Trying to run an invalid step (Id not found) !");
     }
+    // The maps can change ('apply'): keep the step itself, not the iterator.
+    const std::shared_ptr<Step> current_step = it->second;
+    if (!graph || graph->chart->stepIndex(step_id) == CompiledChart::NONE) {
+      // Maps and live graph are swapped together.
+      graph = std::atomic_load(&m_live_graph);
+    }
     steps_mutex.unlock();
+    // Enclosed steps stop as soon as the children of their enclosing step are killed.
+    uint32_t enclosing_index = graph->chart->step(graph->chart->stepIndex(step_id)).enclosing;
+    auto killed = [&graph, &enclosing_index, epoch]() {
+      return enclosing_index != CompiledChart::NONE &&
+             graph->scopes[enclosing_index]->epoch.load(std::memory_order_acquire) != epoch;
+    };
+    if (killed()) {
+      m_running_steps--;
+      return;
+    }
 
-    Step &step_to_run = *it->second;
+    Step &step_to_run = *current_step;
+    const bool traced = static_cast<bool>(m_tracer);
+    const int worker = traced ? Executor::currentWorker() : -1;
+    const int branch = traced ? getStepBranch(step_id) : -1;
+    auto traced_since = traced ? Tracer::now() : std::chrono::nanoseconds(0);
     if (!step_to_run.isMacroStep()) {
-      /// Launch steps actions even if not yet activated ;)
-      for (const auto &a : step_to_run.getActions()) {
-        (*a)();
+      if (m_action_policy == INLINE_ACTIONS) {
+        /// Launch steps actions even if not yet activated ;)
+        for (const auto &a : step_to_run.getActions()) {
+          (*a)();
+        }
+      } else if (!step_to_run.getActions().empty()) {
+        auto batch = m_action_executor->submit(step_to_run.getActions());
+        if (m_action_policy == WAIT_ALL_ACTIONS) {
+          batch->wait(StepAction::LOW, m_stop);
+        } else if (m_action_policy == WAIT_CRITICAL_ACTIONS) {
+          batch->wait(StepAction::CRITICAL, m_stop);
+        }
+      }
+      if (traced && !step_to_run.getActions().empty()) {
+        auto now = Tracer::now();
+        m_tracer->span(TraceEvent::ACTIONS, step_id, worker, branch, traced_since, now);
+        traced_since = now;
       }
     }
 
     /// To properly finish the last triggered steps.
-    {
+    if (previous_step && m_running && previous_step->isActivated()) {
       std::mutex mumu;
+      // Woken by the previous step deactivation, or at once by the stop request.
+      StopToken::Callback on_stop(m_stop, [&mumu, &cond_var]() {
+        std::lock_guard<std::mutex> _lock(mumu);
+        cond_var->notify_all();
+      });
       std::unique_lock<std::mutex> lock(mumu);
-      while (previous_step && m_running && previous_step->isActivated()) {
+      while (m_running && previous_step->isActivated()) {
         // Don't race with previous step !
         using namespace std::chrono_literals;
         cond_var->wait_for(lock, 100ms, [=, &previous_step]() { return !previous_step->isActivated() || !m_running; });
       }
     }
-    StepActivation activation_guard(*this, step_to_run);
+    if (traced && previous_step) {
+      m_tracer->span(TraceEvent::WAIT_PREVIOUS, step_id, worker, branch, traced_since, Tracer::now());
+    }
+    if (killed()) {
+      m_running_steps--;
+      return;
+    }
+    StepActivation activation_guard(*this, step_to_run, graph, graph->chart->stepIndex(step_id));
 #ifdef DEBUG_MODE
     std::cout << "Running step #" << step_id << std::endl;
 #endif
     bool done = false;
     std::atomic<uint32_t> waiting_steps(0);
-    std::vector<std::weak_ptr<Step>> m_about_to_run_steps;
+    // Launched steps, with the activations count of each (Macros: their first step) read before launching them.
+    // Reserved in the live graph: see 'LiveGraph::launches'.
+    LaunchList *launch = nullptr;
+    // True if every next step is launched (or already active): the deactivation is then published with their activation.
+    bool handoff = false;
+    // Next transitions are read through the live graph, reloaded only when 'apply' swapped it (Quiescent point).
+    uint32_t step_index = graph->chart->stepIndex(step_id);
+    auto launch_list = [&graph, &step_index, &step_to_run]() {
+      return &graph->launches[2 * step_index + (step_to_run.activationsCount() & 1)];
+    };
     typedef std::shared_ptr<std::condition_variable> SP_CondVar;
-    SP_CondVar cond_var = std::make_shared<std::condition_variable>();
+    // The step one, owned by the graph (Aliased: no allocation).
+    SP_CondVar cond_var(graph, &graph->handoffs[step_index]);
+    if (graph->profile) {
+      graph->profile->stepActivated(step_index);
+    }
+    if (graph->watchdog && m_running) {
+      // Counted at the activation time of the step (Also its dwell timer cookie).
+      const auto activated_at = std::chrono::nanoseconds(graph->times[step_index].activated_at.load());
+      const uint32_t activations = graph->watchdog->activated(step_index, activated_at);
+      if (activations > 0) {
+        WatchdogEvent event{WatchdogEvent::LOOP_RATE, step_id};
+        event.activations = activations;
+        if (reportViolation(event)) {
+          activation_guard.reset();
+          fireSequenceChanged(m_running);
+          throw std::runtime_error("Step #" + std::to_string(step_id) +
+                                   " loop activated too often. Crazy-Looping detection -> Sequence stopped !");
+        }
+      }
+    }
+    if (step_to_run.isEnclosingStep() && !graph->scopes[step_index]->resumed.exchange(false)) {
+      // Child charts are started with their enclosing step.
+      uint32_t scope_epoch = graph->scopes[step_index]->epoch.load(std::memory_order_acquire);
+      for (auto child : graph->chart->activations(step_index)) {
+        unsigned int child_id = graph->chart->step(child).step->getStepId();
+        pushStep([=](int) { run(child_id, nullptr, nullptr, graph, scope_epoch); });
+      }
+    }
     /// Run receptivity(ies) detection(s).
     while (m_running && !done) {
-      for (const auto &t : step_to_run.getNextTransitions()) {
+      if (m_graph_version.load(std::memory_order_acquire) != graph->version) {
+        graph = std::atomic_load(&m_live_graph);
+        step_index = graph->chart->stepIndex(step_id);
+        if (step_index == CompiledChart::NONE) {
+          // Removed while active: hand over to its mapped step, if any.
+          handoff = handOver(step_id, current_step, cond_var, graph, launch, epoch);
+          break;
+        }
+        enclosing_index = graph->chart->step(step_index).enclosing;
+        activation_guard.rebind(graph, step_index);
+      }
+      if (killed()) {
+        break;
+      }
+      drainInputs(*graph->chart);
+      samplePredicates(*graph);
+      if (graph->watchdog) {
+        pollWatchdog(*graph);
+      }
+      uint32_t evaluated = 0;
+      for (auto transition_index : graph->chart->nextTransitions(step_index)) {
+        Transition *t = graph->chart->transition(transition_index).transition;
+        if (graph->profile) {
+          graph->profile->transitionEvaluated(step_index, evaluated);
+        }
+        evaluated++;
         // Wait to be trigger and check the transition state and the bool reference.
         if (m_running && t->getReceptivityState()) {
           using namespace std::chrono_literals;
           done = true;
+          m_metrics.add(Metrics::TRANSITIONS_FIRED);
+          if (graph->profile) {
+            graph->profile->transitionFired(step_index, evaluated - 1);
+          }
           // If several next steps. We need to find the next common transition.
           // The step(s) after this transition must only be launch once !
           // So we could count how many times 'run' is called with a given id ?
           // Also, if a branch has finished, we should not trigger already running steps !
 
-          m_about_to_run_steps = t->nexts();
-          if (m_about_to_run_steps.size() > m_thread_pool_size) {
+          // Reserved for the widest divergence of the step: no allocation.
+          launch = launch_list();
+          launch->steps.assign(t->nexts().begin(), t->nexts().end());
+          launch->activations.clear();
+          for (auto &step : launch->steps) {
+            auto next = step.lock();
+            if (!next) {
+              launch->activations.push_back(0);
+            } else {
+              launch->activations.push_back(
+                  next->isMacroStep() ? std::static_pointer_cast<Macro>(next)->first()->activationsCount()
+                                      : next->activationsCount());
+            }
+          }
+          if (launch->steps.size() > maxWorkers()) {
             m_running = false;
+            m_stop.requestStop();
             m_stop_code = CRAZY_PARALLELISM_STOP;
             activation_guard.reset();
             fireSequenceChanged(m_running);
             throw std::runtime_error(
                 "Not enough threads available to run sequence. Too big parallelism detection -> Sequence stopped !");
           }
+          std::size_t handed_over = 0;
           for (auto &step : t->nexts()) {
             bool is_macro = step.lock()->isMacroStep();
             if (is_macro) {
               step.lock()->setActivated(true);
-              m_macro_deactivations[std::dynamic_pointer_cast<Macro>(step.lock())->last()->getStepId()] =
-                  step.lock()->getStepId();
+              m_situation.publishStep(step.lock()->getStepId(), true);
+              if (graph->profile) {
+                graph->profile->stepActivated(graph->chart->stepIndex(step.lock()->getStepId()));
+              }
+              const uint32_t macro_index = graph->chart->stepIndex(step.lock()->getStepId());
+              graph->macro_deactivations[graph->chart->step(macro_index).macro_last] = step.lock()->getStepId();
             }
             Step &s = is_macro ? *std::dynamic_pointer_cast<Macro>(step.lock())->first() : *step.lock();
             if (m_running && !s.isActivated()) {
-              SP_CondVar step_cond_var = std::make_shared<std::condition_variable>();
               int next_id = s.getStepId();
               {
-                std::lock_guard<std::mutex> _lock(map_mutex);
-                if (!m_steps_required_call_count.count(next_id)) {
-                  m_steps_required_call_count[next_id] =
-                      (t->getValidationMode() == Transition::ALL) ? t->validations().size() : 1;
-                  m_steps_current_call_count[next_id] = 0;
+                // Convergence: only the branch completing the arrivals launches the step.
+                bool joined = true;
+                const uint32_t required = graph->chart->transition(transition_index).required_count;
+                JoinCounter *join = (required > 1) ? graph->joins[graph->chart->stepIndex(next_id)].get() : nullptr;
+                if (traced) {
+                  // One arrow per converging branch.
+                  m_tracer->flowStart(step_id, next_id, worker, branch, Tracer::now());
+                }
+                if (join) {
+                  // One atomic operation per arrival: exactly one branch sees the last one.
+                  const uint32_t remaining = join->remaining.fetch_sub(1, std::memory_order_acq_rel);
+                  joined = (remaining == 1);
+                  if (joined) {
+                    // Arrivals of the next round (Already decremented) are kept.
+                    join->remaining.fetch_add(join->required, std::memory_order_acq_rel);
+                  }
+                  if (m_persister) {
+                    uint32_t arrivals = join->required - remaining + 1;
+                    if (arrivals > join->required) {
+                      // Next round arrival before the completing branch refilled the counter (It went through 0).
+                      arrivals -= join->required;
+                    }
+                    m_persister->joinChanged(next_id, joined ? 0 : std::min(arrivals, join->required - 1),
+                                             m_clock->now());
+                  }
                 }
-                m_steps_current_call_count[next_id] = m_steps_current_call_count[next_id] + 1;
-                if (m_steps_required_call_count.count(next_id) &&
-                    m_steps_current_call_count[next_id] == m_steps_required_call_count[next_id]) {
-                  m_steps_current_call_count[next_id] = 0;
-                  uint32_t available_threads_count = 0;
-                  available_threads_count = m_thread_pool->n_idle();
-                  if (m_running && (available_threads_count == 0 || m_running_steps > m_thread_pool_size)) {
+                if (joined) {
+                  if (m_running && !reserveWorker() && m_running) {
                     m_running = false;
-                    m_stop_code = CRAZY_LOOPING_STOP;
+                    m_stop.requestStop();
                     activation_guard.reset();
+                    if (m_pool_policy.mode == PoolPolicy::STOP_ON_EXHAUSTION) {
+                      m_stop_code = CRAZY_LOOPING_STOP;
+                      fireSequenceChanged(m_running);
+                      throw std::runtime_error(
+                          "No more thread available to run sequence. Crazy-Looping detection -> Sequence stopped !");
+                    }
+                    m_stop_code = EXECUTOR_EXHAUSTED_STOP;
                     fireSequenceChanged(m_running);
-                    throw std::runtime_error(
-                        "No more thread available to run sequence. Crazy-Looping detection -> Sequence stopped !");
+                    throw std::runtime_error("No more thread available to run sequence. Executor exhausted -> Sequence stopped !");
                   } else if (m_running) {
 #ifdef DEBUG_MODE
                     std::cout << "run step id:" << next_id << std::endl;
 #endif
-                    m_thread_pool->push([=](int) { run(next_id, it->second, cond_var); });
+                    if (pinBranches()) {
+                      int cpu = m_affinity_config.cpus[std::max(getStepBranch(next_id), 0) % m_affinity_config.cpus.size()];
+                      pushStep([=](int worker_id) {
+                        m_thread_pool->pinCurrentWorker(worker_id, cpu);
+                        run(next_id, current_step, cond_var, graph, epoch);
+                      });
+                    } else {
+                      pushStep([=](int) { run(next_id, current_step, cond_var, graph, epoch); });
+                    }
+                    handed_over++;
                   }
                 }
               }
+            } else {
+              handed_over++;
             }
           }
+          handoff = (handed_over == t->nexts().size());
           break;
         } else if (!m_running) {
           break;
         }
       }
-      if (m_running) {
-        // This delay is to avoid 100% CPU taken by while loop...
-        std::this_thread::sleep_for(std::chrono::microseconds(m_transition_polling_delay));
-      } else {
+      m_metrics.add(Metrics::TRANSITIONS_EVALUATED, evaluated);
+      if (!done) {
+        m_metrics.add(Metrics::EMPTY_POLLS);
+      }
+      // This delay is to avoid 100% CPU taken by while loop... Cut short by the stop request.
+      if (!m_running || !m_stop.sleepFor(std::chrono::microseconds(m_transition_polling_delay))) {
         break;
       }
     }
@@ -436,26 +1490,14 @@ void Sequence::run(unsigned int step_id, std::shared_ptr<Step> previous_step, st
     // Here, if we have several parallel steps...one of them can catch back the previous step...
     // So we use condition_variables to protect the run method, and it wait that the previous is gone before rushing.
     // The notification that enable next steps to continue is sent by 'StepActivation activation_guard' destructor.
-    /// @warning What about when we have 2 times the same macro in the sequence ?
-    /// I think each of them has to be copied, to avoid "crossed-notifications",
-    /// and IDs of macro's steps have to be modified, to avoid conflicts.
-    if (m_running) {
-      activation_guard.setNotifications([=, &step_to_run]() {
-        if (m_macro_deactivations.count(step_to_run.getStepId())) {
-          auto macro = m_steps[m_macro_deactivations.at(step_to_run.getStepId())];
-          macro->setActivated(false);
-          fireStepChanged(macro->getStepId(), macro->isActivated());
-          m_macro_deactivations.erase(step_to_run.getStepId());
-        }
-        for (auto it = m_about_to_run_steps.begin(); it != m_about_to_run_steps.end(); it++) {
-          if (!it->expired()) {
-            Step &s = *it->lock();
-            do {
-              cond_var->notify_all();
-            } while (m_running && !(s.isActivated()));
-          }
-        }
-      });
+    if (step_to_run.isEnclosingStep()) {
+      // Children are deactivated with their enclosing step.
+      killScope(*graph, step_index);
+    }
+    // A macro used several times is instantiated ('Macro::instantiate'): each instance has its own steps and ids,
+    // so that macros deactivations never cross.
+    if (m_running && launch) {
+      activation_guard.setNexts(cond_var, *launch, handoff);
     }
     m_running_steps--;
 #ifdef DEBUG_MODE
@@ -464,6 +1506,82 @@ void Sequence::run(unsigned int step_id, std::shared_ptr<Step> previous_step, st
   }
 }
 
+bool Sequence::handOver(unsigned int step_id, const std::shared_ptr<Step> &current_step,
+                        const std::shared_ptr<std::condition_variable> &cond_var,
+                        const std::shared_ptr<const LiveGraph> &graph, LaunchList *&launch, uint32_t epoch) {
+  auto mapped = graph->mapping.find(step_id);
+  auto next = (mapped != graph->mapping.end()) ? getStepById(mapped->second) : nullptr;
+  uint32_t index = next ? graph->chart->stepIndex(next->getStepId()) : CompiledChart::NONE;
+  if (index == CompiledChart::NONE || !m_running) {
+    return false;
+  }
+  // The list of the mapped step parity its next run does not use (Activated once more).
+  launch = &graph->launches[2 * index + (next->activationsCount() & 1)];
+  launch->steps.assign(1, next);
+  launch->activations.assign(1, next->activationsCount());
+  if (!next->isActivated()) {
+    unsigned int next_id = next->getStepId();
+    pushStep([=](int) { run(next_id, current_step, cond_var, graph, epoch); });
+  }
+  return true;
+}
+
+void Sequence::killScope(const LiveGraph &graph, uint32_t enclosing_index) {
+  graph.scopes[enclosing_index]->epoch.fetch_add(1, std::memory_order_acq_rel);
+  for (auto child : graph.chart->enclosed(enclosing_index)) {
+    if (graph.joins[child]) {
+      graph.joins[child]->reset();
+    }
+    if (graph.scopes[child]) {
+      killScope(graph, child);
+    }
+  }
+}
+
+void Sequence::force(unsigned int enclosing_id, const std::vector<unsigned int> &steps) {
+  auto graph = std::atomic_load(&m_live_graph);
+  if (!m_running || !graph) {
+    throw std::runtime_error("Trying to force a sequence which is not running !");
+  }
+  const CompiledChart &chart = *graph->chart;
+  uint32_t index = chart.stepIndex(enclosing_id);
+  if (index == CompiledChart::NONE || !graph->scopes[index]) {
+    throw std::invalid_argument("Trying to force the children of a step which is not an enclosing step !");
+  }
+  std::vector<unsigned int> forced;
+  for (auto id : steps) {
+    uint32_t step_index = chart.stepIndex(id);
+    if (step_index == CompiledChart::NONE || chart.step(step_index).enclosing != index) {
+      throw std::invalid_argument("Trying to force a step which is not enclosed by the forced one !");
+    }
+    forced.push_back(id);
+  }
+  if (!chart.step(index).step->isActivated()) {
+    throw std::runtime_error("Trying to force the children of an inactive enclosing step !");
+  }
+  killScope(*graph, index);
+  const uint32_t epoch = graph->scopes[index]->epoch.load();
+  // Killed steps stop at their next polling: forced steps are launched once they are all gone.
+  std::function<bool(uint32_t)> any_active = [&chart, &any_active](uint32_t enclosing) {
+    for (auto child : chart.enclosed(enclosing)) {
+      if (chart.step(child).step->isActivated() || (chart.step(child).step->isEnclosingStep() && any_active(child))) {
+        return true;
+      }
+    }
+    return false;
+  };
+  while (m_running && any_active(index)) {
+    m_stop.sleepFor(std::chrono::microseconds(m_transition_polling_delay));
+  }
+  if (!m_running || graph->scopes[index]->epoch.load() != epoch) {
+    // Stopped, or killed again meanwhile.
+    return;
+  }
+  for (auto id : forced) {
+    m_thread_pool->push([=](int) { run(id, nullptr, nullptr, graph, epoch); });
+  }
+}
+
 void Sequence::fireSequenceChanged(bool state) {
   std::lock_guard<std::mutex> lock(seq_cb_mutex);
   std::lock_guard<std::mutex> lock2(step_cb_mutex);
@@ -475,55 +1593,250 @@ void Sequence::fireSequenceChanged(bool state) {
 }
 
 void Sequence::fireStepChanged(unsigned int id, bool state) {
+  m_situation.publishStep(id, state);
   if (m_running) {
+    if (m_recorder) {
+      m_recorder->stepChanged(id, state);
+    }
+    if (m_persister) {
+      m_persister->stepChanged(id, state, m_clock->now());
+    }
     std::lock_guard<std::mutex> lock(seq_cb_mutex);
     std::lock_guard<std::mutex> lock2(step_cb_mutex);
-    for (auto &callback : m_step_changed_callbacks) {
-      if (callback) {
-        callback(id, state);
+    if (!m_step_changed_callbacks.empty()) {
+      // Steady clock even when simulating: the real time taken by the callbacks.
+      const auto start = std::chrono::steady_clock::now();
+      for (auto &callback : m_step_changed_callbacks) {
+        if (callback) {
+          callback(id, state);
+        }
+      }
+      const auto end = std::chrono::steady_clock::now();
+      m_metrics.add(Metrics::CALLBACKS);
+      m_metrics.add(Metrics::CALLBACKS_NANOSECONDS, std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+      if (m_tracer) {
+        m_tracer->span(TraceEvent::CALLBACKS, id, Executor::currentWorker(), getStepBranch(id),
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()),
+                       std::chrono::duration_cast<std::chrono::nanoseconds>(end.time_since_epoch()));
       }
     }
   }
 }
 
-void Sequence::start(unsigned int init_step_id) {
+std::shared_ptr<const CompiledChart> Sequence::compileStartable() {
+  std::shared_ptr<const CompiledChart> chart;
   {
-    std::lock_guard<std::mutex> _lock(start_stop_mutex);
-    steps_mutex.lock();
-    bool all_transition_true = std::all_of(m_steps.begin(), m_steps.end(), [](const auto &p) {
-      const Step &s = *p.second;
-      return std::all_of(s.getNextTransitions().begin(), s.getNextTransitions().end(),
-                         [](const auto &t) { return t->getReceptivityState(); });
-    });
-    all_transition_true &= std::all_of(m_initial_steps.begin(), m_initial_steps.end(), [](const auto &p) {
-      const Step &s = *p.second;
-      return std::all_of(s.getNextTransitions().begin(), s.getNextTransitions().end(),
-                         [](const auto &t) { return t->getReceptivityState(); });
-    });
-    steps_mutex.unlock();
-    if (all_transition_true) {
-      throw std::logic_error("Trying to run a sequence with all transitions true at startup is not allowed...for the moment !");
+    std::lock_guard<std::mutex> _steps_lock(steps_mutex);
+    try {
+      chart = CompiledChart::compile(m_initial_steps, m_steps);
+    } catch (const std::invalid_argument &) {
+      // Same contract than the validity checks.
+      throw std::runtime_error("Trying to run an invalid sequence !");
     }
+  }
+  bool all_transition_true = true;
+  for (uint32_t i = 0; i < chart->transitionsCount() && all_transition_true; i++) {
+    all_transition_true = chart->transition(i).transition->getReceptivityState();
+  }
+  if (all_transition_true) {
+    throw std::logic_error("Trying to run a sequence with all transitions true at startup is not allowed...for the moment !");
+  }
+  // Same structure than the last validated one: no need to re-run the loop checks.
+  if (!m_chart_validated || chart->fingerprint() != m_validated_fingerprint) {
     if (!isValid()) {
       throw std::runtime_error("Trying to run an invalid sequence !");
     }
-    m_running = true;
-    fireSequenceChanged(m_running);
-    m_thread_pool = std::make_unique<ctpl::thread_pool>(m_thread_pool_size);
+    m_chart_validated = true;
+    m_validated_fingerprint = chart->fingerprint();
+  }
+  return chart;
+}
+
+void Sequence::start(unsigned int init_step_id) {
+  {
+    std::lock_guard<std::mutex> _lock(start_stop_mutex);
+    if (m_running) {
+      throw std::runtime_error("Trying to start an already running sequence !");
+    }
+    launch(compileStartable());
   }
   run(init_step_id);
 }
 
+void Sequence::resume(const Snapshot &snapshot) {
+  std::vector<unsigned int> to_run;
+  {
+    std::lock_guard<std::mutex> _lock(start_stop_mutex);
+    if (m_running) {
+      throw std::runtime_error("Trying to resume an already running sequence !");
+    }
+    auto chart = compileStartable();
+    if (snapshot.fingerprint != chart->fingerprint()) {
+      throw std::invalid_argument("Trying to resume a sequence from the snapshot of another chart !");
+    }
+    for (auto id : snapshot.active_steps) {
+      uint32_t index = chart->stepIndex(id);
+      if (index == CompiledChart::NONE) {
+        throw std::invalid_argument("Trying to resume a sequence from the snapshot of another chart !");
+      } else if (chart->step(index).macro_first == CompiledChart::NONE) {
+        to_run.push_back(id);
+      }
+    }
+    if (to_run.empty()) {
+      throw std::invalid_argument("Trying to resume a sequence from a snapshot without active step !");
+    } else if (to_run.size() > maxWorkers()) {
+      throw std::runtime_error("Not enough threads available to resume sequence !");
+    }
+    launch(chart);
+    auto graph = std::atomic_load(&m_live_graph);
+    for (auto id : snapshot.active_steps) {
+      uint32_t enclosing = chart->step(chart->stepIndex(id)).enclosing;
+      if (enclosing != CompiledChart::NONE) {
+        graph->scopes[enclosing]->resumed = true;
+      }
+    }
+    // Macros are only flags: their steps are run.
+    for (auto id : snapshot.active_steps) {
+      const auto &node = chart->step(chart->stepIndex(id));
+      if (node.macro_first != CompiledChart::NONE) {
+        node.step->setActivated(true);
+        fireStepChanged(id, true);
+        graph->macro_deactivations[node.macro_last] = id;
+      }
+    }
+    for (const auto &p : snapshot.join_counters) {
+      uint32_t index = chart->stepIndex(p.first);
+      if (index != CompiledChart::NONE && graph->joins[index]) {
+        graph->joins[index]->reset(p.second);
+        if (m_persister) {
+          m_persister->joinChanged(p.first, p.second, m_clock->now());
+        }
+      }
+    }
+  }
+  for (std::size_t i = 1; i < to_run.size(); i++) {
+    unsigned int id = to_run[i];
+    m_thread_pool->push([=](int) { run(id); });
+  }
+  run(to_run.front());
+}
+
+void Sequence::launch(std::shared_ptr<const CompiledChart> chart) {
+  if (m_action_policy != INLINE_ACTIONS && !m_action_executor) {
+    m_action_executor = std::make_shared<ActionExecutor>(m_action_workers_count);
+  }
+  installChart(chart);
+  if (m_profiler) {
+    m_profiler->runStarted();
+  }
+  if (m_persister) {
+    // The previous run state is replaced: 'Persister::recover' must have been called before.
+    m_persister->checkpoint();
+  }
+  if (m_thread_pool) {
+    // Steps of a run stopped from inside (Crazy stops) can still be finishing.
+    m_thread_pool->drain();
+    m_warm_starts++;
+  }
+  m_stop.reset();
+  m_running = true;
+  fireSequenceChanged(m_running);
+  if (!m_thread_pool) {
+    m_thread_pool = (m_pool_policy.mode == PoolPolicy::ELASTIC)
+                        ? std::make_unique<Executor>(m_thread_pool_size, maxWorkers(), m_pool_policy.idle_timeout)
+                        : std::make_unique<Executor>(m_thread_pool_size);
+    prepareExecutor();
+    m_chart_prepared = false;
+  }
+  if (!m_chart_prepared || m_prepared_fingerprint != chart->fingerprint()) {
+    if (m_rt_config.enabled()) {
+      prepareRealTime();
+    }
+    if (pinBranches() || m_tracer) {
+      prepareBranches();
+    }
+    m_chart_prepared = true;
+    m_prepared_fingerprint = chart->fingerprint();
+  }
+}
+
+void Sequence::prepareExecutor() {
+  if (m_rt_config.enabled()) {
+    m_thread_pool->applyRealTime(m_rt_config);
+  }
+  if (m_affinity_config.transition_cpu >= 0) {
+    m_thread_pool->applyAffinity({m_affinity_config.transition_cpu});
+  } else if (!m_affinity_config.cpus.empty()) {
+    m_thread_pool->applyAffinity(m_affinity_config.cpus);
+  }
+  if (m_action_executor && !m_affinity_config.cpus.empty()) {
+    m_action_executor->applyAffinity(m_affinity_config.cpus);
+  }
+}
+
+void Sequence::prepareRealTime() {
+  // A task per running step, and as many queued: launches beyond that stop the sequence anyway (Or wait, with
+  // backpressure).
+  m_thread_pool->reserveTasks(2 * maxWorkers());
+}
+
+bool Sequence::pinBranches() const {
+  return m_affinity_config.pin_branches && m_affinity_config.transition_cpu < 0 && !m_affinity_config.cpus.empty();
+}
+
+void Sequence::prepareBranches() {
+  // Breadth-first walk: each next step of a simultaneous divergence opens a new branch,
+  // other steps inherit the branch of the step they are reached from.
+  std::lock_guard<std::mutex> _lock(steps_mutex);
+  m_step_branches.clear();
+  unsigned int branches_count = 1;
+  std::vector<std::pair<std::shared_ptr<Step>, unsigned int>> to_visit;
+  std::vector<unsigned int> init_ids;
+  for (const auto &p : m_initial_steps) {
+    init_ids.push_back(p.first);
+  }
+  std::sort(init_ids.begin(), init_ids.end());
+  for (auto id : init_ids) {
+    to_visit.emplace_back(m_initial_steps.at(id), 0);
+  }
+  for (std::size_t i = 0; i < to_visit.size(); i++) {
+    auto step = to_visit[i].first;
+    unsigned int branch = to_visit[i].second;
+    if (!m_step_branches.emplace(step->getStepId(), branch).second) {
+      continue;
+    }
+    if (step->isMacroStep()) {
+      to_visit.emplace_back(std::dynamic_pointer_cast<Macro>(step)->first(), branch);
+      continue;
+    }
+    for (const auto &t : step->getNextTransitions()) {
+      bool divergence = t->nexts().size() > 1;
+      for (const auto &next : t->nexts()) {
+        if (auto next_step = next.lock()) {
+          to_visit.emplace_back(next_step, divergence ? branches_count++ : branch);
+        }
+      }
+    }
+  }
+}
+
 void Sequence::stop(bool fire) {
   std::lock_guard<std::mutex> _lock(start_stop_mutex);
+  const auto begin = std::chrono::steady_clock::now();
   m_running = false;
+  // Every engine wait (Polling sleeps, previous steps, actions, workers) is woken at once.
+  m_stop.requestStop();
   m_stop_code = NORMAL_STOP;
   if (m_thread_pool) {
-    // Wait for steps termination.
-    m_thread_pool->stop(true);
-    m_thread_pool.reset(nullptr);
+    // Wait for steps termination, workers stay parked for the next start.
+    m_thread_pool->drain();
   }
+  m_stop_latency.store((std::chrono::steady_clock::now() - begin).count(), std::memory_order_relaxed);
   if (fire) {
     fireSequenceChanged(m_running);
   }
 }
+
+std::chrono::nanoseconds Sequence::getStopLatency() const {
+  return std::chrono::nanoseconds(m_stop_latency.load(std::memory_order_relaxed));
+}
@@ -0,0 +1,493 @@
+#include "sfc/Simulation.hpp"
+#include "sfc/Sequence.hpp"
+#include "sfc/step/action/StepAction.hpp"
+#include "sfc/transition/Transition.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+Simulation::Simulation(Sequence &seq, std::chrono::nanoseconds start)
+    : seq(seq), m_clock(std::make_shared<VirtualClock>(start)) {}
+
+Simulation::~Simulation() { stop(); }
+
+void Simulation::start(unsigned int init_step_id) {
+  std::lock_guard<std::mutex> _lock(seq.start_stop_mutex);
+  if (seq.m_running) {
+    throw std::runtime_error("Trying to simulate a running sequence !");
+  }
+  m_chart = seq.compileStartable();
+  uint32_t init_index = m_chart->stepIndex(init_step_id);
+  if (init_index == CompiledChart::NONE) {
+    throw std::invalid_argument("Trying to run an invalid step (Id not found) !");
+  }
+  launch();
+  activate(init_index);
+}
+
+void Simulation::resume(const Snapshot &snapshot) {
+  std::lock_guard<std::mutex> _lock(seq.start_stop_mutex);
+  if (seq.m_running) {
+    throw std::runtime_error("Trying to simulate a running sequence !");
+  }
+  m_chart = seq.compileStartable();
+  if (snapshot.fingerprint != m_chart->fingerprint()) {
+    throw std::invalid_argument("Trying to resume a sequence from the snapshot of another chart !");
+  }
+  std::vector<uint32_t> indexes;
+  for (auto id : snapshot.active_steps) {
+    uint32_t index = m_chart->stepIndex(id);
+    if (index == CompiledChart::NONE) {
+      throw std::invalid_argument("Trying to resume a sequence from the snapshot of another chart !");
+    }
+    indexes.push_back(index);
+  }
+  launch();
+  for (const auto &p : snapshot.join_counters) {
+    uint32_t index = m_chart->stepIndex(p.first);
+    if (index != CompiledChart::NONE && m_joins[index]) {
+      m_joins[index]->reset(p.second);
+      if (seq.m_persister) {
+        seq.m_persister->joinChanged(p.first, p.second, now());
+      }
+    }
+  }
+  for (auto index : indexes) {
+    const auto &node = m_chart->step(index);
+    if (node.macro_first != CompiledChart::NONE) {
+      m_times[index].activated(now());
+      node.step->setActivated(true);
+      seq.fireStepChanged(node.step->getStepId(), true);
+      m_macro_deactivations[node.macro_last] = index;
+    }
+  }
+  for (auto index : indexes) {
+    if (m_chart->step(index).macro_first == CompiledChart::NONE) {
+      // Enclosed steps are in the snapshot.
+      activate(index, false);
+    }
+  }
+}
+
+void Simulation::force(unsigned int enclosing_id, const std::vector<unsigned int> &steps) {
+  if (!seq.m_running || !m_previous_clock) {
+    throw std::runtime_error("Trying to force a sequence which is not running !");
+  }
+  uint32_t index = m_chart->stepIndex(enclosing_id);
+  if (index == CompiledChart::NONE || !m_chart->step(index).step->isEnclosingStep()) {
+    throw std::invalid_argument("Trying to force the children of a step which is not an enclosing step !");
+  }
+  std::vector<uint32_t> forced;
+  for (auto id : steps) {
+    uint32_t step_index = m_chart->stepIndex(id);
+    if (step_index == CompiledChart::NONE || m_chart->step(step_index).enclosing != index) {
+      throw std::invalid_argument("Trying to force a step which is not enclosed by the forced one !");
+    }
+    forced.push_back(step_index);
+  }
+  if (!m_active[index]) {
+    throw std::runtime_error("Trying to force the children of an inactive enclosing step !");
+  }
+  seq.m_situation.beginWrite();
+  killChildren(index);
+  for (auto step_index : forced) {
+    if (!m_active[step_index]) {
+      activate(step_index);
+    }
+  }
+  seq.m_situation.endWrite();
+}
+
+void Simulation::launch() {
+  const uint32_t steps_count = m_chart->stepsCount();
+  m_active.assign(steps_count, 0);
+  m_macro_deactivations.assign(steps_count, CompiledChart::NONE);
+  m_activation_evolutions.assign(steps_count, 0);
+  m_active_steps.clear();
+  m_active_steps.reserve(steps_count);
+  m_evaluated_steps.reserve(steps_count);
+  m_to_activate.reserve(steps_count);
+
+  m_previous_clock = seq.m_clock;
+  seq.m_clock = m_clock;
+  seq.installChart(m_chart);
+  m_graph_version = seq.m_graph_version.load();
+  m_profile = std::atomic_load(&seq.m_live_graph)->profile;
+  m_times = std::atomic_load(&seq.m_live_graph)->times;
+  m_joins = std::atomic_load(&seq.m_live_graph)->joins;
+  if (seq.m_profiler) {
+    seq.m_profiler->runStarted();
+  }
+  if (seq.m_persister) {
+    seq.m_persister->checkpoint();
+  }
+  seq.m_stop_code = Sequence::NORMAL_STOP;
+  seq.m_stop.reset();
+  seq.m_running = true;
+  seq.fireSequenceChanged(seq.m_running);
+}
+
+void Simulation::stop() {
+  std::lock_guard<std::mutex> _lock(seq.start_stop_mutex);
+  if (!m_previous_clock) {
+    return;
+  }
+  // The sequence may already have been stopped by 'Sequence::stop'.
+  bool was_running = seq.m_running.exchange(false);
+  seq.m_stop.requestStop();
+  for (auto index : m_active_steps) {
+    Step &step = *m_chart->step(index).step;
+    m_times[index].deactivated(now());
+    step.setActivated(false);
+    seq.m_situation.publishStep(step.getStepId(), false);
+    m_active[index] = 0;
+  }
+  m_active_steps.clear();
+  seq.m_clock = m_previous_clock;
+  if (seq.m_recorder) {
+    seq.m_recorder->setClock(seq.m_clock);
+  }
+  m_previous_clock.reset();
+  if (was_running) {
+    seq.fireSequenceChanged(seq.m_running);
+  }
+}
+
+void Simulation::activate(uint32_t step_index, bool propagate) {
+  Step &step = *m_chart->step(step_index).step;
+  for (const auto &a : step.getActions()) {
+    (*a)();
+  }
+  m_times[step_index].activated(now());
+  step.setActivated(true);
+  m_active[step_index] = 1;
+  m_activation_evolutions[step_index] = m_evolutions;
+  m_active_steps.push_back(step_index);
+  m_activations_count++;
+  seq.m_metrics.add(Metrics::STEPS_ACTIVATED);
+  if (m_profile) {
+    m_profile->stepActivated(step_index);
+  }
+  seq.fireStepChanged(step.getStepId(), true);
+  if (propagate) {
+    for (auto child : m_chart->activations(step_index)) {
+      if (!m_active[child]) {
+        activate(child);
+      }
+    }
+  }
+}
+
+void Simulation::deactivate(uint32_t step_index) {
+  Step &step = *m_chart->step(step_index).step;
+  if (m_evolving && m_activation_evolutions[step_index] == m_evolutions) {
+    m_transient_count++;
+  }
+  m_times[step_index].deactivated(now());
+  step.setActivated(false);
+  m_active[step_index] = 0;
+  m_active_steps.erase(std::find(m_active_steps.begin(), m_active_steps.end(), step_index));
+  seq.fireStepChanged(step.getStepId(), false);
+  uint32_t macro_index = m_macro_deactivations[step_index];
+  if (macro_index != CompiledChart::NONE) {
+    Step &macro = *m_chart->step(macro_index).step;
+    m_times[macro_index].deactivated(now());
+    macro.setActivated(false);
+    seq.fireStepChanged(macro.getStepId(), macro.isActivated());
+    m_macro_deactivations[step_index] = CompiledChart::NONE;
+  }
+  if (step.isEnclosingStep()) {
+    killChildren(step_index);
+  }
+}
+
+void Simulation::killChildren(uint32_t enclosing_index) {
+  // Macros steps are enclosed with their macro: every active step of the scope is found.
+  auto enclosed = [this, enclosing_index](uint32_t index) { return m_chart->step(index).enclosing == enclosing_index; };
+  for (auto it = std::find_if(m_active_steps.begin(), m_active_steps.end(), enclosed); it != m_active_steps.end();
+       it = std::find_if(m_active_steps.begin(), m_active_steps.end(), enclosed)) {
+    deactivate(*it);
+  }
+  for (auto child : m_chart->enclosed(enclosing_index)) {
+    if (m_joins[child]) {
+      m_joins[child]->reset();
+    }
+    const auto &node = m_chart->step(child);
+    if (node.macro_first != CompiledChart::NONE && m_macro_deactivations[node.macro_last] == child) {
+      // Killed before its last step.
+      m_macro_deactivations[node.macro_last] = CompiledChart::NONE;
+      m_times[child].deactivated(now());
+      node.step->setActivated(false);
+      seq.fireStepChanged(node.step->getStepId(), false);
+    }
+  }
+}
+
+void Simulation::adoptGraph() {
+  auto graph = std::atomic_load(&seq.m_live_graph);
+  auto previous = m_chart;
+  m_chart = graph->chart;
+  m_graph_version = graph->version;
+  m_profile = graph->profile;
+  m_times = graph->times;
+  // Kept by the new graph.
+  m_joins = graph->joins;
+  auto index_of = [this, &previous](uint32_t previous_index) {
+    return (previous_index == CompiledChart::NONE) ? CompiledChart::NONE
+                                                   : m_chart->stepIndex(previous->step(previous_index).step->getStepId());
+  };
+
+  const uint32_t steps_count = m_chart->stepsCount();
+  std::vector<uint32_t> macro_deactivations(steps_count, CompiledChart::NONE);
+  std::vector<uint64_t> activation_evolutions(steps_count, 0);
+  for (uint32_t i = 0; i < previous->stepsCount(); i++) {
+    uint32_t index = index_of(i);
+    if (index != CompiledChart::NONE) {
+      macro_deactivations[index] = index_of(m_macro_deactivations[i]);
+      activation_evolutions[index] = m_activation_evolutions[i];
+    }
+  }
+  m_macro_deactivations.swap(macro_deactivations);
+  m_activation_evolutions.swap(activation_evolutions);
+
+  std::vector<uint32_t> active_steps = std::move(m_active_steps);
+  m_active_steps.clear();
+  m_active.assign(steps_count, 0);
+  std::vector<Step *> removed;
+  for (auto previous_index : active_steps) {
+    uint32_t index = index_of(previous_index);
+    if (index != CompiledChart::NONE) {
+      m_active[index] = 1;
+      m_active_steps.push_back(index);
+    } else {
+      removed.push_back(previous->step(previous_index).step);
+    }
+  }
+  m_active_steps.reserve(steps_count);
+  m_evaluated_steps.reserve(steps_count);
+  m_to_activate.reserve(steps_count);
+  // Active removed steps hand over to their mapped steps.
+  for (auto step : removed) {
+    step->setActivated(false);
+    seq.fireStepChanged(step->getStepId(), false);
+    auto mapped = graph->mapping.find(step->getStepId());
+    uint32_t index = (mapped != graph->mapping.end()) ? m_chart->stepIndex(mapped->second) : CompiledChart::NONE;
+    if (index != CompiledChart::NONE && !m_active[index]) {
+      activate(index);
+    }
+  }
+}
+
+bool Simulation::cross() {
+  bool fired = false;
+  m_evaluated_steps = m_active_steps;
+  m_to_activate.clear();
+  for (auto step_index : m_evaluated_steps) {
+    if (!m_active[step_index]) {
+      // Killed with its enclosing step.
+      continue;
+    }
+    uint32_t rank = 0;
+    for (auto t : m_chart->nextTransitions(step_index)) {
+      const auto &transition = m_chart->transition(t);
+      seq.m_metrics.add(Metrics::TRANSITIONS_EVALUATED);
+      if (m_profile) {
+        m_profile->transitionEvaluated(step_index, rank);
+      }
+      rank++;
+      if (!transition.transition->getReceptivityState()) {
+        continue;
+      }
+      fired = true;
+      m_fired_count++;
+      seq.m_metrics.add(Metrics::TRANSITIONS_FIRED);
+      if (m_profile) {
+        m_profile->transitionFired(step_index, rank - 1);
+      }
+      for (auto next : m_chart->nexts(t)) {
+        const auto &next_node = m_chart->step(next);
+        uint32_t target = next;
+        if (next_node.macro_first != CompiledChart::NONE) {
+          m_times[next].activated(now());
+          next_node.step->setActivated(true);
+          seq.m_situation.publishStep(next_node.step->getStepId(), true);
+          if (m_profile) {
+            m_profile->stepActivated(next);
+          }
+          m_macro_deactivations[next_node.macro_last] = next;
+          target = next_node.macro_first;
+        }
+        if (!m_active[target]) {
+          bool joined = true;
+          if (transition.required_count > 1) {
+            Sequence::JoinCounter &join = *m_joins[target];
+            const uint32_t remaining = join.remaining.fetch_sub(1);
+            joined = (remaining == 1);
+            if (joined) {
+              join.reset();
+            }
+            if (seq.m_persister) {
+              seq.m_persister->joinChanged(m_chart->step(target).step->getStepId(), joined ? 0 : join.required - remaining + 1,
+                                           now());
+            }
+          }
+          if (joined) {
+            m_to_activate.push_back(target);
+          }
+        }
+      }
+      deactivate(step_index);
+      break;
+    }
+    if (!seq.m_running) {
+      // Stopped by an action or a callback.
+      return fired;
+    }
+  }
+  for (auto index : m_to_activate) {
+    uint32_t enclosing = m_chart->step(index).enclosing;
+    if (!m_active[index] && (enclosing == CompiledChart::NONE || m_active[enclosing])) {
+      activate(index);
+    }
+  }
+  return fired;
+}
+
+bool Simulation::tick() {
+  if (!seq.m_running) {
+    return false;
+  }
+  auto graph = std::atomic_load(&seq.m_live_graph);
+  seq.drainInputs(*graph->chart);
+  seq.samplePredicates(*graph);
+  // The whole polling period is published at once.
+  seq.m_situation.beginWrite();
+  if (seq.m_graph_version.load() != m_graph_version) {
+    adoptGraph();
+  }
+  bool fired = cross();
+  seq.m_situation.endWrite();
+  if (!seq.m_running) {
+    return fired;
+  }
+  if (!fired) {
+    seq.m_metrics.add(Metrics::EMPTY_POLLS);
+  }
+  m_ticks++;
+  m_clock->advance(std::chrono::microseconds(seq.m_transition_polling_delay));
+  return fired;
+}
+
+bool Simulation::evolve(uint32_t max_rounds) {
+  if (!seq.m_running) {
+    return false;
+  }
+  // One input image for the whole evolution.
+  auto graph = std::atomic_load(&seq.m_live_graph);
+  seq.drainInputs(*graph->chart);
+  seq.samplePredicates(*graph);
+  // Published at once: transient steps are never seen by readers.
+  seq.m_situation.beginWrite();
+  if (seq.m_graph_version.load() != m_graph_version) {
+    adoptGraph();
+  }
+  m_evolutions++;
+  m_evolving = true;
+  bool stable = false;
+  uint32_t rounds = 0;
+  while (seq.m_running && rounds < max_rounds) {
+    if (!cross()) {
+      stable = true;
+      break;
+    }
+    rounds++;
+  }
+  m_evolving = false;
+  seq.m_situation.endWrite();
+  if (rounds == 0) {
+    seq.m_metrics.add(Metrics::EMPTY_POLLS);
+  }
+  return stable || !seq.m_running;
+}
+
+void Simulation::runSynchronous() {
+  using SteadyTime = std::chrono::steady_clock;
+  const auto begin = SteadyTime::now();
+  const auto virtual_begin = now();
+  while (seq.m_running) {
+    evolve();
+    seq.m_stop.sleepFor(std::chrono::microseconds(seq.m_transition_polling_delay));
+    m_clock->advanceTo(std::max(now(), virtual_begin + (SteadyTime::now() - begin)));
+  }
+  stop();
+}
+
+std::chrono::nanoseconds Simulation::nextSampling(std::chrono::nanoseconds deadline) const {
+  auto graph = std::atomic_load(&seq.m_live_graph);
+  for (const auto &group : graph->sampling) {
+    deadline = std::min(deadline, std::chrono::nanoseconds(group.next_due));
+  }
+  return std::max(now(), deadline);
+}
+
+void Simulation::advance(std::chrono::nanoseconds duration) {
+  const auto deadline = now() + duration;
+  while (seq.m_running && now() < deadline) {
+    if (!tick() && now() < deadline) {
+      // Nothing crossed: nothing changes until the next predicates sampling, or the next external input.
+      m_clock->advanceTo(nextSampling(deadline));
+    }
+  }
+}
+
+bool Simulation::runUntil(const std::function<bool()> &predicate, std::chrono::nanoseconds timeout) {
+  const auto deadline = now() + timeout;
+  while (!predicate()) {
+    if (!seq.m_running || now() >= deadline) {
+      return predicate();
+    }
+    if (!tick() && !predicate()) {
+      const auto next = nextSampling(deadline);
+      m_clock->advanceTo(next);
+      if (next >= deadline) {
+        return predicate();
+      }
+    }
+  }
+  return true;
+}
+
+bool Simulation::runUntilStable(uint64_t max_ticks) {
+  for (uint64_t i = 0; i < max_ticks && seq.m_running; i++) {
+    if (!tick()) {
+      return true;
+    }
+  }
+  return !seq.m_running;
+}
+
+std::chrono::nanoseconds Simulation::now() const { return m_clock->now(); }
+
+std::shared_ptr<VirtualClock> Simulation::getClock() const { return m_clock; }
+
+std::vector<unsigned int> Simulation::getActivatedSteps() const {
+  std::vector<unsigned int> ids;
+  ids.reserve(m_active_steps.size());
+  for (auto index : m_active_steps) {
+    ids.push_back(m_chart->step(index).step->getStepId());
+  }
+  return ids;
+}
+
+std::shared_ptr<const CompiledChart> Simulation::getCompiledChart() const { return m_chart; }
+
+uint64_t Simulation::ticksCount() const { return m_ticks; }
+
+uint64_t Simulation::firedCount() const { return m_fired_count; }
+
+uint64_t Simulation::activationsCount() const { return m_activations_count; }
+
+uint64_t Simulation::evolutionsCount() const { return m_evolutions; }
+
+uint64_t Simulation::transientCount() const { return m_transient_count; }
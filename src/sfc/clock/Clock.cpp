@@ -0,0 +1,25 @@
+#include "sfc/clock/Clock.hpp"
+
+#include <stdexcept>
+
+std::chrono::nanoseconds SteadyClock::now() const {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+VirtualClock::VirtualClock(std::chrono::nanoseconds start) : m_now(start.count()) {}
+
+std::chrono::nanoseconds VirtualClock::now() const { return std::chrono::nanoseconds(m_now.load()); }
+
+void VirtualClock::advance(std::chrono::nanoseconds duration) {
+  if (duration.count() < 0) {
+    throw std::invalid_argument("Virtual time can not go backward !");
+  }
+  m_now += duration.count();
+}
+
+void VirtualClock::advanceTo(std::chrono::nanoseconds time) {
+  if (time.count() < m_now) {
+    throw std::invalid_argument("Virtual time can not go backward !");
+  }
+  m_now = time.count();
+}
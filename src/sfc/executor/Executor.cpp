@@ -0,0 +1,264 @@
+#include "sfc/executor/Executor.hpp"
+
+#include <alloca.h>
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <thread>
+
+bool setThreadAffinity(std::thread::native_handle_type thread, const std::vector<int> &cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  int err = pthread_setaffinity_np(thread, sizeof(set), &set);
+  if (err != 0) {
+    std::cerr << "Affinity: pthread_setaffinity_np failed (" << std::strerror(err) << ") !" << std::endl;
+  }
+  return err == 0;
+}
+
+std::vector<int> getThreadAffinity(std::thread::native_handle_type thread) {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (pthread_getaffinity_np(thread, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  return cpus;
+}
+
+thread_local const Executor *Executor::s_current = nullptr;
+thread_local int Executor::s_worker = -1;
+
+Executor::Executor(uint32_t workers_count, uint32_t max_workers, std::chrono::milliseconds idle_timeout)
+    : m_in_flight(0), m_queued(0), m_tasks_count(0), m_pool(workers_count),
+      m_max_workers(std::max(workers_count, max_workers)), m_last_cpus(new std::atomic_int[m_max_workers]),
+      m_pinned_cpus(new std::atomic_int[m_max_workers]) {
+  for (uint32_t i = 0; i < m_max_workers; i++) {
+    m_last_cpus[i] = -1;
+    m_pinned_cpus[i] = -1;
+  }
+  m_pool.set_idle_timeout(workers_count, idle_timeout);
+  // Workers must be idle before the first push: 'idleCount' is used by the crazy-looping detection.
+  while (static_cast<uint32_t>(m_pool.n_idle()) < workers_count) {
+    std::this_thread::yield();
+  }
+}
+
+Executor::~Executor() {
+  stop(true);
+  // Stopped without waiting: tasks left in their slots.
+  for (uint32_t i = 0; i < m_slots_count; i++) {
+    if (m_slots[i].destroy) {
+      m_slots[i].destroy(m_slots[i].storage);
+    }
+  }
+}
+
+bool Executor::reserveTasks(uint32_t capacity) {
+  std::lock_guard<std::mutex> _lock(m_slots_mutex);
+  if (capacity <= m_slots_count) {
+    return true;
+  }
+  if (m_free_slots.size() != m_slots_count) {
+    // Their runners are queued.
+    return false;
+  }
+  m_slots.reset(new TaskSlot[capacity]);
+  m_slots_count = capacity;
+  m_free_slots.clear();
+  m_free_slots.reserve(capacity);
+  for (uint32_t i = capacity; i > 0; i--) {
+    m_slots[i - 1].runner = [this, i](int id) { runSlot(i - 1, id); };
+    m_free_slots.push_back(i - 1);
+  }
+  m_pool.reserve(capacity);
+  return true;
+}
+
+Executor::TaskSlot *Executor::acquireSlot() {
+  std::lock_guard<std::mutex> _lock(m_slots_mutex);
+  if (m_free_slots.empty()) {
+    return nullptr;
+  }
+  TaskSlot *slot = &m_slots[m_free_slots.back()];
+  m_free_slots.pop_back();
+  return slot;
+}
+
+void Executor::runSlot(uint32_t index, int worker_id) {
+  TaskSlot &slot = m_slots[index];
+  auto release = [this, &slot, index]() {
+    slot.destroy(slot.storage);
+    slot.invoke = nullptr;
+    slot.destroy = nullptr;
+    std::lock_guard<std::mutex> _lock(m_slots_mutex);
+    m_free_slots.push_back(index);
+  };
+  m_queued--;
+  // Released before the task is told done ('drain').
+  TaskScope scope(*this, worker_id);
+  m_last_cpus[worker_id] = sched_getcpu();
+  try {
+    slot.invoke(slot.storage, worker_id);
+  } catch (...) {
+    release();
+    throw;
+  }
+  release();
+}
+
+void Executor::drain() {
+  const uint32_t self = (s_current == this) ? 1 : 0;
+  while (true) {
+    uint32_t generation = m_task_done.load();
+    if (m_in_flight <= self) {
+      return;
+    }
+    m_task_done.wait(generation);
+  }
+}
+
+uint32_t Executor::inFlightCount() const { return m_in_flight; }
+
+uint32_t Executor::queuedCount() const { return m_queued; }
+
+uint64_t Executor::tasksCount() const { return m_tasks_count.load(std::memory_order_relaxed); }
+
+bool Executor::grow() {
+  // A retired worker index is reused: forget its pinning (The new thread inherits the spawning worker affinity).
+  return m_pool.grow(m_max_workers, [this](int id) {
+    m_last_cpus[id] = -1;
+    m_pinned_cpus[id] = -1;
+  });
+}
+
+bool Executor::awaitWorker(std::chrono::nanoseconds timeout, const StopToken &stop) {
+  StopToken::Callback on_stop(stop, [this]() { m_task_done.bump(); });
+  return awaitWorker(timeout, [&stop]() { return !stop.stopRequested(); });
+}
+
+bool Executor::awaitWorker(std::chrono::nanoseconds timeout, const std::function<bool()> &running) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  while (running()) {
+    uint32_t generation = m_task_done.load();
+    if (idleCount() > queuedCount()) {
+      return true;
+    }
+    auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= std::chrono::nanoseconds(0)) {
+      return false;
+    }
+    // A worker finishing its task is idle a bit later: wait by slices.
+    m_task_done.wait(generation, std::min<std::chrono::nanoseconds>(left, std::chrono::milliseconds(1)));
+  }
+  return false;
+}
+
+int Executor::currentWorker() { return s_worker; }
+
+std::size_t Executor::workerStackSize() {
+  std::size_t size = 0;
+  pthread_attr_t attr;
+  if (pthread_attr_init(&attr) == 0) {
+    pthread_attr_getstacksize(&attr, &size);
+    pthread_attr_destroy(&attr);
+  }
+  return size;
+}
+
+uint32_t Executor::size() { return m_pool.size(); }
+
+uint32_t Executor::idleCount() { return m_pool.n_idle(); }
+
+void Executor::runOnEachWorker(std::function<void(int)> fn) {
+  // Every worker blocks until all of them took one task, so that no worker can run two of them.
+  const uint32_t workers_count = size();
+  std::mutex mutex;
+  std::condition_variable cond_var;
+  uint32_t arrived = 0;
+  uint32_t done = 0;
+  for (uint32_t i = 0; i < workers_count; i++) {
+    m_pool.push([&](int id) {
+      fn(id);
+      std::unique_lock<std::mutex> lock(mutex);
+      arrived++;
+      cond_var.notify_all();
+      cond_var.wait(lock, [&]() { return arrived == workers_count; });
+      done++;
+      cond_var.notify_all();
+    });
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  cond_var.wait(lock, [&]() { return done == workers_count; });
+}
+
+bool Executor::applyRealTime(const RealTimeConfig &config) {
+  std::atomic_bool ret(true);
+  if (config.lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+    std::cerr << "Real-time: mlockall failed (" << std::strerror(errno) << ") !" << std::endl;
+    ret = false;
+  }
+  if (config.policy == RealTimeConfig::SCHED_POLICY_OTHER && config.prefault_stack_size == 0) {
+    return ret;
+  }
+  runOnEachWorker([&config, &ret](int) {
+    if (config.policy != RealTimeConfig::SCHED_POLICY_OTHER) {
+      sched_param param{};
+      param.sched_priority = config.priority;
+      int policy = (config.policy == RealTimeConfig::SCHED_POLICY_FIFO) ? SCHED_FIFO : SCHED_RR;
+      int err = pthread_setschedparam(pthread_self(), policy, &param);
+      if (err != 0) {
+        std::cerr << "Real-time: pthread_setschedparam failed (" << std::strerror(err) << ") !" << std::endl;
+        ret = false;
+      }
+    }
+    if (config.prefault_stack_size > 0) {
+      // Touch the stack so that its pages are mapped (and locked with 'lock_memory') before running steps.
+      volatile char *stack = static_cast<volatile char *>(alloca(config.prefault_stack_size));
+      for (std::size_t i = 0; i < config.prefault_stack_size; i += 4096) {
+        stack[i] = 0;
+      }
+    }
+  });
+  return ret;
+}
+
+bool Executor::applyAffinity(const std::vector<int> &cpus) {
+  bool ret = true;
+  m_pool.for_each_thread([this, &cpus, &ret](int i, std::thread &thread) {
+    ret &= setThreadAffinity(thread.native_handle(), cpus);
+    m_pinned_cpus[i] = -1;
+  });
+  return ret;
+}
+
+void Executor::pinCurrentWorker(int worker_id, int cpu) {
+  if (m_pinned_cpus[worker_id] != cpu && setThreadAffinity(pthread_self(), {cpu})) {
+    m_pinned_cpus[worker_id] = cpu;
+  }
+}
+
+std::vector<WorkerPlacement> Executor::placement() {
+  std::vector<WorkerPlacement> placements;
+  m_pool.for_each_thread([this, &placements](int i, std::thread &thread) {
+    placements.push_back({m_last_cpus[i], getThreadAffinity(thread.native_handle())});
+  });
+  return placements;
+}
+
+void Executor::stop(bool wait) { m_pool.stop(wait); }
@@ -0,0 +1,161 @@
+#include "sfc/generator/ChartGenerator.hpp"
+#include "sfc/Sequence.hpp"
+#include "sfc/step/Macro.hpp"
+
+#include <algorithm>
+
+void GeneratedChart::addTo(Sequence &seq) const {
+  for (const auto &step : steps) {
+    seq.addStep(step);
+  }
+}
+
+ChartGenerator::ChartGenerator(const GeneratorConfig &config) : m_config(config), m_random(config.seed) {}
+
+uint32_t ChartGenerator::uniform(uint32_t min, uint32_t max) {
+  // Scaled from the engine output (Standard for 'std::mt19937'), not by a distribution (Implementation defined).
+  const uint64_t range = uint64_t(std::max(min, max)) - min + 1;
+  return min + static_cast<uint32_t>((uint64_t(m_random()) * range) >> 32);
+}
+
+double ChartGenerator::chance() { return m_random() / 4294967296.0; }
+
+bool ChartGenerator::budgetLeft(uint32_t steps) const { return m_next_id + steps <= m_config.max_steps; }
+
+std::shared_ptr<Step> ChartGenerator::makeStep() {
+  auto step = std::make_shared<Step>(m_next_id++, Step::DEFAULT_STEP);
+  m_chart.steps.push_back(step);
+  m_chart.steps_count++;
+  return step;
+}
+
+std::shared_ptr<Transition> ChartGenerator::connect(const std::vector<std::shared_ptr<Step>> &from,
+                                                    const std::vector<std::shared_ptr<Step>> &to) {
+  auto transition = std::make_shared<Transition>(std::vector<std::weak_ptr<Step>>(to.begin(), to.end()),
+                                                 std::vector<std::weak_ptr<Step>>(from.begin(), from.end()));
+  for (const auto &step : from) {
+    step->addTransition(transition);
+  }
+  for (const auto &step : to) {
+    m_chart.incoming[step->getStepId()].push_back(transition);
+  }
+  m_chart.transitions.push_back(transition);
+  return transition;
+}
+
+ChartGenerator::Segment ChartGenerator::sequence(uint32_t depth) {
+  Segment first = block(depth);
+  Segment last = first;
+  for (uint32_t i = 1, count = uniform(1, m_config.length); i < count && budgetLeft(1); i++) {
+    Segment next = block(depth);
+    connect({last.exit}, {next.entry});
+    first.width = std::max(first.width, next.width);
+    last = next;
+  }
+  return {first.entry, last.exit, first.width, first.looped};
+}
+
+ChartGenerator::Segment ChartGenerator::block(uint32_t depth) {
+  double kind = chance();
+  Segment segment;
+  if ((kind -= m_config.simultaneous_ratio) < 0) {
+    if (depth > 0 && m_config.simultaneous_fanout >= 2 && budgetLeft(4)) {
+      segment = simultaneous(depth - 1);
+    }
+  } else if ((kind -= m_config.exclusive_ratio) < 0) {
+    if (depth > 0 && m_config.exclusive_fanout >= 2 && budgetLeft(4)) {
+      segment = exclusive(depth - 1);
+    }
+  } else if ((kind -= m_config.macro_ratio) < 0) {
+    if (m_config.macro_steps >= 2 && budgetLeft(3)) {
+      segment = macro();
+    }
+  }
+  if (!segment.entry) {
+    auto step = makeStep();
+    segment = {step, step, 1};
+  }
+  if (chance() < m_config.loop_ratio && budgetLeft(1)) {
+    // The looping step has two exclusive transitions: back to the block, then (Added by the caller) forward.
+    auto looping = makeStep();
+    connect({segment.exit}, {looping});
+    connect({looping}, {segment.entry});
+    m_chart.loops_count++;
+    segment.exit = looping;
+    segment.looped = true;
+  }
+  return segment;
+}
+
+ChartGenerator::Segment ChartGenerator::simultaneous(uint32_t depth) {
+  auto fork = makeStep();
+  std::vector<std::shared_ptr<Step>> entries;
+  std::vector<std::shared_ptr<Step>> exits;
+  uint32_t width = 0;
+  for (uint32_t i = 0, count = uniform(2, m_config.simultaneous_fanout); i < count; i++) {
+    Segment branch = sequence(depth);
+    if (branch.looped) {
+      // The common transition search ('Sequence::isValid') stops at loops back to a branch first step.
+      auto entry = makeStep();
+      connect({entry}, {branch.entry});
+      branch.entry = entry;
+    }
+    entries.push_back(branch.entry);
+    exits.push_back(branch.exit);
+    width += branch.width;
+  }
+  auto join = makeStep();
+  connect({fork}, entries);
+  connect(exits, {join});
+  m_chart.simultaneous_count++;
+  return {fork, join, width};
+}
+
+ChartGenerator::Segment ChartGenerator::exclusive(uint32_t depth) {
+  auto fork = makeStep();
+  std::vector<Segment> branches;
+  uint32_t width = 1;
+  for (uint32_t i = 0, count = uniform(2, m_config.exclusive_fanout); i < count; i++) {
+    branches.push_back(sequence(depth));
+    width = std::max(width, branches.back().width);
+  }
+  auto join = makeStep();
+  for (const auto &branch : branches) {
+    connect({fork}, {branch.entry});
+    connect({branch.exit}, {join});
+  }
+  m_chart.exclusive_count++;
+  return {fork, join, width};
+}
+
+ChartGenerator::Segment ChartGenerator::macro() {
+  auto macro = std::make_shared<Macro>(m_next_id++);
+  std::shared_ptr<Step> previous;
+  for (uint32_t i = 0, count = uniform(2, m_config.macro_steps); i < count && (i < 2 || budgetLeft(1)); i++) {
+    auto step = std::make_shared<Step>(m_next_id++, Step::DEFAULT_STEP);
+    macro->addStep(step);
+    m_chart.steps_count++;
+    if (previous) {
+      connect({previous}, {step});
+    }
+    previous = step;
+  }
+  m_chart.steps.push_back(macro);
+  m_chart.steps_count++;
+  m_chart.macros_count++;
+  // Active with one of its steps.
+  return {macro, macro, 2};
+}
+
+GeneratedChart ChartGenerator::generate() {
+  m_chart = GeneratedChart();
+  m_next_id = 0;
+  auto init_step = std::make_shared<Step>(m_next_id++, Step::INIT_STEP);
+  m_chart.steps.push_back(init_step);
+  m_chart.steps_count++;
+  Segment body = sequence(m_config.depth);
+  connect({init_step}, {body.entry});
+  connect({body.exit}, {init_step});
+  m_chart.max_active_steps = body.width;
+  return std::move(m_chart);
+}
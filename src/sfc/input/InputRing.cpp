@@ -0,0 +1,115 @@
+#include "sfc/input/InputRing.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+constexpr char InputRing::MAGIC[4];
+
+InputRing::InputRing(const std::string &path, uint32_t capacity) : m_path(path) {
+  static_assert(sizeof(Header) <= HEADER_SIZE, "Input ring header does not fit !");
+  static_assert(std::atomic_uint64_t::is_always_lock_free, "Input ring cursors must be lock-free to be shared !");
+  m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (m_fd < 0) {
+    throw std::runtime_error("Cannot open input ring file: " + path);
+  }
+  auto map_size = [](uint32_t capacity) { return HEADER_SIZE + 3 * sizeof(Cursor) + std::size_t(capacity) * sizeof(uint64_t); };
+  struct stat st;
+  Header header;
+  bool existing = ::fstat(m_fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= HEADER_SIZE &&
+                  ::pread(m_fd, &header, sizeof(header), 0) == sizeof(header) &&
+                  std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                  header.capacity > 0 && (header.capacity & (header.capacity - 1)) == 0 &&
+                  static_cast<std::size_t>(st.st_size) == map_size(header.capacity);
+  if (existing) {
+    m_capacity = header.capacity;
+  } else {
+    m_capacity = 1;
+    while (m_capacity < capacity && m_capacity < (1u << 31)) {
+      m_capacity <<= 1;
+    }
+  }
+  m_map_size = map_size(m_capacity);
+  if (!existing && ::ftruncate(m_fd, 0) != 0) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot truncate input ring file: " + path);
+  }
+  if (::ftruncate(m_fd, m_map_size) != 0) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot size input ring file: " + path);
+  }
+  void *map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot map input ring file: " + path);
+  }
+  m_map = static_cast<uint8_t *>(map);
+  // Zeroed by 'ftruncate' at creation: all cursors start at 0.
+  m_head = reinterpret_cast<Cursor *>(m_map + HEADER_SIZE);
+  m_tail = m_head + 1;
+  m_dropped = m_head + 2;
+  m_slots = reinterpret_cast<uint64_t *>(m_head + 3);
+  if (!existing) {
+    Header *h = reinterpret_cast<Header *>(m_map);
+    h->version = VERSION;
+    h->capacity = m_capacity;
+    h->reserved = 0;
+    // Last: a ring being created is not taken as an existing one.
+    std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+  }
+}
+
+InputRing::~InputRing() {
+  if (m_map) {
+    ::munmap(m_map, m_map_size);
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+bool InputRing::push(uint32_t transition_id, bool value) {
+  const uint64_t head = m_head->value.load(std::memory_order_relaxed);
+  if (head - m_tail->value.load(std::memory_order_acquire) >= m_capacity) {
+    m_dropped->value.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  m_slots[head & (m_capacity - 1)] = (uint64_t(transition_id) << 32) | (value ? 1 : 0);
+  // Last: the record becomes visible to the consumer.
+  m_head->value.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+uint32_t InputRing::drain(const std::function<void(uint32_t, bool)> &apply) {
+  uint64_t tail = m_tail->value.load(std::memory_order_relaxed);
+  const uint64_t head = m_head->value.load(std::memory_order_acquire);
+  if (head - tail > m_capacity) {
+    // Overrun (Producer not checking the tail): the oldest records were overwritten.
+    m_dropped->value.fetch_add(head - tail - m_capacity, std::memory_order_relaxed);
+    tail = head - m_capacity;
+  }
+  for (uint64_t i = tail; i != head; i++) {
+    const uint64_t record = m_slots[i & (m_capacity - 1)];
+    apply(static_cast<uint32_t>(record >> 32), record & 1);
+  }
+  if (head != m_tail->value.load(std::memory_order_relaxed)) {
+    // The slots can be reused by the producer.
+    m_tail->value.store(head, std::memory_order_release);
+  }
+  return static_cast<uint32_t>(head - tail);
+}
+
+uint32_t InputRing::size() const {
+  return static_cast<uint32_t>(m_head->value.load(std::memory_order_acquire) -
+                               m_tail->value.load(std::memory_order_acquire));
+}
+
+uint32_t InputRing::capacity() const { return m_capacity; }
+
+uint64_t InputRing::droppedCount() const { return m_dropped->value.load(std::memory_order_relaxed); }
+
+const std::string &InputRing::path() const { return m_path; }
@@ -0,0 +1,78 @@
+#include "sfc/metrics/Metrics.hpp"
+
+uint32_t Metrics::nextShard() {
+  static std::atomic_uint32_t next_shard(0);
+  return next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS_COUNT;
+}
+
+uint64_t Metrics::value(Counter counter) const {
+  uint64_t sum = 0;
+  for (const auto &shard : m_shards) {
+    sum += shard.values[counter].load(std::memory_order_relaxed);
+  }
+  return sum;
+}
+
+void Metrics::reset() {
+  for (auto &shard : m_shards) {
+    for (auto &value : shard.values) {
+      value.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+const char *Metrics::name(Counter counter) {
+  switch (counter) {
+  case TRANSITIONS_EVALUATED:
+    return "sfc_transitions_evaluated_total";
+  case TRANSITIONS_FIRED:
+    return "sfc_transitions_fired_total";
+  case STEPS_ACTIVATED:
+    return "sfc_steps_activated_total";
+  case EMPTY_POLLS:
+    return "sfc_empty_polls_total";
+  case CALLBACKS:
+    return "sfc_callbacks_total";
+  case CALLBACKS_NANOSECONDS:
+    return "sfc_callbacks_nanoseconds_total";
+  case PREDICATES_SAMPLED:
+    return "sfc_predicates_sampled_total";
+  case WATCHDOG_VIOLATIONS:
+    return "sfc_watchdog_violations_total";
+  default:
+    return "sfc_unknown";
+  }
+}
+
+const char *Metrics::help(Counter counter) {
+  switch (counter) {
+  case TRANSITIONS_EVALUATED:
+    return "Receptivities read by the steps polling loops.";
+  case TRANSITIONS_FIRED:
+    return "Transitions crossed.";
+  case STEPS_ACTIVATED:
+    return "Steps activations.";
+  case EMPTY_POLLS:
+    return "Polling loops iterations which fired no transition.";
+  case CALLBACKS:
+    return "Step changed callbacks rounds.";
+  case CALLBACKS_NANOSECONDS:
+    return "Time spent in step changed callbacks.";
+  case PREDICATES_SAMPLED:
+    return "Transitions predicates evaluated by the engine.";
+  case WATCHDOG_VIOLATIONS:
+    return "Runaway loops and steps over their dwell limit.";
+  default:
+    return "";
+  }
+}
+
+std::vector<MetricSample> Metrics::samples(const std::string &labels) const {
+  std::vector<MetricSample> samples;
+  samples.reserve(COUNTERS_COUNT);
+  for (uint8_t i = 0; i < COUNTERS_COUNT; i++) {
+    auto counter = static_cast<Counter>(i);
+    samples.push_back({name(counter), help(counter), MetricSample::COUNTER, labels, static_cast<double>(value(counter))});
+  }
+  return samples;
+}
@@ -0,0 +1,138 @@
+#include "sfc/metrics/PrometheusExporter.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <poll.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+
+PrometheusExporter::PrometheusExporter() : m_serving(false) {}
+
+PrometheusExporter::~PrometheusExporter() { stopServing(); }
+
+void PrometheusExporter::addSource(Source source) {
+  std::lock_guard<std::mutex> _lock(m_sources_mutex);
+  m_sources.push_back(std::move(source));
+}
+
+std::string PrometheusExporter::format(const std::vector<MetricSample> &samples) {
+  std::vector<std::string> names;
+  std::unordered_map<std::string, std::vector<const MetricSample *>> families;
+  for (const auto &sample : samples) {
+    auto &family = families[sample.name];
+    if (family.empty()) {
+      names.push_back(sample.name);
+    }
+    family.push_back(&sample);
+  }
+  std::ostringstream out;
+  out.precision(17);
+  for (const auto &name : names) {
+    const auto &family = families[name];
+    out << "# HELP " << name << " " << family.front()->help << "\n";
+    out << "# TYPE " << name << " " << (family.front()->type == MetricSample::GAUGE ? "gauge" : "counter") << "\n";
+    for (const auto *sample : family) {
+      out << name;
+      if (!sample->labels.empty()) {
+        out << "{" << sample->labels << "}";
+      }
+      out << " " << sample->value << "\n";
+    }
+  }
+  return out.str();
+}
+
+std::string PrometheusExporter::text() const {
+  std::vector<MetricSample> samples;
+  {
+    std::lock_guard<std::mutex> _lock(m_sources_mutex);
+    for (const auto &source : m_sources) {
+      auto source_samples = source();
+      samples.insert(samples.end(), source_samples.begin(), source_samples.end());
+    }
+  }
+  return format(samples);
+}
+
+void PrometheusExporter::writeFile(const std::string &path) const {
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Cannot open metrics file: " + tmp_path);
+    }
+    file << text();
+    if (!file.flush()) {
+      throw std::runtime_error("Cannot write metrics file: " + tmp_path);
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Cannot rename metrics file: " + path);
+  }
+}
+
+void PrometheusExporter::serve(const std::string &socket_path) {
+  if (m_serving) {
+    throw std::runtime_error("Trying to serve metrics twice ! That's forbidden !");
+  }
+  sockaddr_un address{};
+  if (socket_path.size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Metrics socket path too long: " + socket_path);
+  }
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    throw std::runtime_error(std::string("Cannot create metrics socket (") + std::strerror(errno) + ") !");
+  }
+  ::unlink(socket_path.c_str());
+  if (::bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || ::listen(fd, 8) != 0) {
+    int err = errno;
+    ::close(fd);
+    throw std::runtime_error("Cannot listen on metrics socket: " + socket_path + " (" + std::strerror(err) + ") !");
+  }
+  m_socket = fd;
+  m_socket_path = socket_path;
+  m_serving = true;
+  m_server = std::thread(&PrometheusExporter::serverLoop, this);
+}
+
+void PrometheusExporter::serverLoop() {
+  pollfd listening{m_socket, POLLIN, 0};
+  while (m_serving) {
+    // Timeout: 'stopServing' is noticed without closing the socket under our feet.
+    if (::poll(&listening, 1, 50) <= 0) {
+      continue;
+    }
+    int client = ::accept4(m_socket, nullptr, nullptr, SOCK_CLOEXEC);
+    if (client < 0) {
+      continue;
+    }
+    const std::string body = text();
+    std::size_t sent = 0;
+    while (sent < body.size()) {
+      ssize_t n = ::send(client, body.data() + sent, body.size() - sent, MSG_NOSIGNAL);
+      if (n <= 0) {
+        break;
+      }
+      sent += n;
+    }
+    ::close(client);
+  }
+}
+
+void PrometheusExporter::stopServing() {
+  if (!m_serving.exchange(false)) {
+    return;
+  }
+  m_server.join();
+  ::close(m_socket);
+  m_socket = -1;
+  ::unlink(m_socket_path.c_str());
+}
@@ -0,0 +1,127 @@
+#include "sfc/persist/Journal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Journal::Journal(const std::string &path, uint32_t capacity)
+    : m_path(path), m_cursor(0), m_overflows(0), m_started(false) {
+  static_assert(sizeof(Header) + 2 * sizeof(std::atomic_uint32_t) <= HEADER_SIZE, "Journal header does not fit !");
+  m_fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (m_fd < 0) {
+    throw std::runtime_error("Cannot open journal file: " + path);
+  }
+  struct stat st;
+  Header header;
+  bool existing = ::fstat(m_fd, &st) == 0 && static_cast<std::size_t>(st.st_size) >= HEADER_SIZE &&
+                  ::pread(m_fd, &header, sizeof(header), 0) == sizeof(header) &&
+                  std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 && header.version == VERSION &&
+                  static_cast<std::size_t>(st.st_size) == HEADER_SIZE + 2 * std::size_t(header.capacity) * sizeof(Slot);
+  m_capacity = existing ? header.capacity : std::max<uint32_t>(capacity, 1);
+  m_map_size = HEADER_SIZE + 2 * std::size_t(m_capacity) * sizeof(Slot);
+  if (!existing && ::ftruncate(m_fd, 0) != 0) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot truncate journal file: " + path);
+  }
+  if (::ftruncate(m_fd, m_map_size) != 0) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot size journal file: " + path);
+  }
+  void *map = ::mmap(nullptr, m_map_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+  if (map == MAP_FAILED) {
+    ::close(m_fd);
+    throw std::runtime_error("Cannot map journal file: " + path);
+  }
+  m_map = static_cast<uint8_t *>(map);
+  if (!existing) {
+    Header *h = reinterpret_cast<Header *>(m_map);
+    std::memcpy(h->magic, MAGIC, sizeof(MAGIC));
+    h->version = VERSION;
+    h->capacity = m_capacity;
+    h->reserved = 0;
+    overflowMark(0)->store(0);
+    overflowMark(1)->store(0);
+  }
+  // Closed generation, after the last one found: nothing is appended before 'rotate'.
+  uint64_t last_generation = std::max(region(0)[0].generation.load(), region(1)[0].generation.load());
+  m_cursor = ((last_generation + 1) << 32) | m_capacity;
+}
+
+Journal::~Journal() {
+  if (m_map) {
+    ::munmap(m_map, m_map_size);
+  }
+  if (m_fd >= 0) {
+    ::close(m_fd);
+  }
+}
+
+Journal::Slot *Journal::region(uint64_t generation) const {
+  return reinterpret_cast<Slot *>(m_map + HEADER_SIZE) + (generation % 2) * m_capacity;
+}
+
+std::atomic_uint32_t *Journal::overflowMark(uint64_t generation) const {
+  return reinterpret_cast<std::atomic_uint32_t *>(m_map + sizeof(Header)) + generation % 2;
+}
+
+bool Journal::append(JournalEntry::Kind kind, unsigned int id, uint32_t value, std::chrono::nanoseconds time) {
+  const uint64_t cursor = m_cursor.fetch_add(1, std::memory_order_relaxed);
+  const uint32_t index = static_cast<uint32_t>(cursor);
+  if (index >= m_capacity) {
+    m_overflows.fetch_add(1, std::memory_order_relaxed);
+    if (m_started.load(std::memory_order_relaxed)) {
+      overflowMark(cursor >> 32)->store(static_cast<uint32_t>(cursor >> 32), std::memory_order_relaxed);
+    }
+    return false;
+  }
+  Slot &slot = region(cursor >> 32)[index];
+  slot.id = id;
+  slot.value = value;
+  slot.kind = kind;
+  slot.time = time.count();
+  // Last: the slot becomes an entry of this generation.
+  slot.generation.store(static_cast<uint32_t>(cursor >> 32), std::memory_order_release);
+  return true;
+}
+
+uint64_t Journal::rotate() {
+  std::lock_guard<std::mutex> _lock(m_rotate_mutex);
+  const uint64_t generation = (m_cursor.load() >> 32) + 1;
+  // Mark of the generation the region held before.
+  overflowMark(generation)->store(0);
+  // Reservations done before the exchange keep writing the previous generation, in its own region.
+  m_cursor.exchange(generation << 32);
+  m_started = true;
+  return generation;
+}
+
+void Journal::sync() { ::msync(m_map, m_map_size, MS_SYNC); }
+
+uint64_t Journal::generation() const { return m_cursor.load() >> 32; }
+
+uint32_t Journal::size() const { return std::min(static_cast<uint32_t>(m_cursor.load()), m_capacity); }
+
+uint32_t Journal::capacity() const { return m_capacity; }
+
+uint64_t Journal::overflowCount() const { return m_overflows.load(); }
+
+bool Journal::overflowed(uint64_t generation) const {
+  return generation != 0 && overflowMark(generation)->load() == static_cast<uint32_t>(generation);
+}
+
+std::vector<JournalEntry> Journal::entries(uint64_t generation, uint32_t offset) const {
+  std::vector<JournalEntry> result;
+  const Slot *slots = region(generation);
+  for (uint32_t i = offset; i < m_capacity; i++) {
+    if (slots[i].generation.load(std::memory_order_acquire) != static_cast<uint32_t>(generation)) {
+      break;
+    }
+    result.push_back({static_cast<JournalEntry::Kind>(slots[i].kind), slots[i].id, slots[i].value,
+                      std::chrono::nanoseconds(slots[i].time)});
+  }
+  return result;
+}
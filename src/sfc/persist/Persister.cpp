@@ -0,0 +1,106 @@
+#include "sfc/persist/Persister.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <sys/stat.h>
+
+Persister::Persister(const std::string &path, uint32_t capacity, std::chrono::milliseconds flush_period)
+    : m_snapshot_path(path + ".snap"), m_journal(path + ".wal", capacity), m_flush_period(flush_period),
+      m_checkpoint_requested(false), m_last_time(0), m_checkpoints(0) {
+  m_flusher = std::thread(&Persister::flusherLoop, this);
+}
+
+Persister::~Persister() {
+  {
+    std::lock_guard<std::mutex> _lock(m_flusher_mutex);
+    m_stopping = true;
+  }
+  m_flusher_cv.notify_all();
+  m_flusher.join();
+  m_journal.sync();
+}
+
+void Persister::flusherLoop() {
+  std::unique_lock<std::mutex> lock(m_flusher_mutex);
+  while (!m_stopping) {
+    m_flusher_cv.wait_for(lock, m_flush_period, [this]() { return m_stopping || m_checkpoint_requested.load(); });
+    lock.unlock();
+    m_journal.sync();
+    if (m_checkpoint_requested.exchange(false) || m_journal.size() >= m_journal.capacity() / 2) {
+      // Failures (Not attached, I/O) are retried at next period, the journal keeps going meanwhile.
+      try {
+        checkpoint();
+      } catch (const std::exception &) {
+      }
+    }
+    lock.lock();
+  }
+}
+
+Snapshot Persister::recover() const {
+  struct stat st;
+  if (::stat(m_snapshot_path.c_str(), &st) != 0) {
+    return Snapshot();
+  }
+  Snapshot snapshot = Snapshot::load(m_snapshot_path);
+  // A snapshot taken once its region was full covers the entries dropped before it.
+  if ((m_journal.overflowed(snapshot.generation) && snapshot.offset < m_journal.capacity()) ||
+      m_journal.overflowed(snapshot.generation + 1)) {
+    throw std::runtime_error("Trying to recover from a journal which overflowed after the last checkpoint !");
+  }
+  for (const auto &entry : m_journal.entries(snapshot.generation, snapshot.offset)) {
+    snapshot.apply(entry);
+  }
+  for (const auto &entry : m_journal.entries(snapshot.generation + 1)) {
+    snapshot.apply(entry);
+  }
+  return snapshot;
+}
+
+void Persister::checkpoint() {
+  std::lock_guard<std::mutex> _lock(m_checkpoint_mutex);
+  if (!m_source) {
+    throw std::runtime_error("Trying to checkpoint a persister which is not attached to a sequence !");
+  }
+  // Position first: every entry before it is already part of the state read next.
+  const uint64_t generation = m_journal.generation();
+  const uint32_t offset = m_journal.size();
+  Snapshot snapshot = m_source();
+  snapshot.generation = generation;
+  snapshot.offset = offset;
+  std::sort(snapshot.join_counters.begin(), snapshot.join_counters.end());
+  snapshot.save(m_snapshot_path);
+  // The previous region is only reused once this snapshot is on disk.
+  m_journal.rotate();
+  m_checkpoints++;
+}
+
+void Persister::flush() { m_journal.sync(); }
+
+void Persister::setSource(std::function<Snapshot()> source) {
+  std::lock_guard<std::mutex> _lock(m_checkpoint_mutex);
+  m_source = source;
+}
+
+void Persister::append(JournalEntry::Kind kind, unsigned int id, uint32_t value, std::chrono::nanoseconds time) {
+  m_last_time.store(time.count(), std::memory_order_relaxed);
+  if (!m_journal.append(kind, id, value, time) && !m_checkpoint_requested.exchange(true)) {
+    // Rare: once per checkpoint. Locked so that the flusher cannot miss it between its check and its wait.
+    { std::lock_guard<std::mutex> _lock(m_flusher_mutex); }
+    m_flusher_cv.notify_one();
+  }
+}
+
+void Persister::stepChanged(unsigned int step_id, bool state, std::chrono::nanoseconds time) {
+  append(JournalEntry::STEP, step_id, state, time);
+}
+
+void Persister::joinChanged(unsigned int step_id, uint32_t count, std::chrono::nanoseconds time) {
+  append(JournalEntry::JOIN, step_id, count, time);
+}
+
+std::chrono::nanoseconds Persister::lastTime() const { return std::chrono::nanoseconds(m_last_time.load()); }
+
+uint64_t Persister::checkpointsCount() const { return m_checkpoints.load(); }
+
+const Journal &Persister::journal() const { return m_journal; }
@@ -0,0 +1,121 @@
+#include "sfc/persist/Snapshot.hpp"
+#include "sfc/persist/Journal.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+void put(std::vector<uint8_t> &out, uint64_t value, int bytes) {
+  for (int i = 0; i < bytes; i++) {
+    out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+  }
+}
+
+uint64_t get(const uint8_t *&data, const uint8_t *end, int bytes) {
+  if (end - data < bytes) {
+    throw std::invalid_argument("Truncated snapshot !");
+  }
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++) {
+    value |= static_cast<uint64_t>(*data++) << (i * 8);
+  }
+  return value;
+}
+} // namespace
+
+bool Snapshot::empty() const { return fingerprint == 0; }
+
+void Snapshot::apply(const JournalEntry &entry) {
+  if (entry.kind == JournalEntry::STEP) {
+    auto it = std::lower_bound(active_steps.begin(), active_steps.end(), entry.id);
+    bool found = (it != active_steps.end() && *it == entry.id);
+    if (entry.value && !found) {
+      active_steps.insert(it, entry.id);
+    } else if (!entry.value && found) {
+      active_steps.erase(it);
+    }
+  } else {
+    auto it = std::find_if(join_counters.begin(), join_counters.end(), [&entry](const auto &p) { return p.first == entry.id; });
+    if (it != join_counters.end()) {
+      it->second = entry.value;
+    } else {
+      join_counters.emplace_back(entry.id, entry.value);
+    }
+    join_counters.erase(
+        std::remove_if(join_counters.begin(), join_counters.end(), [](const auto &p) { return p.second == 0; }),
+        join_counters.end());
+  }
+  time = std::max(time, entry.time);
+}
+
+std::vector<uint8_t> Snapshot::encode() const {
+  std::vector<uint8_t> out(MAGIC, MAGIC + sizeof(MAGIC));
+  out.push_back(VERSION);
+  put(out, fingerprint, 8);
+  put(out, generation, 8);
+  put(out, offset, 4);
+  put(out, time.count(), 8);
+  put(out, active_steps.size(), 4);
+  for (auto id : active_steps) {
+    put(out, id, 4);
+  }
+  put(out, join_counters.size(), 4);
+  for (const auto &p : join_counters) {
+    put(out, p.first, 4);
+    put(out, p.second, 4);
+  }
+  return out;
+}
+
+Snapshot Snapshot::decode(const uint8_t *data, std::size_t size) {
+  const uint8_t *end = data + size;
+  if (size < sizeof(MAGIC) + 1 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[sizeof(MAGIC)] != VERSION) {
+    throw std::invalid_argument("Not a sequence snapshot (Unknown header) !");
+  }
+  data += sizeof(MAGIC) + 1;
+  Snapshot snapshot;
+  snapshot.fingerprint = get(data, end, 8);
+  snapshot.generation = get(data, end, 8);
+  snapshot.offset = get(data, end, 4);
+  snapshot.time = std::chrono::nanoseconds(static_cast<int64_t>(get(data, end, 8)));
+  uint64_t count = get(data, end, 4);
+  for (uint64_t i = 0; i < count; i++) {
+    snapshot.active_steps.push_back(get(data, end, 4));
+  }
+  count = get(data, end, 4);
+  for (uint64_t i = 0; i < count; i++) {
+    unsigned int id = get(data, end, 4);
+    snapshot.join_counters.emplace_back(id, get(data, end, 4));
+  }
+  return snapshot;
+}
+
+void Snapshot::save(const std::string &path) const {
+  const std::string tmp_path = path + ".tmp";
+  auto data = encode();
+  int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open snapshot file: " + tmp_path);
+  }
+  bool ok = ::write(fd, data.data(), data.size()) == static_cast<ssize_t>(data.size()) && ::fsync(fd) == 0;
+  ::close(fd);
+  // The rename is atomic: a crash leaves either the previous snapshot, or this one.
+  if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Cannot write snapshot file: " + path);
+  }
+}
+
+Snapshot Snapshot::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Cannot open snapshot file: " + path);
+  }
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return decode(data.data(), data.size());
+}
@@ -0,0 +1,127 @@
+#include "sfc/profile/Profile.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+void Profile::merge(const Profile &other, bool strict) {
+  for (const auto &p : other.transitions) {
+    auto it = transitions.find(p.first);
+    if (it == transitions.end()) {
+      transitions.emplace(p);
+      continue;
+    }
+    if (it->second.nexts != p.second.nexts) {
+      if (strict) {
+        throw std::invalid_argument("Trying to merge profiles of different charts !");
+      }
+      it->second = p.second;
+      continue;
+    }
+    it->second.evaluations += p.second.evaluations;
+    it->second.fired += p.second.fired;
+  }
+  for (const auto &p : other.activations) {
+    activations[p.first] += p.second;
+  }
+  runs += other.runs;
+}
+
+std::vector<Profile::TransitionKey> Profile::neverFired() const {
+  std::vector<TransitionKey> keys;
+  for (const auto &p : transitions) {
+    auto it = activations.find(p.first.first);
+    if (p.second.fired == 0 && it != activations.end() && it->second > 0) {
+      keys.push_back(p.first);
+    }
+  }
+  return keys;
+}
+
+std::string Profile::encode() const {
+  std::ostringstream out;
+  out << "sfc-profile 1\n";
+  out << "runs " << runs << "\n";
+  for (const auto &p : activations) {
+    out << "step " << p.first << " " << p.second << "\n";
+  }
+  for (const auto &p : transitions) {
+    out << "transition " << p.first.first << " " << p.first.second << " " << p.second.evaluations << " " << p.second.fired
+        << " ";
+    for (std::size_t i = 0; i < p.second.nexts.size(); i++) {
+      out << (i ? "," : "") << p.second.nexts[i];
+    }
+    out << "\n";
+  }
+  return out.str();
+}
+
+Profile Profile::decode(const std::string &text) {
+  std::istringstream in(text);
+  std::string line;
+  if (!std::getline(in, line) || line != "sfc-profile 1") {
+    throw std::invalid_argument("Not a sequence profile (Unknown header) !");
+  }
+  Profile profile;
+  while (std::getline(in, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    std::istringstream record(line);
+    std::string kind;
+    record >> kind;
+    if (kind == "runs") {
+      record >> profile.runs;
+    } else if (kind == "step") {
+      unsigned int id;
+      uint64_t count;
+      record >> id >> count;
+      profile.activations[id] = count;
+    } else if (kind == "transition") {
+      TransitionKey key;
+      TransitionCounts counts;
+      std::string nexts;
+      record >> key.first >> key.second >> counts.evaluations >> counts.fired >> nexts;
+      std::istringstream ids(nexts);
+      std::string id;
+      while (!record.fail() && std::getline(ids, id, ',')) {
+        counts.nexts.push_back(std::stoul(id));
+      }
+      profile.transitions[key] = counts;
+    } else {
+      throw std::invalid_argument("Corrupted sequence profile (Unknown record '" + kind + "') !");
+    }
+    if (record.fail()) {
+      throw std::invalid_argument("Corrupted sequence profile (Bad record '" + line + "') !");
+    }
+  }
+  return profile;
+}
+
+void Profile::save(const std::string &path) const {
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream file(tmp_path, std::ios::trunc);
+    if (!file) {
+      throw std::runtime_error("Cannot open profile file: " + tmp_path);
+    }
+    file << encode();
+    if (!file.flush()) {
+      throw std::runtime_error("Cannot write profile file: " + tmp_path);
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    throw std::runtime_error("Cannot rename profile file: " + path);
+  }
+}
+
+Profile Profile::load(const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Cannot open profile file: " + path);
+  }
+  std::stringstream text;
+  text << file.rdbuf();
+  return decode(text.str());
+}
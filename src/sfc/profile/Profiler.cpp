@@ -0,0 +1,91 @@
+#include "sfc/profile/Profiler.hpp"
+#include "sfc/step/Step.hpp"
+#include "sfc/transition/Transition.hpp"
+
+#include <algorithm>
+
+ProfileCounters::ProfileCounters(std::shared_ptr<const CompiledChart> chart) : m_chart(std::move(chart)) {
+  m_slots_begin.reserve(m_chart->stepsCount() + 1);
+  uint32_t slots = 0;
+  for (uint32_t i = 0; i < m_chart->stepsCount(); i++) {
+    m_slots_begin.push_back(slots);
+    slots += m_chart->nextTransitions(i).size();
+  }
+  m_slots_begin.push_back(slots);
+  const uint32_t counters_count = m_chart->stepsCount() + 2 * slots;
+  m_lines_per_shard = std::max<uint32_t>((counters_count + 7) / 8, 1);
+  m_lines.reset(new Line[SHARDS_COUNT * m_lines_per_shard]);
+}
+
+const std::shared_ptr<const CompiledChart> &ProfileCounters::chart() const { return m_chart; }
+
+uint64_t ProfileCounters::sum(uint32_t index) const {
+  uint64_t value = 0;
+  for (uint32_t shard = 0; shard < SHARDS_COUNT; shard++) {
+    value += m_lines[shard * m_lines_per_shard + index / 8].values[index % 8].load(std::memory_order_relaxed);
+  }
+  return value;
+}
+
+void ProfileCounters::addTo(Profile &profile) const {
+  const uint32_t steps_count = m_chart->stepsCount();
+  const uint32_t slots = m_slots_begin.back();
+  Profile chart_profile;
+  for (uint32_t i = 0; i < steps_count; i++) {
+    const unsigned int step_id = m_chart->step(i).step->getStepId();
+    chart_profile.activations[step_id] = sum(i);
+    uint32_t rank = 0;
+    for (auto t : m_chart->nextTransitions(i)) {
+      auto &counts = chart_profile.transitions[{step_id, rank}];
+      counts.evaluations = sum(steps_count + m_slots_begin[i] + rank);
+      counts.fired = sum(steps_count + slots + m_slots_begin[i] + rank);
+      for (auto next : m_chart->nexts(t)) {
+        counts.nexts.push_back(m_chart->step(next).step->getStepId());
+      }
+      rank++;
+    }
+  }
+  // Charts changed while running: a rank given to another transition restarts its counts.
+  profile.merge(chart_profile, false);
+}
+
+std::shared_ptr<ProfileCounters> Profiler::counters(const std::shared_ptr<const CompiledChart> &chart) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  for (const auto &counters : m_counters) {
+    if (counters->chart() == chart) {
+      return counters;
+    }
+  }
+  m_counters.push_back(std::make_shared<ProfileCounters>(chart));
+  return m_counters.back();
+}
+
+void Profiler::runStarted() {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  m_runs++;
+}
+
+Profile Profiler::profile() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  Profile profile = m_base;
+  profile.runs += m_runs;
+  for (const auto &counters : m_counters) {
+    counters->addTo(profile);
+  }
+  return profile;
+}
+
+void Profiler::load(const std::string &path) {
+  Profile loaded = Profile::load(path);
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  m_base.merge(loaded);
+}
+
+void Profiler::save(const std::string &path) const { profile().save(path); }
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  m_counters.clear();
+  m_base = Profile();
+  m_runs = 0;
+}
@@ -0,0 +1,74 @@
+#include "sfc/record/Recorder.hpp"
+
+#include <stdexcept>
+
+Recorder::Recorder() : m_clock(std::make_shared<SteadyClock>()), m_last_time(0) {
+  m_buffer.reserve(FLUSH_THRESHOLD);
+  Recording::encodeHeader(m_buffer);
+}
+
+Recorder::Recorder(const std::string &path) : Recorder() {
+  m_path = path;
+  m_file.open(path, std::ios::binary | std::ios::trunc);
+  if (!m_file) {
+    throw std::runtime_error("Cannot open recording file: " + path);
+  }
+}
+
+Recorder::~Recorder() { flush(); }
+
+void Recorder::append(RecordedEvent::Kind kind, uint32_t id, bool state) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  // Time is taken under the lock, so that recorded times are ordered like recorded events.
+  RecordedEvent event{kind, state, id, m_clock->now()};
+  Recording::encode(m_buffer, event, m_last_time);
+  m_last_time = event.time;
+  m_events_count++;
+  if (m_file.is_open() && m_buffer.size() >= FLUSH_THRESHOLD) {
+    writeBuffer();
+  }
+}
+
+void Recorder::writeBuffer() {
+  m_file.write(reinterpret_cast<const char *>(m_buffer.data()), m_buffer.size());
+  m_written_bytes += m_buffer.size();
+  m_buffer.clear();
+}
+
+void Recorder::receptivityChanged(uint32_t transition_id, bool state) {
+  append(RecordedEvent::RECEPTIVITY, transition_id, state);
+}
+
+void Recorder::stepChanged(unsigned int step_id, bool state) { append(RecordedEvent::STEP, step_id, state); }
+
+void Recorder::setClock(std::shared_ptr<Clock> clock) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  m_clock = clock;
+}
+
+void Recorder::flush() {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  if (m_file.is_open()) {
+    writeBuffer();
+    m_file.flush();
+  }
+}
+
+uint64_t Recorder::eventsCount() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return m_events_count;
+}
+
+uint64_t Recorder::bytesCount() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return m_written_bytes + m_buffer.size();
+}
+
+Recording Recorder::recording() {
+  if (m_file.is_open()) {
+    flush();
+    return Recording::load(m_path);
+  }
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return Recording::decode(m_buffer.data(), m_buffer.size());
+}
@@ -0,0 +1,103 @@
+#include "sfc/record/Recording.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+constexpr char Recording::MAGIC[4];
+
+namespace {
+void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<uint8_t>(value) | 0x80);
+    value >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(value));
+}
+
+bool getVarint(const uint8_t *&data, const uint8_t *end, uint64_t &value) {
+  value = 0;
+  for (unsigned shift = 0; data < end && shift < 64; shift += 7) {
+    uint8_t byte = *data++;
+    value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+Recording::Recording(std::vector<RecordedEvent> events) : m_events(std::move(events)) {}
+
+void Recording::encodeHeader(std::vector<uint8_t> &out) {
+  out.insert(out.end(), std::begin(MAGIC), std::end(MAGIC));
+  out.push_back(VERSION);
+}
+
+void Recording::encode(std::vector<uint8_t> &out, const RecordedEvent &event, std::chrono::nanoseconds previous_time) {
+  int64_t delta = (event.time - previous_time).count();
+  out.push_back(static_cast<uint8_t>(event.state) | static_cast<uint8_t>(event.kind << 1));
+  putVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+  putVarint(out, event.id);
+}
+
+Recording Recording::decode(const uint8_t *data, std::size_t size) {
+  if (size < HEADER_SIZE || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 || data[sizeof(MAGIC)] != VERSION) {
+    throw std::invalid_argument("Trying to decode an unknown recording format !");
+  }
+  const uint8_t *end = data + size;
+  data += HEADER_SIZE;
+  std::vector<RecordedEvent> events;
+  // Three bytes per event is the common case.
+  events.reserve((size - HEADER_SIZE) / 3);
+  int64_t time = 0;
+  while (data < end) {
+    uint8_t tag = *data++;
+    uint64_t delta, id;
+    if (!getVarint(data, end, delta) || !getVarint(data, end, id)) {
+      break;
+    }
+    time += static_cast<int64_t>((delta >> 1) ^ (~(delta & 1) + 1));
+    events.push_back({static_cast<RecordedEvent::Kind>((tag >> 1) & 1), static_cast<bool>(tag & 1), static_cast<uint32_t>(id),
+                      std::chrono::nanoseconds(time)});
+  }
+  return Recording(std::move(events));
+}
+
+Recording Recording::load(const std::string &path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    throw std::runtime_error("Cannot open recording file: " + path);
+  }
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return decode(data.data(), data.size());
+}
+
+const std::vector<RecordedEvent> &Recording::events() const { return m_events; }
+
+std::vector<RecordedEvent> Recording::inputs() const {
+  std::vector<RecordedEvent> inputs;
+  std::copy_if(m_events.begin(), m_events.end(), std::back_inserter(inputs),
+               [](const auto &e) { return e.kind == RecordedEvent::RECEPTIVITY; });
+  return inputs;
+}
+
+std::vector<RecordedEvent> Recording::trace() const {
+  std::vector<RecordedEvent> trace;
+  std::copy_if(m_events.begin(), m_events.end(), std::back_inserter(trace),
+               [](const auto &e) { return e.kind == RecordedEvent::STEP; });
+  return trace;
+}
+
+std::size_t Recording::firstDivergence(const std::vector<RecordedEvent> &a, const std::vector<RecordedEvent> &b) {
+  std::size_t count = std::min(a.size(), b.size());
+  for (std::size_t i = 0; i < count; i++) {
+    if (a[i].kind != b[i].kind || a[i].id != b[i].id || a[i].state != b[i].state) {
+      return i;
+    }
+  }
+  return (a.size() == b.size()) ? NPOS : count;
+}
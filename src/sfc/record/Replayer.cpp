@@ -0,0 +1,66 @@
+#include "sfc/record/Replayer.hpp"
+#include "sfc/Sequence.hpp"
+#include "sfc/Simulation.hpp"
+#include "sfc/transition/Transition.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+Transition &transitionOf(const CompiledChart &chart, uint32_t id) {
+  if (id >= chart.transitionsCount()) {
+    throw std::out_of_range("Trying to replay an input of an unknown transition !");
+  }
+  return *chart.transition(id).transition;
+}
+} // namespace
+
+Replayer::Replayer(const Recording &recording)
+    : m_inputs(recording.inputs()), m_origin(0), m_end(0) {
+  if (!recording.events().empty()) {
+    m_origin = recording.events().front().time;
+    m_end = recording.events().back().time;
+  }
+}
+
+uint64_t Replayer::replay(Simulation &sim) {
+  auto chart = sim.getCompiledChart();
+  if (!chart) {
+    throw std::runtime_error("Trying to replay into a never started simulation !");
+  }
+  const auto start = sim.now();
+  uint64_t count = 0;
+  for (const auto &input : m_inputs) {
+    auto at = start + (input.time - m_origin);
+    if (at > sim.now()) {
+      sim.advance(at - sim.now());
+    }
+    transitionOf(*chart, input.id).setReceptivityState(input.state);
+    count++;
+  }
+  auto end = start + (m_end - m_origin);
+  // At least one more polling period, for the last input to be seen.
+  sim.advance(std::max(end - sim.now(), std::chrono::nanoseconds(std::chrono::microseconds(1))));
+  return count;
+}
+
+uint64_t Replayer::replay(Sequence &seq, const std::atomic_bool *cancel) {
+  auto chart = seq.getCompiledChart();
+  if (!chart) {
+    throw std::runtime_error("Trying to replay into a sequence without compiled chart !");
+  }
+  const auto start = std::chrono::steady_clock::now();
+  uint64_t count = 0;
+  for (const auto &input : m_inputs) {
+    if (cancel && *cancel) {
+      break;
+    }
+    std::this_thread::sleep_until(start + (input.time - m_origin));
+    transitionOf(*chart, input.id).setReceptivityState(input.state);
+    count++;
+  }
+  return count;
+}
+
+const std::vector<RecordedEvent> &Replayer::inputs() const { return m_inputs; }
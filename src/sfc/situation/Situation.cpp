@@ -0,0 +1,268 @@
+#include "sfc/situation/Situation.hpp"
+#include "sfc/situation/SituationPublisher.hpp"
+#include "sfc/step/Step.hpp"
+#include "sfc/transition/Transition.hpp"
+
+#include <thread>
+
+namespace {
+bool testBit(const std::vector<uint64_t> &words, uint32_t index) {
+  return index / 64 < words.size() && (words[index / 64] >> (index % 64)) & 1;
+}
+} // namespace
+
+bool Situation::isActivated(unsigned int id) const {
+  return chart && testBit(steps, chart->stepIndex(id));
+}
+
+bool Situation::getReceptivityState(const Transition *transition) const {
+  return chart && testBit(receptivities, chart->transitionIndex(transition));
+}
+
+bool Situation::hasCrossableTransition() const {
+  if (!chart) {
+    return false;
+  }
+  for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+    if (!testBit(steps, i)) {
+      continue;
+    }
+    for (auto t : chart->nextTransitions(i)) {
+      if (testBit(receptivities, t)) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+std::vector<unsigned int> Situation::getActivatedSteps() const {
+  std::vector<unsigned int> ids;
+  if (!chart) {
+    return ids;
+  }
+  // Steps indexes are sorted by id.
+  for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+    if (testBit(steps, i)) {
+      ids.push_back(chart->step(i).step->getStepId());
+    }
+  }
+  return ids;
+}
+
+class SituationPublisher::Access {
+private:
+  const SituationPublisher &m_publisher;
+  uint32_t m_grace;
+
+public:
+  explicit Access(const SituationPublisher &publisher) : m_publisher(publisher), m_grace(publisher.m_grace.load()) {
+    // Loaded once counted: a state replaced meanwhile is not freed before this use is over.
+    m_publisher.m_users[m_grace].fetch_add(1);
+  }
+  ~Access() { m_publisher.m_users[m_grace].fetch_sub(1); }
+
+  State *state() const { return m_publisher.m_state.load(); }
+};
+
+SituationPublisher::SituationPublisher()
+    : m_state(nullptr), m_users{{0}, {0}}, m_grace(0), m_writers(0), m_epoch(0), m_published(0), m_readers{{0}, {0}, {0}},
+      m_publish_requests(0), m_forward(nullptr) {}
+
+SituationPublisher::~SituationPublisher() { delete m_state.load(); }
+
+void SituationPublisher::setBit(std::atomic_uint64_t *words, uint32_t index, bool state) {
+  const uint64_t mask = uint64_t(1) << (index % 64);
+  if (state) {
+    words[index / 64].fetch_or(mask);
+  } else {
+    words[index / 64].fetch_and(~mask);
+  }
+}
+
+void SituationPublisher::synchronize() {
+  // Twice: a user can have loaded the grace period just before it was flipped.
+  for (int i = 0; i < 2; i++) {
+    const uint32_t grace = m_grace.load();
+    m_grace.store(grace ^ 1);
+    while (m_users[grace].load() != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void SituationPublisher::reset(std::shared_ptr<const CompiledChart> chart) {
+  std::lock_guard<std::mutex> _lock(m_reset_mutex);
+  auto state = std::make_unique<State>();
+  state->chart = chart;
+  state->steps_words = (chart->stepsCount() + 63) / 64;
+  state->receptivities_words = (chart->transitionsCount() + 63) / 64;
+  state->steps = std::make_unique<std::atomic_uint64_t[]>(state->steps_words);
+  state->receptivities = std::make_unique<std::atomic_uint64_t[]>(state->receptivities_words);
+  for (std::size_t i = 0; i < state->steps_words; i++) {
+    state->steps[i] = 0;
+  }
+  for (std::size_t i = 0; i < state->receptivities_words; i++) {
+    state->receptivities[i] = 0;
+  }
+  beginWrite();
+  State *current = state.release();
+  std::unique_ptr<State> previous(m_state.exchange(current));
+  // Read once the new state is published: changes still going to the previous one are caught up.
+  // Read again after being set, so that a change published between the read and the set is not overwritten.
+  for (uint32_t i = 0; i < chart->stepsCount(); i++) {
+    bool activated;
+    do {
+      activated = chart->step(i).step->isActivated();
+      setBit(current->steps.get(), i, activated);
+    } while (chart->step(i).step->isActivated() != activated);
+  }
+  for (uint32_t i = 0; i < chart->transitionsCount(); i++) {
+    bool receptive;
+    do {
+      receptive = chart->transition(i).transition->getReceptivityState();
+      setBit(current->receptivities.get(), i, receptive);
+    } while (chart->transition(i).transition->getReceptivityState() != receptive);
+  }
+  endWrite();
+  if (previous) {
+    synchronize();
+  }
+}
+
+void SituationPublisher::beginWrite() { m_writers.fetch_add(1); }
+
+void SituationPublisher::endWrite() {
+  m_epoch.fetch_add(1);
+  if (m_writers.fetch_sub(1) == 1) {
+    publish();
+  }
+}
+
+void SituationPublisher::publish() {
+  uint32_t requests = m_publish_requests.fetch_add(1) + 1;
+  if (requests != 1) {
+    // Being published: the publishing writer copies again for this request.
+    return;
+  }
+  do {
+    if (publishSnapshot()) {
+      m_changes.bump();
+    }
+    requests = m_publish_requests.fetch_sub(requests) - requests;
+  } while (requests != 0);
+}
+
+bool SituationPublisher::publishSnapshot() {
+  const uint64_t epoch = m_epoch.load();
+  if (m_writers.load() != 0) {
+    return false;
+  }
+  const uint64_t published = m_published.load() & SNAPSHOT_MASK;
+  uint64_t spare = (published + 1) % SNAPSHOTS;
+  // Only the published snapshot is taken by new readers: a spare one is left by its last readers for good.
+  while (m_readers[spare].load() != 0) {
+    spare = (spare + 1) % SNAPSHOTS;
+    if (spare == published) {
+      spare = (spare + 1) % SNAPSHOTS;
+      std::this_thread::yield();
+    }
+  }
+  Snapshot &snapshot = m_snapshots[spare];
+  {
+    Access access(*this);
+    const State *current = access.state();
+    if (!current) {
+      return false;
+    }
+    if (snapshot.chart != current->chart) {
+      snapshot.chart = current->chart;
+    }
+    snapshot.steps.resize(current->steps_words);
+    for (std::size_t i = 0; i < current->steps_words; i++) {
+      snapshot.steps[i] = current->steps[i].load();
+    }
+    snapshot.receptivities.resize(current->receptivities_words);
+    for (std::size_t i = 0; i < current->receptivities_words; i++) {
+      snapshot.receptivities[i] = current->receptivities[i].load();
+    }
+  }
+  snapshot.epoch = epoch;
+  if (m_writers.load() != 0 || m_epoch.load() != epoch) {
+    // Torn: a section was opened meanwhile, its close publishes.
+    return false;
+  }
+  const uint64_t replaced = m_published.exchange(spare);
+  m_readers[replaced & SNAPSHOT_MASK].fetch_add(static_cast<int64_t>(replaced / SNAPSHOT_READER));
+  return true;
+}
+
+void SituationPublisher::publishStep(unsigned int id, bool state) {
+  Access access(*this);
+  State *current = access.state();
+  uint32_t index = current ? current->chart->stepIndex(id) : CompiledChart::NONE;
+  if (index == CompiledChart::NONE) {
+    return;
+  }
+  beginWrite();
+  setBit(current->steps.get(), index, state);
+  endWrite();
+}
+
+void SituationPublisher::receptivityChanged(uint32_t transition_id, bool state) {
+  {
+    Access access(*this);
+    State *current = access.state();
+    if (current && transition_id < current->chart->transitionsCount()) {
+      beginWrite();
+      setBit(current->receptivities.get(), transition_id, state);
+      endWrite();
+    }
+  }
+  if (ReceptivityObserver *forward = m_forward.load()) {
+    forward->receptivityChanged(transition_id, state);
+  }
+}
+
+void SituationPublisher::setForward(ReceptivityObserver *observer) { m_forward = observer; }
+
+bool SituationPublisher::tryRead(Situation &situation) const {
+  // Counted as a reader of the published snapshot in the same step: it is not rewritten until we are done.
+  const uint64_t index = m_published.fetch_add(SNAPSHOT_READER) & SNAPSHOT_MASK;
+  const Snapshot &snapshot = m_snapshots[index];
+  situation.epoch = snapshot.epoch;
+  if (situation.chart != snapshot.chart) {
+    situation.chart = snapshot.chart;
+  }
+  situation.steps.assign(snapshot.steps.begin(), snapshot.steps.end());
+  situation.receptivities.assign(snapshot.receptivities.begin(), snapshot.receptivities.end());
+  m_readers[index].fetch_sub(1);
+  return true;
+}
+
+Situation SituationPublisher::read() const {
+  Situation situation;
+  tryRead(situation);
+  return situation;
+}
+
+void SituationPublisher::awaitChart(const std::shared_ptr<const CompiledChart> &chart) const {
+  Situation situation;
+  while (true) {
+    // Generation first: a publication after the read wakes us up.
+    const uint32_t generation = m_changes.load();
+    tryRead(situation);
+    if (situation.chart == chart) {
+      return;
+    }
+    m_changes.wait(generation, std::chrono::milliseconds(1));
+  }
+}
+
+uint64_t SituationPublisher::epoch() const { return m_epoch.load(); }
+
+uint32_t SituationPublisher::generation() const { return m_changes.load(); }
+
+bool SituationPublisher::waitChange(uint32_t generation, std::chrono::nanoseconds timeout) const {
+  return m_changes.wait(generation, timeout);
+}
@@ -0,0 +1,30 @@
+#include "sfc/step/Enclosing.hpp"
+
+#include <stdexcept>
+
+Enclosing::Enclosing(unsigned int step_id, std::vector<std::shared_ptr<StepAction>> m_actions)
+    : Step(step_id, ENCLOSING_STEP, m_actions) {}
+
+void Enclosing::addStep(std::shared_ptr<Step> step, bool activation) {
+  std::lock_guard<std::mutex> _lock(steps_mutex);
+  if (!step) {
+    throw std::invalid_argument("Trying to add a nullptr Step !");
+  } else if (step->isInitialStep()) {
+    throw std::invalid_argument("Trying to enclose an init-step ! That's forbidden !");
+  } else if (activation && step->isMacroStep()) {
+    throw std::invalid_argument("Trying to use a macro as activation step ! That's forbidden !");
+  }
+  m_enclosed_steps[step->getStepId()] = step;
+  if (activation) {
+    m_activation_steps.push_back(step);
+  }
+}
+
+bool Enclosing::containsStep(unsigned int id) const {
+  std::lock_guard<std::mutex> _lock(steps_mutex);
+  return m_enclosed_steps.count(id);
+}
+
+const std::unordered_map<unsigned int, std::shared_ptr<Step>> &Enclosing::steps() const { return m_enclosed_steps; }
+
+const std::vector<std::shared_ptr<Step>> &Enclosing::activationSteps() const { return m_activation_steps; }
@@ -1,4 +1,5 @@
 #include "sfc/step/Macro.hpp"
+#include "sfc/transition/Transition.hpp"
 
 #include <algorithm>
 #include <stdexcept>
@@ -29,6 +30,69 @@ std::shared_ptr<Step> Macro::last() { return m_last; }
 
 const std::unordered_map<unsigned int, std::shared_ptr<Step>> &Macro::steps() const { return m_macro_steps; }
 
+std::shared_ptr<Macro> Macro::instantiate(unsigned int step_id, unsigned int id_offset) const {
+  std::lock_guard<std::mutex> _lock(steps_mutex);
+  if (!m_first) {
+    throw std::invalid_argument("Trying to instantiate an empty macro !");
+  }
+  auto instance = std::make_shared<Macro>(step_id, m_actions);
+  std::unordered_map<const Step *, std::shared_ptr<Step>> steps;
+  std::vector<unsigned int> ids;
+  for (const auto &p : m_macro_steps) {
+    if (p.second->isMacroStep()) {
+      throw std::invalid_argument("Trying to instantiate a macro containing a macro ! That's forbidden !");
+    }
+    steps[p.second.get()] = std::make_shared<Step>(p.first + id_offset, p.second->type(), p.second->getActions());
+    ids.push_back(p.first);
+  }
+  // First and last steps keep their role.
+  std::sort(ids.begin(), ids.end());
+  instance->addStep(steps.at(m_first.get()));
+  for (auto id : ids) {
+    if (id != m_first->getStepId() && id != m_last->getStepId()) {
+      instance->addStep(steps.at(m_macro_steps.at(id).get()));
+    }
+  }
+  if (m_last != m_first) {
+    instance->addStep(steps.at(m_last.get()));
+  }
+
+  auto remap = [&steps](const std::vector<std::weak_ptr<Step>> &definition_steps) {
+    std::vector<std::weak_ptr<Step>> remapped;
+    for (const auto &step : definition_steps) {
+      auto it = steps.find(step.lock().get());
+      if (it == steps.end()) {
+        throw std::invalid_argument("Trying to instantiate a macro whose inner transition leaves it !");
+      }
+      remapped.push_back(it->second);
+    }
+    return remapped;
+  };
+  for (auto id : ids) {
+    const auto &definition_step = m_macro_steps.at(id);
+    for (const auto &t : definition_step->getNextTransitions()) {
+      if (std::find(m_next_transitions.begin(), m_next_transitions.end(), t) != m_next_transitions.end()) {
+        // Exit transition.
+        continue;
+      }
+      auto &instance_transition = instance->m_instance_transitions[t.get()];
+      if (!instance_transition) {
+        instance_transition = std::make_shared<Transition>(remap(t->nexts()), remap(t->validations()), t->getValidationMode());
+        // Shared like the actions: the predicate reads the same condition for every instance.
+        instance_transition->setPredicate(t->getPredicate(), t->getSamplingPeriod());
+      }
+      steps.at(definition_step.get())->addTransition(instance_transition);
+    }
+  }
+  return instance;
+}
+
+std::shared_ptr<Transition> Macro::transition(const std::shared_ptr<Transition> &definition_transition) const {
+  std::lock_guard<std::mutex> _lock(steps_mutex);
+  auto it = m_instance_transitions.find(definition_transition.get());
+  return (it != m_instance_transitions.end()) ? it->second : nullptr;
+}
+
 bool Macro::isActivated() const {
   return std::any_of(m_macro_steps.begin(), m_macro_steps.end(), [](auto s) { return s.second->isActivated(); });
 }
@@ -37,3 +101,8 @@ void Macro::addTransition(std::shared_ptr<Transition> t) {
   Step::addTransition(t);
   m_last->addTransition(t);
 }
+
+bool Macro::removeTransition(const std::shared_ptr<Transition> &t) {
+  m_last->removeTransition(t);
+  return Step::removeTransition(t);
+}
@@ -1,10 +1,11 @@
 #include "sfc/step/Step.hpp"
 #include "sfc/step/action/StepAction.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 Step::Step(unsigned int step_id, StepType step_type, std::vector<std::shared_ptr<StepAction>> actions)
-    : m_step_id(step_id), m_step_type(step_type), m_activated(false), m_actions(actions) {}
+    : m_step_id(step_id), m_step_type(step_type), m_activated(false), m_activations(0), m_actions(actions) {}
 
 unsigned int Step::getStepId() const { return m_step_id; }
 
@@ -12,9 +13,14 @@ bool Step::isInitialStep() const { return m_step_type == Step::INIT_STEP; }
 
 bool Step::isMacroStep() const { return m_step_type == Step::MACRO_STEP; }
 
+bool Step::isEnclosingStep() const { return m_step_type == Step::ENCLOSING_STEP; }
+
 bool Step::isActivated() const { return m_activated; }
 
 void Step::setActivated(bool activated) {
+  if (activated) {
+    m_activations++;
+  }
   m_activated = activated;
 #ifdef DEBUG_MODE
   if (activated) {
@@ -23,6 +29,8 @@ void Step::setActivated(bool activated) {
 #endif
 }
 
+uint32_t Step::activationsCount() const { return m_activations; }
+
 Step::StepType Step::type() const { return m_step_type; }
 
 void Step::addStepAction(std::shared_ptr<StepAction> a) { m_actions.push_back(std::move(a)); }
@@ -31,4 +39,13 @@ const std::vector<std::shared_ptr<StepAction>> &Step::getActions() const { retur
 
 void Step::addTransition(std::shared_ptr<Transition> t) { m_next_transitions.push_back(t); }
 
+bool Step::removeTransition(const std::shared_ptr<Transition> &t) {
+  auto it = std::find(m_next_transitions.begin(), m_next_transitions.end(), t);
+  if (it == m_next_transitions.end()) {
+    return false;
+  }
+  m_next_transitions.erase(it);
+  return true;
+}
+
 const std::vector<std::shared_ptr<Transition>> &Step::getNextTransitions() const { return m_next_transitions; }
\ No newline at end of file
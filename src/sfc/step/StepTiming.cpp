@@ -0,0 +1,71 @@
+#include "sfc/step/StepTiming.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+uint32_t DwellHistogram::bucket(std::chrono::nanoseconds dwell) {
+  uint64_t us = dwell.count() > 0 ? static_cast<uint64_t>(dwell.count()) / 1000 : 0;
+  uint32_t bucket = 0;
+  while (us != 0 && bucket + 1 < BUCKETS_COUNT) {
+    us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+std::chrono::nanoseconds DwellHistogram::upperBound(uint32_t bucket) const {
+  if (bucket + 1 >= BUCKETS_COUNT) {
+    return max;
+  }
+  return std::chrono::microseconds(uint64_t(1) << bucket);
+}
+
+std::chrono::nanoseconds DwellHistogram::mean() const {
+  return count ? total / static_cast<int64_t>(count) : std::chrono::nanoseconds(0);
+}
+
+std::chrono::nanoseconds DwellHistogram::quantile(double ratio) const {
+  const uint64_t rank = static_cast<uint64_t>(std::ceil(ratio * count));
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < BUCKETS_COUNT; i++) {
+    seen += buckets[i];
+    if (count && seen >= rank && seen > 0) {
+      return std::min(upperBound(i), max);
+    }
+  }
+  return std::chrono::nanoseconds(0);
+}
+
+void StepTiming::deactivated(std::chrono::nanoseconds now) {
+  const int64_t since = activated_at.exchange(-1, std::memory_order_acq_rel);
+  if (since < 0) {
+    return;
+  }
+  const int64_t dwell = std::max<int64_t>(now.count() - since, 0);
+  total_ns.fetch_add(dwell, std::memory_order_relaxed);
+  int64_t previous = max_ns.load(std::memory_order_relaxed);
+  while (dwell > previous && !max_ns.compare_exchange_weak(previous, dwell, std::memory_order_relaxed)) {
+  }
+  // Last: a reader seeing the count sees the total.
+  buckets[DwellHistogram::bucket(std::chrono::nanoseconds(dwell))].fetch_add(1, std::memory_order_release);
+}
+
+void StepTiming::copyFrom(const StepTiming &other) {
+  activated_at.store(other.activated_at.load());
+  total_ns.store(other.total_ns.load());
+  max_ns.store(other.max_ns.load());
+  for (uint32_t i = 0; i < DwellHistogram::BUCKETS_COUNT; i++) {
+    buckets[i].store(other.buckets[i].load());
+  }
+}
+
+DwellHistogram StepTiming::histogram() const {
+  DwellHistogram histogram;
+  for (uint32_t i = 0; i < DwellHistogram::BUCKETS_COUNT; i++) {
+    histogram.buckets[i] = buckets[i].load(std::memory_order_acquire);
+    histogram.count += histogram.buckets[i];
+  }
+  histogram.total = std::chrono::nanoseconds(total_ns.load(std::memory_order_relaxed));
+  histogram.max = std::chrono::nanoseconds(max_ns.load(std::memory_order_relaxed));
+  return histogram;
+}
@@ -0,0 +1,123 @@
+#include "sfc/step/action/ActionExecutor.hpp"
+#include "sfc/executor/Executor.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+void ActionExecutor::Batch::done(StepAction::Priority priority) {
+  std::lock_guard<std::mutex> _lock(mutex);
+  m_pending[priority]--;
+  cond_var.notify_all();
+}
+
+void ActionExecutor::Batch::wait(StepAction::Priority priority, const StopToken &stop) {
+  // Registered before locking: the stop request notifies under our mutex, no wake-up is lost.
+  StopToken::Callback on_stop(stop, [this]() {
+    std::lock_guard<std::mutex> _lock(mutex);
+    cond_var.notify_all();
+  });
+  std::unique_lock<std::mutex> lock(mutex);
+  cond_var.wait(lock, [this, priority, &stop]() {
+    if (stop.stopRequested()) {
+      return true;
+    }
+    for (uint8_t p = 0; p <= priority; p++) {
+      if (m_pending[p] > 0) {
+        return false;
+      }
+    }
+    return true;
+  });
+}
+
+ActionExecutor::ActionExecutor(uint32_t workers_count) : m_pending_count(0), m_failed_count(0) {
+  workers_count = std::max<uint32_t>(workers_count, 1);
+  m_workers.reserve(workers_count);
+  for (uint32_t i = 0; i < workers_count; i++) {
+    m_workers.emplace_back(&ActionExecutor::work, this);
+  }
+}
+
+ActionExecutor::~ActionExecutor() {
+  {
+    std::lock_guard<std::mutex> _lock(queue_mutex);
+    m_stopping = true;
+  }
+  queue_cond_var.notify_all();
+  for (auto &worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+std::shared_ptr<ActionExecutor::Batch> ActionExecutor::submit(const std::vector<std::shared_ptr<StepAction>> &actions) {
+  auto batch = std::make_shared<Batch>();
+  if (actions.empty()) {
+    return batch;
+  }
+  // Priorities read once: queue, pending count and completion use the same.
+  std::vector<StepAction::Priority> priorities;
+  priorities.reserve(actions.size());
+  {
+    std::lock_guard<std::mutex> _lock(batch->mutex);
+    for (const auto &a : actions) {
+      priorities.push_back(a->getPriority());
+      batch->m_pending[priorities.back()]++;
+    }
+  }
+  {
+    std::lock_guard<std::mutex> _lock(queue_mutex);
+    for (std::size_t i = 0; i < actions.size(); i++) {
+      m_queues[priorities[i]].push_back({actions[i], batch, priorities[i]});
+    }
+    m_pending_count += actions.size();
+  }
+  queue_cond_var.notify_all();
+  return batch;
+}
+
+void ActionExecutor::work() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex);
+      auto it = m_queues.end();
+      queue_cond_var.wait(lock, [this, &it]() {
+        it = std::find_if(m_queues.begin(), m_queues.end(), [](const auto &q) { return !q.empty(); });
+        return it != m_queues.end() || m_stopping;
+      });
+      if (it == m_queues.end()) {
+        // Stopping and nothing left to run.
+        return;
+      }
+      job = std::move(it->front());
+      it->pop_front();
+      m_pending_count--;
+    }
+    try {
+      (*job.action)();
+    } catch (const std::exception &e) {
+      m_failed_count++;
+      std::cerr << "Step action failed: " << e.what() << std::endl;
+    } catch (...) {
+      m_failed_count++;
+      std::cerr << "Step action failed: Unknown exception" << std::endl;
+    }
+    job.batch->done(job.priority);
+  }
+}
+
+bool ActionExecutor::applyAffinity(const std::vector<int> &cpus) {
+  bool ret = true;
+  for (auto &worker : m_workers) {
+    ret &= setThreadAffinity(worker.native_handle(), cpus);
+  }
+  return ret;
+}
+
+uint32_t ActionExecutor::size() const { return m_workers.size(); }
+
+uint32_t ActionExecutor::pendingCount() const { return m_pending_count; }
+
+uint64_t ActionExecutor::failedCount() const { return m_failed_count; }
@@ -1,7 +1,12 @@
 #include "sfc/step/action/StepAction.hpp"
 #include <stdexcept>
 
-StepAction::StepAction(StepActionCallback action_callback) : m_action_callback(action_callback) {}
+StepAction::StepAction(StepActionCallback action_callback, Priority priority)
+    : m_action_callback(action_callback), m_priority(priority) {}
+
+StepAction::Priority StepAction::getPriority() const { return m_priority; }
+
+void StepAction::setPriority(Priority priority) { m_priority = priority; }
 
 void StepAction::exec() const {
   if (m_action_callback) {
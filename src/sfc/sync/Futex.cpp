@@ -0,0 +1,70 @@
+#include "sfc/sync/Futex.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic_uint32_t) == sizeof(uint32_t), "Futex word must be a plain 32 bits word !");
+#endif
+
+Futex::Futex() : m_word(0), m_waiters(0) {}
+
+uint32_t Futex::load() const { return m_word.load(); }
+
+#ifdef __linux__
+void Futex::bump() {
+  m_word.fetch_add(1);
+  // Waiters increment 'm_waiters' before checking 'm_word': one of both sides sees the other.
+  if (m_waiters.load()) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+  }
+}
+
+bool Futex::wait(uint32_t expected, std::chrono::nanoseconds timeout) {
+  struct timespec ts;
+  struct timespec *ts_p = nullptr;
+  if (timeout != std::chrono::nanoseconds::max()) {
+    if (timeout <= std::chrono::nanoseconds(0)) {
+      return m_word.load() != expected;
+    }
+    ts.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(timeout).count();
+    ts.tv_nsec = (timeout - std::chrono::seconds(ts.tv_sec)).count();
+    ts_p = &ts;
+  }
+  m_waiters.fetch_add(1);
+  long ret = 0;
+  if (m_word.load() == expected) {
+    ret = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_word), FUTEX_WAIT_PRIVATE, expected, ts_p, nullptr, 0);
+  }
+  m_waiters.fetch_sub(1);
+  return !(ret == -1 && errno == ETIMEDOUT);
+}
+#else
+void Futex::bump() {
+  {
+    std::lock_guard<std::mutex> _lock(m_mutex);
+    m_word.fetch_add(1);
+  }
+  if (m_waiters.load()) {
+    m_cond.notify_all();
+  }
+}
+
+bool Futex::wait(uint32_t expected, std::chrono::nanoseconds timeout) {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto changed = [this, expected]() { return m_word.load() != expected; };
+  m_waiters.fetch_add(1);
+  bool ret = true;
+  if (timeout == std::chrono::nanoseconds::max()) {
+    m_cond.wait(lock, changed);
+  } else {
+    ret = m_cond.wait_for(lock, timeout, changed);
+  }
+  m_waiters.fetch_sub(1);
+  return ret;
+}
+#endif
@@ -0,0 +1,99 @@
+#include "sfc/sync/StopToken.hpp"
+
+#include <thread>
+
+StopToken::StopToken() : m_stop_requested(false) {}
+
+void StopToken::lock() const {
+  while (m_lock.test_and_set(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void StopToken::unlock() const { m_lock.clear(std::memory_order_release); }
+
+void StopToken::attach(CallbackNode &node) const {
+  lock();
+  if (!stopRequested()) {
+    node.m_next = m_callbacks;
+    if (m_callbacks) {
+      m_callbacks->m_prev = &node;
+    }
+    m_callbacks = &node;
+    unlock();
+    return;
+  }
+  unlock();
+  node.m_invoke(&node);
+}
+
+void StopToken::detach(CallbackNode &node) const {
+  lock();
+  if (m_callbacks == &node || node.m_prev) {
+    // Still registered.
+    if (node.m_prev) {
+      node.m_prev->m_next = node.m_next;
+    } else {
+      m_callbacks = node.m_next;
+    }
+    if (node.m_next) {
+      node.m_next->m_prev = node.m_prev;
+    }
+    unlock();
+    return;
+  }
+  const bool running = m_running == &node;
+  unlock();
+  // Being called by the stop request: wait for it to return.
+  while (running && !node.m_done.load(std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+bool StopToken::requestStop() {
+  lock();
+  if (m_stop_requested.exchange(true, std::memory_order_acq_rel)) {
+    unlock();
+    return false;
+  }
+  m_futex.bump();
+  // Called once, out of the lock: registered callbacks after that are called right away.
+  while (m_callbacks) {
+    CallbackNode *node = m_callbacks;
+    m_callbacks = node->m_next;
+    if (m_callbacks) {
+      m_callbacks->m_prev = nullptr;
+    }
+    m_running = node;
+    unlock();
+    node->m_invoke(node);
+    // The node may be destroyed from now on.
+    node->m_done.store(true, std::memory_order_release);
+    lock();
+    m_running = nullptr;
+  }
+  unlock();
+  return true;
+}
+
+void StopToken::reset() {
+  lock();
+  m_stop_requested.store(false, std::memory_order_release);
+  unlock();
+}
+
+bool StopToken::sleepFor(std::chrono::nanoseconds duration) const {
+  const auto deadline = std::chrono::steady_clock::now() + duration;
+  while (true) {
+    // Generation first: a request happening after the check wakes us up.
+    const uint32_t generation = m_futex.load();
+    if (stopRequested()) {
+      return false;
+    }
+    const auto left = deadline - std::chrono::steady_clock::now();
+    if (left <= std::chrono::nanoseconds(0)) {
+      return true;
+    }
+    m_futex.wait(generation, left);
+  }
+}
@@ -0,0 +1,163 @@
+#include "sfc/trace/Tracer.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <stdexcept>
+
+Tracer::Tracer(std::size_t capacity) : m_capacity(capacity) { m_events.reserve(capacity); }
+
+std::chrono::nanoseconds Tracer::now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+void Tracer::push(const TraceEvent &event) {
+  if (m_events.size() < m_capacity) {
+    m_events.push_back(event);
+  } else {
+    m_dropped++;
+  }
+}
+
+void Tracer::span(TraceEvent::Kind kind, unsigned int step_id, int worker, int branch, std::chrono::nanoseconds begin,
+                  std::chrono::nanoseconds end) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  push({kind, worker, branch, step_id, begin, end, 0});
+}
+
+void Tracer::flowStart(unsigned int step_id, unsigned int next_id, int worker, int branch, std::chrono::nanoseconds time) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  uint64_t flow_id = m_next_flow++;
+  m_pending_flows[next_id].push_back(flow_id);
+  push({TraceEvent::FLOW_START, worker, branch, step_id, time, time, flow_id});
+}
+
+void Tracer::flowEnd(unsigned int step_id, int worker, int branch, std::chrono::nanoseconds time) {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  auto it = m_pending_flows.find(step_id);
+  if (it == m_pending_flows.end()) {
+    return;
+  }
+  for (auto flow_id : it->second) {
+    push({TraceEvent::FLOW_END, worker, branch, step_id, time, time, flow_id});
+  }
+  it->second.clear();
+}
+
+void Tracer::clear() {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  m_events.clear();
+  m_pending_flows.clear();
+  m_dropped = 0;
+}
+
+std::vector<TraceEvent> Tracer::events() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return m_events;
+}
+
+uint64_t Tracer::eventsCount() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return m_events.size();
+}
+
+uint64_t Tracer::droppedCount() const {
+  std::lock_guard<std::mutex> _lock(m_mutex);
+  return m_dropped;
+}
+
+namespace {
+constexpr int WORKERS_PID = 1;
+constexpr int BRANCHES_PID = 2;
+
+const char *spanName(TraceEvent::Kind kind) {
+  switch (kind) {
+  case TraceEvent::STEP:
+    return "step";
+  case TraceEvent::ACTIONS:
+    return "actions";
+  case TraceEvent::WAIT_PREVIOUS:
+    return "wait previous";
+  case TraceEvent::CALLBACKS:
+    return "callbacks";
+  default:
+    return "transition";
+  }
+}
+
+/**
+ * @brief Microseconds, the trace-event time unit.
+ */
+double us(std::chrono::nanoseconds time) { return time.count() / 1000.0; }
+} // namespace
+
+void Tracer::writeChromeJson(std::ostream &out) const {
+  auto events = this->events();
+  std::chrono::nanoseconds origin = events.empty() ? std::chrono::nanoseconds(0) : events.front().begin;
+  std::set<int> workers, branches;
+  for (const auto &event : events) {
+    origin = std::min(origin, event.begin);
+    workers.insert(event.worker);
+    branches.insert(event.branch);
+  }
+  // Tracks ids: index + 1, so that the unknown worker/branch (-1) gets track 0.
+  out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+  out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << WORKERS_PID << ",\"args\":{\"name\":\"Workers\"}},\n";
+  out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << BRANCHES_PID << ",\"args\":{\"name\":\"Branches\"}}";
+  for (int worker : workers) {
+    out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << WORKERS_PID << ",\"tid\":" << worker + 1
+        << ",\"args\":{\"name\":\"";
+    if (worker < 0) {
+      out << "Starting thread";
+    } else {
+      out << "Worker #" << worker;
+    }
+    out << "\"}}";
+  }
+  for (int branch : branches) {
+    out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << BRANCHES_PID << ",\"tid\":" << branch + 1
+        << ",\"args\":{\"name\":\"";
+    if (branch < 0) {
+      out << "Unknown branch";
+    } else {
+      out << "Branch #" << branch;
+    }
+    out << "\"}}";
+  }
+  for (const auto &event : events) {
+    const double ts = us(event.begin - origin);
+    if (event.kind == TraceEvent::FLOW_START || event.kind == TraceEvent::FLOW_END) {
+      out << ",\n{\"ph\":\"" << (event.kind == TraceEvent::FLOW_START ? "s" : "f")
+          << "\",\"name\":\"transition\",\"cat\":\"transition\",\"id\":" << event.flow_id << ",\"ts\":" << ts
+          << ",\"pid\":" << WORKERS_PID << ",\"tid\":" << event.worker + 1;
+      if (event.kind == TraceEvent::FLOW_END) {
+        // Bound to the next step slice, starting at the same time.
+        out << ",\"bp\":\"e\"";
+      }
+      out << "}";
+      continue;
+    }
+    const char *name = spanName(event.kind);
+    const double dur = us(event.end - event.begin);
+    out << ",\n{\"ph\":\"X\",\"name\":\"" << name << " #" << event.step_id << "\",\"cat\":\"" << name
+        << "\",\"ts\":" << ts << ",\"dur\":" << dur << ",\"pid\":" << WORKERS_PID << ",\"tid\":" << event.worker + 1
+        << ",\"args\":{\"step\":" << event.step_id << "}}";
+    if (event.kind == TraceEvent::STEP) {
+      out << ",\n{\"ph\":\"X\",\"name\":\"" << name << " #" << event.step_id << "\",\"cat\":\"" << name
+          << "\",\"ts\":" << ts << ",\"dur\":" << dur << ",\"pid\":" << BRANCHES_PID << ",\"tid\":" << event.branch + 1
+          << ",\"args\":{\"step\":" << event.step_id << ",\"worker\":" << event.worker << "}}";
+    }
+  }
+  out << "\n]}\n";
+}
+
+void Tracer::writeChromeJson(const std::string &path) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error("Cannot open trace file: " + path);
+  }
+  writeChromeJson(file);
+  if (!file.flush()) {
+    throw std::runtime_error("Cannot write trace file: " + path);
+  }
+}
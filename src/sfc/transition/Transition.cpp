@@ -6,7 +6,8 @@
 
 Transition::Transition(std::vector<std::weak_ptr<Step>> next_steps, std::vector<std::weak_ptr<Step>> validation_steps,
                        ValidationMode mode)
-    : m_next_steps(next_steps), m_validation_steps(validation_steps), m_receptivity_state(false), m_validation_mode(mode) {}
+    : m_next_steps(next_steps), m_validation_steps(validation_steps), m_receptivity_state(false), m_validation_mode(mode),
+      m_observer(nullptr), m_observer_id(0) {}
 
 const std::vector<std::weak_ptr<Step>> &Transition::nexts() const { return m_next_steps; }
 
@@ -14,7 +15,41 @@ const std::vector<std::weak_ptr<Step>> &Transition::validations() const { return
 
 bool Transition::getReceptivityState() const { return m_receptivity_state.load(); }
 
-void Transition::setReceptivityState(bool state) { m_receptivity_state = state; }
+void Transition::setReceptivityState(bool state) {
+  ReceptivityObserver *observer = m_observer.load(std::memory_order_acquire);
+  if (!observer) {
+    m_receptivity_state = state;
+  } else if (m_receptivity_state.exchange(state) != state) {
+    observer->receptivityChanged(m_observer_id.load(std::memory_order_relaxed), state);
+  }
+}
+
+void Transition::setObserver(ReceptivityObserver *observer, uint32_t id) {
+  m_observer_id.store(id, std::memory_order_relaxed);
+  m_observer.store(observer, std::memory_order_release);
+}
+
+ReceptivityObserver *Transition::getObserver() const { return m_observer.load(); }
+
+void Transition::setPredicate(std::function<bool()> predicate, std::chrono::microseconds period) {
+  m_predicate = predicate;
+  m_sampling_period = std::max(period, std::chrono::microseconds(0));
+}
+
+bool Transition::hasPredicate() const { return static_cast<bool>(m_predicate); }
+
+const std::function<bool()> &Transition::getPredicate() const { return m_predicate; }
+
+std::chrono::microseconds Transition::getSamplingPeriod() const { return m_sampling_period; }
+
+bool Transition::sample() {
+  if (!m_predicate) {
+    return getReceptivityState();
+  }
+  bool state = m_predicate();
+  setReceptivityState(state);
+  return state;
+}
 
 Transition::ValidationMode Transition::getValidationMode() const { return m_validation_mode; }
 
@@ -0,0 +1,78 @@
+#include "sfc/watchdog/TimerWheel.hpp"
+
+#include <algorithm>
+
+TimerWheel::TimerWheel(std::chrono::nanoseconds resolution, uint32_t keys_count)
+    : m_resolution(std::max<std::chrono::nanoseconds>(resolution, std::chrono::microseconds(1))),
+      m_keys_count(keys_count), m_slots(new std::atomic<int64_t>[keys_count]), m_earliest(NEVER), m_size(0) {
+  for (uint32_t i = 0; i < m_keys_count; i++) {
+    m_slots[i].store(DISARMED, std::memory_order_relaxed);
+  }
+}
+
+std::chrono::nanoseconds TimerWheel::resolution() const { return m_resolution; }
+
+uint32_t TimerWheel::size() const { return m_size.load(std::memory_order_relaxed); }
+
+int64_t TimerWheel::expiryTick(int64_t deadline) const {
+  // Rounded up: never expired before its deadline.
+  return (std::max<int64_t>(deadline, 0) + m_resolution.count() - 1) / m_resolution.count();
+}
+
+void TimerWheel::lowerEarliest(int64_t tick) {
+  int64_t earliest = m_earliest.load();
+  while (tick < earliest && !m_earliest.compare_exchange_weak(earliest, tick)) {
+  }
+}
+
+void TimerWheel::schedule(uint32_t key, std::chrono::nanoseconds deadline) {
+  if (m_slots[key].exchange(deadline.count()) == DISARMED) {
+    m_size.fetch_add(1, std::memory_order_relaxed);
+  }
+  // After the slot store: an 'advance' missing it has reset the earliest deadline before.
+  lowerEarliest(expiryTick(deadline.count()));
+}
+
+bool TimerWheel::cancel(uint32_t key, std::chrono::nanoseconds deadline) {
+  int64_t armed = deadline.count();
+  if (!m_slots[key].compare_exchange_strong(armed, DISARMED)) {
+    return false;
+  }
+  // The earliest deadline is left as is: 'advance' finds nothing, then tracks the next one.
+  m_size.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool TimerWheel::due(std::chrono::nanoseconds now) const {
+  return std::max<int64_t>(now.count(), 0) / m_resolution.count() >= m_earliest.load(std::memory_order_relaxed);
+}
+
+uint32_t TimerWheel::advance(std::chrono::nanoseconds now, const std::function<void(const Timer &)> &expired) {
+  const int64_t target = std::max<int64_t>(now.count(), 0) / m_resolution.count();
+  if (target < m_earliest.load()) {
+    return 0;
+  }
+  // Reset before the walk: a timer armed behind it lowers it again.
+  m_earliest.store(NEVER);
+  int64_t earliest = NEVER;
+  uint32_t fired = 0;
+  for (uint32_t key = 0; key < m_keys_count; key++) {
+    int64_t deadline = m_slots[key].load();
+    if (deadline == DISARMED) {
+      continue;
+    }
+    const int64_t tick = expiryTick(deadline);
+    if (tick > target) {
+      earliest = std::min(earliest, tick);
+      continue;
+    }
+    // Lost race: re-armed or cancelled meanwhile (A new deadline lowered the earliest one itself).
+    if (m_slots[key].compare_exchange_strong(deadline, DISARMED)) {
+      m_size.fetch_sub(1, std::memory_order_relaxed);
+      fired++;
+      expired({key, std::chrono::nanoseconds(deadline)});
+    }
+  }
+  lowerEarliest(earliest);
+  return fired;
+}
@@ -0,0 +1,166 @@
+#include "sfc/watchdog/Watchdog.hpp"
+#include "sfc/CompiledChart.hpp"
+
+#include <algorithm>
+
+bool WatchdogConfig::enabled() const {
+  return max_loop_activations > 0 || !loop_max_activations.empty() || !max_dwell.empty();
+}
+
+Watchdog::Watchdog(const CompiledChart &chart, const WatchdogConfig &config)
+    : m_rate_window(config.rate_window), m_dwell_keys(chart.stepsCount(), NO_TIMER) {
+  m_loops = findLoops(chart, m_loops_count);
+  m_windows.reset(new LoopWindow[m_loops_count]);
+  for (uint32_t i = 0; i < m_loops_count; i++) {
+    m_windows[i].max_activations = config.max_loop_activations;
+  }
+  for (const auto &limit : config.loop_max_activations) {
+    uint32_t index = chart.stepIndex(limit.first);
+    if (index != CompiledChart::NONE && m_loops[index] != NO_LOOP) {
+      m_windows[m_loops[index]].max_activations = limit.second;
+    }
+  }
+  for (const auto &limit : config.max_dwell) {
+    uint32_t index = chart.stepIndex(limit.first);
+    if (index != CompiledChart::NONE && limit.second.count() > 0 && m_dwell_keys[index] == NO_TIMER) {
+      m_dwell_keys[index] = m_dwell_limits.size();
+      m_dwell_limits.push_back({index, std::chrono::nanoseconds(limit.second).count()});
+    }
+  }
+  m_wheel = std::make_unique<TimerWheel>(config.resolution, m_dwell_limits.size());
+}
+
+std::vector<uint32_t> Watchdog::findLoops(const CompiledChart &chart, uint32_t &loops_count) {
+  const uint32_t count = chart.stepsCount();
+  // Successors: next steps of the transitions, macro first step, enclosing step activation steps.
+  std::vector<std::vector<uint32_t>> successors(count);
+  for (uint32_t i = 0; i < count; i++) {
+    for (auto t : chart.nextTransitions(i)) {
+      for (auto next : chart.nexts(t)) {
+        successors[i].push_back(next);
+      }
+    }
+    if (chart.step(i).macro_first != CompiledChart::NONE) {
+      successors[i].push_back(chart.step(i).macro_first);
+    }
+    for (auto child : chart.activations(i)) {
+      successors[i].push_back(child);
+    }
+  }
+
+  std::vector<uint32_t> loops(count, NO_LOOP);
+  std::vector<uint32_t> order(count, NO_LOOP);
+  std::vector<uint32_t> low(count, 0);
+  std::vector<bool> on_stack(count, false);
+  std::vector<uint32_t> stack;
+  // DFS frames: step index, next successor to visit.
+  std::vector<std::pair<uint32_t, uint32_t>> frames;
+  uint32_t visited = 0;
+  loops_count = 0;
+  for (uint32_t root = 0; root < count; root++) {
+    if (order[root] != NO_LOOP) {
+      continue;
+    }
+    frames.push_back({root, 0});
+    while (!frames.empty()) {
+      auto &frame = frames.back();
+      const uint32_t v = frame.first;
+      if (frame.second == 0) {
+        order[v] = low[v] = visited++;
+        stack.push_back(v);
+        on_stack[v] = true;
+      }
+      if (frame.second < successors[v].size()) {
+        uint32_t w = successors[v][frame.second++];
+        if (order[w] == NO_LOOP) {
+          frames.push_back({w, 0});
+        } else if (on_stack[w]) {
+          low[v] = std::min(low[v], order[w]);
+        }
+        continue;
+      }
+      if (low[v] == order[v]) {
+        // Component root: a loop if several steps, or a step leading to itself.
+        std::vector<uint32_t> component;
+        uint32_t w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          on_stack[w] = false;
+          component.push_back(w);
+        } while (w != v);
+        if (component.size() > 1 ||
+            std::find(successors[v].begin(), successors[v].end(), v) != successors[v].end()) {
+          for (auto step : component) {
+            loops[step] = loops_count;
+          }
+          loops_count++;
+        }
+      }
+      frames.pop_back();
+      if (!frames.empty()) {
+        low[frames.back().first] = std::min(low[frames.back().first], low[v]);
+      }
+    }
+  }
+  return loops;
+}
+
+uint32_t Watchdog::loopsCount() const { return m_loops_count; }
+
+uint32_t Watchdog::loop(uint32_t step_index) const { return m_loops[step_index]; }
+
+void Watchdog::armDwell(uint32_t step_index, std::chrono::nanoseconds activated_at) {
+  const uint32_t key = m_dwell_keys[step_index];
+  if (key != NO_TIMER) {
+    m_wheel->schedule(key, activated_at + std::chrono::nanoseconds(m_dwell_limits[key].second));
+  }
+}
+
+void Watchdog::disarmDwell(uint32_t step_index, std::chrono::nanoseconds activated_at) {
+  const uint32_t key = m_dwell_keys[step_index];
+  if (key != NO_TIMER) {
+    m_wheel->cancel(key, activated_at + std::chrono::nanoseconds(m_dwell_limits[key].second));
+  }
+}
+
+uint32_t Watchdog::activated(uint32_t step_index, std::chrono::nanoseconds now) {
+  armDwell(step_index, now);
+  const uint32_t loop = m_loops[step_index];
+  if (loop == NO_LOOP || m_windows[loop].max_activations == 0) {
+    return 0;
+  }
+  LoopWindow &window = m_windows[loop];
+  int64_t begin = window.begin.load(std::memory_order_relaxed);
+  if (now.count() - begin >= m_rate_window.count()) {
+    // Lost race: another activation restarted the window.
+    if (window.begin.compare_exchange_strong(begin, now.count(), std::memory_order_relaxed)) {
+      window.count.store(1, std::memory_order_relaxed);
+      return 0;
+    }
+  }
+  uint32_t activations = window.count.fetch_add(1, std::memory_order_relaxed) + 1;
+  // Reported once per window.
+  return (activations == window.max_activations + 1) ? activations : 0;
+}
+
+uint32_t Watchdog::poll(std::chrono::nanoseconds now, const std::function<bool(uint32_t, int64_t)> &still_active,
+                        const std::function<void(uint32_t, std::chrono::nanoseconds)> &timeout) {
+  if (!m_wheel->due(now) || m_polling.test_and_set(std::memory_order_acquire)) {
+    return 0;
+  }
+  uint32_t timeouts = 0;
+  m_wheel->advance(now, [&](const TimerWheel::Timer &timer) {
+    const auto &limit = m_dwell_limits[timer.key];
+    // The deadline tells the activation the timer was armed for.
+    const int64_t activated_at = timer.deadline.count() - limit.second;
+    if (still_active(limit.first, activated_at)) {
+      timeouts++;
+      timeout(limit.first, now - std::chrono::nanoseconds(activated_at));
+    }
+  });
+  m_polling.clear(std::memory_order_release);
+  return timeouts;
+}
+
+uint32_t Watchdog::pendingTimers() const { return m_wheel->size(); }
@@ -6,6 +6,21 @@
  */
 
 #include "sfc/SfcTests.h"
+#include "sfc/ActionExecutorTests.h"
+#include "sfc/ExecutorTests.h"
+#include "sfc/SimulationTests.h"
+#include "sfc/RecordReplayTests.h"
+#include "sfc/SituationTests.h"
+#include "sfc/ChangeSetTests.h"
+#include "sfc/PersistTests.h"
+#include "sfc/ChartArenaTests.h"
+#include "sfc/EnclosingTests.h"
+#include "sfc/MetricsTests.h"
+#include "sfc/TraceTests.h"
+#include "sfc/ProfileTests.h"
+#include "sfc/GeneratorTests.h"
+#include "sfc/InputRingTests.h"
+#include "sfc/WatchdogTests.h"
 #include <gtest/gtest.h>
 
 int main(int argc, char **argv) {
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/step/action/ActionExecutor.hpp>
+#include <sfc/step/action/StepAction.hpp>
+#include <sfc/transition/Transition.hpp>
+
+TEST_F(SfcTest, Action_Executor_Priorities) {
+  ActionExecutor executor(1);
+  std::mutex order_mutex;
+  std::vector<int> order;
+  std::atomic_bool released(false);
+  auto record = [&order_mutex, &order](int i) {
+    return [&order_mutex, &order, i]() {
+      std::lock_guard<std::mutex> _lock(order_mutex);
+      order.push_back(i);
+    };
+  };
+
+  // Hold the only worker, so that all following actions get queued.
+  auto blocker = std::make_shared<StepAction>([&released]() {
+    while (!released) {
+      std::this_thread::sleep_for(1ms);
+    }
+  });
+  executor.submit({blocker});
+  while (executor.pendingCount() > 0) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  auto batch = executor.submit({std::make_shared<StepAction>(record(3), StepAction::LOW),
+                                std::make_shared<StepAction>(record(2), StepAction::NORMAL),
+                                std::make_shared<StepAction>(record(0), StepAction::CRITICAL),
+                                std::make_shared<StepAction>(record(1), StepAction::HIGH)});
+  EXPECT_EQ(executor.pendingCount(), 4);
+  released = true;
+  StopToken stop;
+  batch->wait(StepAction::LOW, stop);
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(executor.failedCount(), 0);
+
+  batch = executor.submit({std::make_shared<StepAction>()});
+  batch->wait(StepAction::LOW, stop);
+  EXPECT_EQ(executor.failedCount(), 1);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_With_Detached_Actions) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  seq.setActionPolicy(Sequence::DETACHED_ACTIONS, 1);
+  seq.addStepChangedCallback(&stepChanged);
+  seq.addSequenceChangedCallback(&seqChanged);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::atomic_bool released(false);
+  std::atomic_bool critical_done(false);
+  first_step->addStepAction(std::make_shared<StepAction>([&released]() {
+    while (!released) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }));
+  first_step->addStepAction(std::make_shared<StepAction>([&critical_done]() { critical_done = true; }, StepAction::CRITICAL));
+  EXPECT_TRUE(seq.isValid());
+
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *init_step);
+  waitForStep(seq, *first_step, *t1); // Activated while the long action is still running.
+  t1->setReceptivityState(false);
+  EXPECT_FALSE(released);
+  released = true;
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  seq.stop();
+  t.join();
+  ASSERT_NE(seq.getActionExecutor(), nullptr);
+  EXPECT_EQ(seq.getActionExecutor()->size(), 1);
+  while (seq.getActionExecutor()->pendingCount() > 0) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_TRUE(critical_done);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_With_Critical_Actions) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  seq.setActionPolicy(Sequence::WAIT_CRITICAL_ACTIONS, 2);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::atomic_bool released(false);
+  std::atomic_bool critical_released(false);
+  first_step->addStepAction(std::make_shared<StepAction>([&released]() {
+    while (!released) {
+      std::this_thread::sleep_for(1ms);
+    }
+  }));
+  first_step->addStepAction(std::make_shared<StepAction>(
+      [&critical_released]() {
+        while (!critical_released) {
+          std::this_thread::sleep_for(1ms);
+        }
+      },
+      StepAction::CRITICAL));
+  EXPECT_TRUE(seq.isValid());
+
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *init_step);
+  t1->setReceptivityState(true);
+  // Activation waits for the critical action only.
+  EXPECT_FALSE(seq.awaitStep(1, true, std::chrono::milliseconds(50)));
+  critical_released = true;
+  EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  EXPECT_FALSE(released);
+  released = true;
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  seq.stop();
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::NORMAL_STOP);
+  EXPECT_EQ(seq.getActionExecutor()->failedCount(), 0);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/ChangeSet.hpp>
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <thread>
+
+TEST_F(SfcTest, Simulate_Live_Chart_Change) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  Simulation sim(seq);
+  sim.start();
+  uint64_t version = seq.getGraphVersion();
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+  t1->setReceptivityState(false);
+
+  // 0 -> 1 -> 2 -> 0, while 1 is active.
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({second_step}, {first_step});
+  std::shared_ptr<Transition> t4 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t4);
+  seq.apply(ChangeSet().addStep(second_step).removeTransition(1, t2).addTransition(1, t3));
+  EXPECT_EQ(seq.getGraphVersion(), version + 1);
+  EXPECT_TRUE(seq.containsStep(2));
+  EXPECT_EQ(first_step->getNextTransitions(), std::vector<std::shared_ptr<Transition>>({t3}));
+  EXPECT_TRUE(seq.getSituation().isActivated(1));
+
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntilStable());
+  EXPECT_TRUE(first_step->isActivated());
+  t2->setReceptivityState(false);
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return second_step->isActivated(); }));
+  t3->setReceptivityState(false);
+  EXPECT_TRUE(seq.getSituation().isActivated(2));
+
+  // Back to 0 -> 1 -> 0: active step 2 is removed, 1 takes over.
+  seq.apply(ChangeSet().removeStep(2).removeTransition(1, t3).addTransition(1, t2).mapActiveStep(2, 1));
+  EXPECT_FALSE(seq.containsStep(2));
+  sim.tick();
+  EXPECT_FALSE(second_step->isActivated());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({1}));
+  EXPECT_EQ(seq.getSituation().getActivatedSteps(), std::vector<unsigned int>({1}));
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  t2->setReceptivityState(false);
+  sim.stop();
+  EXPECT_TRUE(seq.isValid());
+}
+
+TEST_F(SfcTest, Apply_Invalid_Chart_Change) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t3);
+
+  Simulation sim(seq);
+  sim.start();
+  t1->setReceptivityState(true);
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return second_step->isActivated(); }));
+  t1->setReceptivityState(false);
+  t2->setReceptivityState(false);
+  uint64_t version = seq.getGraphVersion();
+  auto chart = seq.getCompiledChart();
+
+  EXPECT_THROW(seq.apply(ChangeSet().addStep(std::make_shared<Step>(0, Step::DEFAULT_STEP))), std::invalid_argument);
+  EXPECT_THROW(seq.apply(ChangeSet().removeStep(9999)), std::invalid_argument);
+  EXPECT_THROW(seq.apply(ChangeSet().removeTransition(0, t2)), std::invalid_argument);
+  // Still referenced by t2.
+  EXPECT_THROW(seq.apply(ChangeSet().removeStep(2)), std::invalid_argument);
+  // Dead end.
+  EXPECT_THROW(seq.apply(ChangeSet().addStep(std::make_shared<Step>(3, Step::DEFAULT_STEP))), std::runtime_error);
+  EXPECT_THROW(seq.apply(ChangeSet().removeTransition(2, t3)), std::runtime_error);
+  // Active step removed without mapping.
+  std::shared_ptr<Transition> t4 = Transition::mk_sp_transition({init_step}, {first_step});
+  EXPECT_THROW(seq.apply(ChangeSet().removeStep(2).removeTransition(1, t2).addTransition(1, t4)), std::runtime_error);
+  EXPECT_THROW(seq.apply(ChangeSet().removeStep(2).removeTransition(1, t2).addTransition(1, t4).mapActiveStep(2, 2)),
+               std::runtime_error);
+
+  // Nothing was modified.
+  EXPECT_EQ(seq.getGraphVersion(), version);
+  EXPECT_EQ(seq.getCompiledChart(), chart);
+  EXPECT_TRUE(seq.containsStep(2));
+  EXPECT_EQ(first_step->getNextTransitions(), std::vector<std::shared_ptr<Transition>>({t2}));
+  EXPECT_EQ(second_step->getNextTransitions(), std::vector<std::shared_ptr<Transition>>({t3}));
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  t3->setReceptivityState(false);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Live_Chart_Change) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(10);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *first_step, *t1);
+  t1->setReceptivityState(false);
+
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({second_step}, {first_step});
+  std::shared_ptr<Transition> t4 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t4);
+  seq.apply(ChangeSet().addStep(second_step).removeTransition(1, t2).addTransition(1, t3));
+  waitForStep(seq, *second_step, *t3);
+  t3->setReceptivityState(false);
+  waitForStep(seq, *init_step, *t4);
+  t4->setReceptivityState(false);
+  waitForStep(seq, *first_step, *t1);
+  t1->setReceptivityState(false);
+  waitForStep(seq, *second_step, *t3);
+  t3->setReceptivityState(false);
+
+  // Running step 2 is removed: step 1 takes over.
+  seq.apply(ChangeSet().removeStep(2).removeTransition(1, t3).addTransition(1, t2).mapActiveStep(2, 1));
+  waitForStep(seq, *first_step);
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return !situation.isActivated(2); },
+                                 std::chrono::seconds(5)));
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  EXPECT_FALSE(second_step->isActivated());
+  seq.stop();
+  t.join();
+}
+
+TEST_F(SfcTest, Run_Simultaneous_Sequence_Join_Across_Live_Change) {
+  Sequence seq(4);
+  seq.setTransitionPollingDelay(10);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  seq.addStep(third_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, third_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {second_step, third_step});
+  second_step->addTransition(t3);
+  third_step->addTransition(t3);
+
+  std::thread t([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &) {
+    }
+  });
+  waitForSteps(seq, {first_step, third_step}, {t1});
+  t1->setReceptivityState(false);
+  // Third step arrives first at the join.
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return !situation.isActivated(3); },
+                                 std::chrono::seconds(5)));
+  EXPECT_TRUE(first_step->isActivated());
+
+  // The arrival survives the graph swap.
+  std::shared_ptr<Step> fourth_step = std::make_shared<Step>(4, Step::DEFAULT_STEP);
+  std::shared_ptr<Transition> t4 = Transition::mk_sp_transition({fourth_step}, {first_step});
+  fourth_step->addTransition(Transition::mk_sp_transition({init_step}, {fourth_step}));
+  seq.apply(ChangeSet().addStep(fourth_step).addTransition(1, t4));
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  t3->setReceptivityState(false);
+  EXPECT_FALSE(third_step->isActivated());
+  EXPECT_FALSE(fourth_step->isActivated());
+  seq.stop();
+  t.join();
+}
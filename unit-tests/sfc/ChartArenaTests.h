@@ -0,0 +1,50 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/ChartArena.hpp>
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+
+TEST_F(SfcTest, Simulate_Arena_Chart) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step, first_step, second_step;
+  std::shared_ptr<Macro> macro_step;
+  std::shared_ptr<Transition> mt1, t2, mt2;
+  {
+    ChartArena arena(256);
+    init_step = arena.makeStep(0, Step::INIT_STEP);
+    macro_step = arena.makeMacro(12);
+    first_step = arena.makeStep(1);
+    second_step = arena.makeStep(2);
+    macro_step->addStep(first_step);
+    macro_step->addStep(second_step);
+    mt1 = arena.makeTransition({macro_step}, {init_step});
+    init_step->addTransition(mt1);
+    t2 = arena.makeTransition({second_step}, {first_step});
+    first_step->addTransition(t2);
+    mt2 = arena.makeTransition({init_step}, {macro_step});
+    macro_step->addTransition(mt2);
+    EXPECT_EQ(arena.objectsCount(), 7);
+    EXPECT_GE(arena.bytesUsed(), sizeof(Step) * 3 + sizeof(Macro) + sizeof(Transition) * 3);
+  }
+  // Objects outlive the arena.
+  seq.addStep(init_step);
+  seq.addStep(macro_step);
+  EXPECT_TRUE(seq.isValid());
+
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_TRUE(init_step->isActivated());
+  EXPECT_GT(seq.getCompiledChart()->memoryUsage(), sizeof(CompiledChart));
+  mt1->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+  mt1->setReceptivityState(false);
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return second_step->isActivated(); }));
+  t2->setReceptivityState(false);
+  mt2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  EXPECT_FALSE(macro_step->isActivated());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({0}));
+  sim.stop();
+}
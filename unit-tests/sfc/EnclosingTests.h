@@ -0,0 +1,143 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/step/Enclosing.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <algorithm>
+
+TEST_F(SfcTest, Simulate_Enclosing_Step_And_Forcing) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(100);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Enclosing> enclosing = std::make_shared<Enclosing>(10);
+  std::shared_ptr<Step> child_a = std::make_shared<Step>(11);
+  std::shared_ptr<Step> child_b = std::make_shared<Step>(12);
+  // Nested enclosing step, activated with its parent.
+  std::shared_ptr<Enclosing> nested = std::make_shared<Enclosing>(13);
+  std::shared_ptr<Step> grandchild = std::make_shared<Step>(14);
+  EXPECT_THROW(enclosing->addStep(nullptr), std::invalid_argument);
+  EXPECT_THROW(enclosing->addStep(std::make_shared<Step>(15, Step::INIT_STEP)), std::invalid_argument);
+  EXPECT_THROW(enclosing->addStep(std::make_shared<Macro>(16), true), std::invalid_argument);
+  nested->addStep(grandchild, true);
+  enclosing->addStep(child_a, true);
+  enclosing->addStep(child_b);
+  enclosing->addStep(nested, true);
+  EXPECT_TRUE(enclosing->containsStep(13));
+  EXPECT_FALSE(enclosing->containsStep(14));
+  seq.addStep(init_step);
+  seq.addStep(enclosing);
+  EXPECT_TRUE(seq.containsStep(14));
+  EXPECT_THROW(seq.addStep(child_a), std::invalid_argument);
+
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({enclosing}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> ta = Transition::mk_sp_transition({child_b}, {child_a});
+  child_a->addTransition(ta);
+  std::shared_ptr<Transition> tb = Transition::mk_sp_transition({child_a}, {child_b});
+  child_b->addTransition(tb);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {enclosing});
+  enclosing->addTransition(t2);
+  // Leaving the child chart is forbidden.
+  std::shared_ptr<Transition> out = Transition::mk_sp_transition({init_step}, {grandchild});
+  grandchild->addTransition(out);
+  EXPECT_FALSE(seq.isValid());
+  grandchild->removeTransition(out);
+  EXPECT_TRUE(seq.isValid());
+
+  Simulation sim(seq);
+  EXPECT_THROW(sim.force(10, {}), std::runtime_error);
+  sim.start();
+  EXPECT_THROW(sim.force(10, {}), std::runtime_error);
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return enclosing->isActivated(); }));
+  t1->setReceptivityState(false);
+  EXPECT_TRUE(child_a->isActivated());
+  EXPECT_TRUE(nested->isActivated());
+  EXPECT_TRUE(grandchild->isActivated());
+  EXPECT_FALSE(child_b->isActivated());
+
+  ta->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return child_b->isActivated(); }));
+  ta->setReceptivityState(false);
+
+  EXPECT_THROW(sim.force(11, {}), std::invalid_argument);
+  EXPECT_THROW(sim.force(10, {14}), std::invalid_argument);
+  sim.force(10, {11});
+  EXPECT_TRUE(child_a->isActivated());
+  EXPECT_FALSE(child_b->isActivated());
+  EXPECT_FALSE(nested->isActivated());
+  EXPECT_FALSE(grandchild->isActivated());
+  sim.force(10, {13});
+  EXPECT_FALSE(child_a->isActivated());
+  EXPECT_TRUE(grandchild->isActivated());
+
+  // Children die with their enclosing step, even if their own transitions are receptive.
+  tb->setReceptivityState(true);
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  t2->setReceptivityState(false);
+  tb->setReceptivityState(false);
+  EXPECT_TRUE(sim.runUntilStable());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({0}));
+  EXPECT_FALSE(grandchild->isActivated());
+  sim.stop();
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_With_Enclosing_Step) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Enclosing> enclosing = std::make_shared<Enclosing>(10);
+  std::shared_ptr<Step> child_a = std::make_shared<Step>(11);
+  std::shared_ptr<Step> child_b = std::make_shared<Step>(12);
+  enclosing->addStep(child_a, true);
+  enclosing->addStep(child_b);
+  seq.addStep(init_step);
+  seq.addStep(enclosing);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({enclosing}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> ta = Transition::mk_sp_transition({child_b}, {child_a});
+  child_a->addTransition(ta);
+  std::shared_ptr<Transition> tb = Transition::mk_sp_transition({child_a}, {child_b});
+  child_b->addTransition(tb);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {enclosing});
+  enclosing->addTransition(t2);
+  EXPECT_TRUE(seq.isValid());
+  EXPECT_THROW(seq.force(10, {}), std::runtime_error);
+
+  std::thread thread([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return situation.isActivated(10) && situation.isActivated(11); },
+                                 std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  ta->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(12, true, std::chrono::seconds(5)));
+  ta->setReceptivityState(false);
+
+  EXPECT_THROW(seq.force(12, {}), std::invalid_argument);
+  seq.force(10, {11});
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return situation.isActivated(11) && !situation.isActivated(12); },
+                                 std::chrono::seconds(5)));
+
+  // Killed with their enclosing step.
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  t2->setReceptivityState(false);
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return !situation.isActivated(10) && !situation.isActivated(11); },
+                                 std::chrono::seconds(5)));
+  ta->setReceptivityState(true);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_FALSE(child_b->isActivated());
+  ta->setReceptivityState(false);
+
+  // Activated again with it.
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(11, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  seq.stop();
+  thread.join();
+}
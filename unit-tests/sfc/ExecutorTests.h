@@ -0,0 +1,361 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/executor/Executor.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <thread>
+
+TEST_F(SfcTest, Executor_Real_Time_Prefault) {
+  Executor executor(2);
+  RealTimeConfig config;
+  EXPECT_FALSE(config.enabled());
+  config.prefault_stack_size = 64 * 1024;
+  EXPECT_TRUE(config.enabled());
+  EXPECT_TRUE(executor.applyRealTime(config));
+  EXPECT_EQ(executor.size(), 2);
+  // The prefault has to fit in the workers stack.
+  Sequence seq;
+  config.prefault_stack_size = Executor::workerStackSize();
+  EXPECT_THROW(seq.setRealTimeConfig(config), std::invalid_argument);
+  EXPECT_EQ(seq.getRealTimeConfig().prefault_stack_size, 0);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Real_Time) {
+  Sequence seq(4);
+  seq.setTransitionPollingDelay(1);
+  RealTimeConfig config;
+  config.prefault_stack_size = 64 * 1024;
+  seq.setRealTimeConfig(config);
+  EXPECT_EQ(seq.getRealTimeConfig().prefault_stack_size, 64 * 1024);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step, second_step});
+  first_step->addTransition(t2);
+  second_step->addTransition(t2);
+  EXPECT_TRUE(seq.isValid());
+
+  std::thread t([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &) {
+    }
+  });
+  waitForStep(seq, *init_step);
+  waitForSteps(seq, {first_step, second_step}, {t1});
+  t1->setReceptivityState(false);
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  seq.stop();
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::NORMAL_STOP);
+  // Launch lists and macros slots come with the live graph, step tasks with the reserved executor slots.
+  EXPECT_EQ(seq.getRealTimeViolations(), 0);
+}
+
+TEST_F(SfcTest, Run_Simultaneous_Sequence_Pinned_Branches) {
+  Sequence seq(4);
+  seq.setTransitionPollingDelay(1);
+  AffinityConfig config;
+  config.cpus = {0};
+  config.pin_branches = true;
+  seq.setAffinityConfig(config);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  seq.addStep(third_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({third_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {third_step, second_step});
+  third_step->addTransition(t3);
+  second_step->addTransition(t3);
+  EXPECT_TRUE(seq.isValid());
+  EXPECT_TRUE(seq.getWorkersPlacement().empty());
+
+  std::thread t([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &) {
+    }
+  });
+  waitForStep(seq, *init_step);
+  waitForSteps(seq, {first_step, second_step}, {t1});
+  t1->setReceptivityState(false);
+  waitForStep(seq, *third_step, *t2);
+  t2->setReceptivityState(false);
+  auto placement = seq.getWorkersPlacement();
+  EXPECT_FALSE(placement.empty());
+  for (const auto &worker : placement) {
+    EXPECT_EQ(worker.allowed_cpus, std::vector<int>({0}));
+  }
+  waitForStep(seq, *init_step, *t3);
+  t3->setReceptivityState(false);
+  seq.stop();
+  t.join();
+
+  EXPECT_EQ(seq.getStepBranch(0), 0);
+  EXPECT_EQ(seq.getStepBranch(1), 1);
+  EXPECT_EQ(seq.getStepBranch(2), 2);
+  EXPECT_EQ(seq.getStepBranch(3), 1); // Inherits from its previous step.
+  EXPECT_EQ(seq.getStepBranch(42), -1);
+}
+
+TEST_F(SfcTest, Executor_Drain_Keeps_Workers) {
+  Executor executor(2);
+  std::atomic_int done(0);
+  for (int i = 0; i < 4; i++) {
+    executor.push([&done](int) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      done++;
+    });
+  }
+  executor.drain();
+  EXPECT_EQ(done, 4);
+  EXPECT_EQ(executor.inFlightCount(), 0);
+  EXPECT_EQ(executor.size(), 2);
+  // Draining from a task does not wait for that task.
+  executor.push([&executor, &done](int) {
+    executor.drain();
+    done++;
+  });
+  executor.drain();
+  EXPECT_EQ(done, 5);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Warm_Restart) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(10);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  std::vector<bool> sequence_states;
+  seq.addSequenceChangedCallback([&sequence_states](bool state) { sequence_states.push_back(state); });
+
+  for (int i = 0; i < 3; i++) {
+    std::thread t([&seq]() { seq.start(); });
+    waitForStep(seq, *first_step, *t1);
+    t1->setReceptivityState(false);
+    seq.stop();
+    t.join();
+    EXPECT_EQ(seq.getStopCode(), Sequence::NORMAL_STOP);
+    EXPECT_FALSE(first_step->isActivated());
+    // Workers are parked, not destroyed.
+    EXPECT_FALSE(seq.getWorkersPlacement().empty());
+  }
+  EXPECT_EQ(seq.getWarmStartsCount(), 2);
+  EXPECT_EQ(sequence_states, std::vector<bool>({true, false, true, false, true, false}));
+
+  // A structure change is validated again.
+  std::shared_ptr<Step> dead_end_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(dead_end_step);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({dead_end_step}, {first_step});
+  first_step->addTransition(t3);
+  EXPECT_THROW(seq.start(), std::runtime_error);
+
+  // Changing workers settings drops the parked workers.
+  seq.setAffinityConfig(AffinityConfig());
+  EXPECT_TRUE(seq.getWorkersPlacement().empty());
+}
+
+TEST_F(SfcTest, Executor_Elastic_Grow_And_Retire) {
+  Executor executor(1, 3, std::chrono::milliseconds(20));
+  StopToken stop;
+  std::atomic_bool release(false);
+  executor.push([&release](int) {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  EXPECT_TRUE(executor.grow());
+  EXPECT_TRUE(executor.grow());
+  EXPECT_FALSE(executor.grow()); // Hard cap.
+  EXPECT_EQ(executor.size(), 3);
+  release = true;
+  executor.drain();
+  // Grown workers retire once idle, down to the initial ones.
+  for (int i = 0; i < 2000 && executor.size() > 1; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(executor.size(), 1);
+  EXPECT_TRUE(executor.grow());
+
+  // Backpressure: waiting for a free worker.
+  Executor fixed(1);
+  release = false;
+  fixed.push([&release](int) {
+    while (!release) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  EXPECT_FALSE(fixed.grow());
+  EXPECT_FALSE(fixed.awaitWorker(std::chrono::milliseconds(5), stop));
+  release = true;
+  EXPECT_TRUE(fixed.awaitWorker(std::chrono::seconds(5), stop));
+}
+
+TEST_F(SfcTest, Run_Simultaneous_Sequence_Elastic_Pool) {
+  Sequence seq(2);
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  seq.addStep(third_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step, third_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 =
+      Transition::mk_sp_transition({init_step}, {first_step, second_step, third_step}, Transition::ALL);
+  first_step->addTransition(t2);
+  second_step->addTransition(t2);
+  third_step->addTransition(t2);
+  PoolPolicy policy;
+  policy.mode = PoolPolicy::ELASTIC;
+  policy.max_workers = 4;
+  policy.idle_timeout = std::chrono::milliseconds(20);
+  seq.setPoolPolicy(policy);
+  EXPECT_EQ(seq.getPoolPolicy().mode, PoolPolicy::ELASTIC);
+
+  // The burst needs more workers than the pool size.
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *init_step);
+  EXPECT_THROW(seq.setPoolPolicy(PoolPolicy()), std::runtime_error);
+  waitForSteps(seq, {first_step, second_step, third_step}, {t1});
+  t1->setReceptivityState(false);
+  EXPECT_GT(seq.getWorkersPlacement().size(), 2);
+  waitForStep(seq, *init_step, *t2);
+  t2->setReceptivityState(false);
+  seq.stop();
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::NORMAL_STOP);
+  for (int i = 0; i < 2000 && seq.getWorkersPlacement().size() > 2; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_EQ(seq.getWorkersPlacement().size(), 2);
+}
+
+TEST_F(SfcTest, Detect_And_Stop_Runaway_Loop_By_Activation_Rate) {
+  Sequence seq(2);
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t3);
+  PoolPolicy policy;
+  policy.mode = PoolPolicy::BACKPRESSURE;
+  policy.max_activations = 20;
+  policy.rate_window = std::chrono::seconds(10);
+  seq.setPoolPolicy(policy);
+  t2->setReceptivityState(true);
+  t3->setReceptivityState(true);
+
+  std::string error;
+  std::thread t([&seq, &error]() {
+    try {
+      seq.start();
+    } catch (const std::exception &e) {
+      error = e.what();
+    }
+  });
+  waitForStep(seq, *init_step);
+  // Busy workers are waited for: only the activation rate tells the loop.
+  t1->setReceptivityState(true);
+  for (int i = 0; i < 5000 && seq.isRunning(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(seq.isRunning());
+  if (seq.isRunning()) {
+    seq.stop();
+  }
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::CRAZY_LOOPING_STOP);
+  if (!error.empty()) {
+    EXPECT_NE(error.find("activated too often"), std::string::npos);
+  }
+}
+
+TEST_F(SfcTest, Stop_Token_Wakes_Sleeps_And_Callbacks) {
+  StopToken stop;
+  EXPECT_TRUE(stop.sleepFor(std::chrono::milliseconds(1)));
+  int calls = 0;
+  std::thread t([&stop]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stop.requestStop();
+  });
+  {
+    StopToken::Callback callback(stop, [&calls]() { calls++; });
+    const auto begin = std::chrono::steady_clock::now();
+    EXPECT_FALSE(stop.sleepFor(std::chrono::seconds(10)));
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(5));
+  }
+  t.join();
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(stop.requestStop());
+  // Already requested: called right away.
+  StopToken::Callback late(stop, [&calls]() { calls++; });
+  EXPECT_EQ(calls, 2);
+  stop.reset();
+  EXPECT_FALSE(stop.stopRequested());
+  EXPECT_TRUE(stop.sleepFor(std::chrono::microseconds(10)));
+}
+
+TEST_F(SfcTest, Run_Simultaneous_Sequence_Stop_Latency) {
+  Sequence seq(3);
+  // Without cancellation, stopping would wait for every branch polling delay.
+  seq.setTransitionPollingDelay(1000000);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step, second_step});
+  first_step->addTransition(t2);
+  second_step->addTransition(t2);
+
+  std::thread t([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+  EXPECT_TRUE(seq.awaitStep(2, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const auto begin = std::chrono::steady_clock::now();
+  seq.stop();
+  t.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(500));
+  EXPECT_LT(seq.getStopLatency(), std::chrono::milliseconds(500));
+  EXPECT_EQ(seq.getStopCode(), Sequence::NORMAL_STOP);
+  EXPECT_FALSE(first_step->isActivated());
+  EXPECT_FALSE(second_step->isActivated());
+}
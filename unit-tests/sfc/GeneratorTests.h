@@ -0,0 +1,80 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/generator/ChartGenerator.hpp>
+
+#include <random>
+
+TEST_F(SfcTest, Generate_Valid_Random_Charts) {
+  GeneratedChart totals;
+  for (uint32_t seed = 0; seed < 40; seed++) {
+    GeneratorConfig config;
+    config.seed = seed;
+    config.loop_ratio = 0.2;
+    GeneratedChart chart = ChartGenerator(config).generate();
+    Sequence seq;
+    chart.addTo(seq);
+    EXPECT_TRUE(seq.isValid()) << "seed " << seed;
+    totals.simultaneous_count += chart.simultaneous_count;
+    totals.exclusive_count += chart.exclusive_count;
+    totals.macros_count += chart.macros_count;
+    totals.loops_count += chart.loops_count;
+    // Same seed, same chart.
+    GeneratedChart again = ChartGenerator(config).generate();
+    EXPECT_EQ(again.steps_count, chart.steps_count);
+    EXPECT_EQ(again.transitions.size(), chart.transitions.size());
+  }
+  EXPECT_GT(totals.simultaneous_count, 0);
+  EXPECT_GT(totals.exclusive_count, 0);
+  EXPECT_GT(totals.macros_count, 0);
+  EXPECT_GT(totals.loops_count, 0);
+
+  // Same chart whatever the standard library.
+  GeneratorConfig pinned;
+  pinned.seed = 7;
+  GeneratedChart chart_7 = ChartGenerator(pinned).generate();
+  EXPECT_EQ(chart_7.steps_count, 57);
+  EXPECT_EQ(chart_7.transitions.size(), 59);
+  EXPECT_EQ(chart_7.simultaneous_count, 2);
+  EXPECT_EQ(chart_7.exclusive_count, 4);
+  EXPECT_EQ(chart_7.macros_count, 5);
+
+  GeneratorConfig big;
+  big.depth = 6;
+  big.length = 8;
+  big.max_steps = 500;
+  GeneratedChart chart = ChartGenerator(big).generate();
+  EXPECT_GT(chart.steps_count, 400);
+  EXPECT_LT(chart.steps_count, 550);
+  EXPECT_GT(chart.max_active_steps, 1);
+  Sequence seq;
+  chart.addTo(seq);
+  EXPECT_TRUE(seq.isValid());
+}
+
+TEST_F(SfcTest, Simulate_Generated_Chart_Random_Inputs) {
+  GeneratorConfig config;
+  config.seed = 42;
+  config.loop_ratio = 0.2;
+  GeneratedChart chart = ChartGenerator(config).generate();
+  Sequence seq;
+  chart.addTo(seq);
+  Simulation sim(seq);
+  sim.start();
+  std::mt19937 random(42);
+  uint32_t max_active = 0;
+  for (int i = 0; i < 20000; i++) {
+    auto &transition = chart.transitions[random() % chart.transitions.size()];
+    transition->setReceptivityState(!transition->getReceptivityState());
+    sim.tick();
+    auto active = sim.getActivatedSteps().size();
+    // Never lost, never more than the chart can hold.
+    ASSERT_GT(active, 0);
+    max_active = std::max<uint32_t>(max_active, active);
+  }
+  EXPECT_LE(max_active, chart.max_active_steps);
+  EXPECT_GT(sim.activationsCount(), 100);
+  sim.stop();
+}
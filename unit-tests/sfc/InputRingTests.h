@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/input/InputRing.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+TEST_F(SfcTest, Input_Ring_Push_Drain_Overflow) {
+  const std::string path = testing::TempDir() + "sfc_test.inputs";
+  std::remove(path.c_str());
+  {
+    InputRing ring(path, 3);
+    EXPECT_EQ(ring.capacity(), 4);
+    EXPECT_TRUE(ring.push(7, true));
+    EXPECT_TRUE(ring.push(1, false));
+    EXPECT_TRUE(ring.push(0xFFFFFFFF, true));
+    EXPECT_TRUE(ring.push(2, true));
+    // Full: dropped, not blocking.
+    EXPECT_FALSE(ring.push(3, true));
+    EXPECT_EQ(ring.size(), 4);
+    EXPECT_EQ(ring.droppedCount(), 1);
+
+    // Another mapping of the same file (As another process would) sees the records.
+    InputRing consumer(path, 1024);
+    EXPECT_EQ(consumer.capacity(), 4);
+    std::vector<std::pair<uint32_t, bool>> drained;
+    EXPECT_EQ(consumer.drain([&](uint32_t id, bool value) { drained.emplace_back(id, value); }), 4);
+    EXPECT_EQ(drained, (std::vector<std::pair<uint32_t, bool>>{{7, true}, {1, false}, {0xFFFFFFFF, true}, {2, true}}));
+    EXPECT_EQ(ring.size(), 0);
+    EXPECT_EQ(consumer.drain([&](uint32_t, bool) { FAIL(); }), 0);
+
+    // Slots are reused once drained.
+    for (uint32_t i = 0; i < 10; i++) {
+      EXPECT_TRUE(ring.push(i, i % 2));
+      drained.clear();
+      EXPECT_EQ(consumer.drain([&](uint32_t id, bool value) { drained.emplace_back(id, value); }), 1);
+      EXPECT_EQ(drained, (std::vector<std::pair<uint32_t, bool>>{{i, i % 2 == 1}}));
+    }
+    EXPECT_TRUE(ring.push(5, true));
+  }
+  // Kept by the file.
+  InputRing reopened(path);
+  EXPECT_EQ(reopened.capacity(), 4);
+  EXPECT_EQ(reopened.size(), 1);
+  EXPECT_EQ(reopened.droppedCount(), 1);
+  // Overrun by a producer not checking the tail: only the last 'capacity' records are drained, the others dropped.
+  {
+    const uint64_t head = 15 + 5;
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(InputRing::HEADER_SIZE);
+    file.write(reinterpret_cast<const char *>(&head), sizeof(head));
+  }
+  EXPECT_EQ(reopened.drain([](uint32_t, bool) {}), 4);
+  EXPECT_EQ(reopened.droppedCount(), 1 + 2);
+  EXPECT_EQ(reopened.size(), 0);
+  std::remove(path.c_str());
+
+  EXPECT_THROW(InputRing(testing::TempDir() + "no_such_dir/sfc_test.inputs"), std::runtime_error);
+}
+
+TEST_F(SfcTest, Simulate_Sequence_Fed_By_Input_Ring) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> a_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(a_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({a_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {a_step});
+  a_step->addTransition(t2);
+
+  const std::string path = testing::TempDir() + "sfc_test.inputs";
+  std::remove(path.c_str());
+  auto ring = std::make_shared<InputRing>(path, 16);
+  InputRing producer(path);
+  seq.setInputRing(ring);
+  EXPECT_EQ(seq.getInputRing(), ring);
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_THROW(seq.setInputRing(nullptr), std::runtime_error);
+  const CompiledChart &chart = *seq.getCompiledChart();
+  const uint32_t t1_id = chart.transitionIndex(t1.get());
+  const uint32_t t2_id = chart.transitionIndex(t2.get());
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_TRUE(producer.push(t1_id, true));
+    EXPECT_TRUE(sim.runUntil([&]() { return a_step->isActivated(); }));
+    EXPECT_TRUE(t1->getReceptivityState());
+    // Applied in order: raised then lowered within one tick does not fire.
+    EXPECT_TRUE(producer.push(t1_id, false));
+    EXPECT_TRUE(producer.push(t2_id, true));
+    EXPECT_TRUE(producer.push(t2_id, false));
+    sim.runUntilStable();
+    EXPECT_TRUE(a_step->isActivated());
+    EXPECT_FALSE(t1->getReceptivityState());
+    EXPECT_TRUE(producer.push(t2_id, true));
+    EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+    EXPECT_TRUE(producer.push(t2_id, false));
+    sim.runUntilStable();
+  }
+  // Unknown transitions are ignored.
+  EXPECT_TRUE(producer.push(1000, true));
+  sim.runUntilStable();
+  EXPECT_EQ(ring->size(), 0);
+  EXPECT_TRUE(init_step->isActivated());
+  sim.stop();
+  EXPECT_EQ(a_step->activationsCount(), 2);
+  seq.setInputRing(nullptr);
+  std::remove(path.c_str());
+}
+
+TEST_F(SfcTest, Run_Sequence_Fed_By_Input_Ring) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> a_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(a_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({a_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {a_step});
+  a_step->addTransition(t2);
+
+  const std::string path = testing::TempDir() + "sfc_test_run.inputs";
+  std::remove(path.c_str());
+  seq.setInputRing(std::make_shared<InputRing>(path, 64));
+  InputRing producer(path);
+  std::thread t_seq([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  const CompiledChart &chart = *seq.getCompiledChart();
+  const uint32_t t1_id = chart.transitionIndex(t1.get());
+  const uint32_t t2_id = chart.transitionIndex(t2.get());
+
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(producer.push(t2_id, false));
+    EXPECT_TRUE(producer.push(t1_id, true));
+    EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+    EXPECT_TRUE(producer.push(t1_id, false));
+    EXPECT_TRUE(producer.push(t2_id, true));
+    EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  }
+  seq.stop();
+  t_seq.join();
+  EXPECT_EQ(a_step->activationsCount(), 10);
+  EXPECT_EQ(producer.droppedCount(), 0);
+  seq.setInputRing(nullptr);
+  std::remove(path.c_str());
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/metrics/PrometheusExporter.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+TEST_F(SfcTest, Simulate_Metrics_And_Prometheus_Export) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  seq.addStepChangedCallback([](unsigned int, bool) {});
+
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_TRUE(sim.runUntilStable());
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+  t1->setReceptivityState(false);
+  const Metrics &metrics = seq.getMetrics();
+  EXPECT_EQ(metrics.value(Metrics::TRANSITIONS_FIRED), 1);
+  EXPECT_EQ(metrics.value(Metrics::STEPS_ACTIVATED), 2);
+  EXPECT_EQ(metrics.value(Metrics::EMPTY_POLLS), 1);
+  EXPECT_EQ(metrics.value(Metrics::TRANSITIONS_EVALUATED), 2);
+  // Init activation, then the handoff (Deactivation and activation).
+  EXPECT_EQ(metrics.value(Metrics::CALLBACKS), 3);
+
+  // Counters of other threads are summed on read.
+  Metrics shared;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&shared]() {
+      for (int j = 0; j < 1000; j++) {
+        shared.add(Metrics::TRANSITIONS_EVALUATED);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(shared.value(Metrics::TRANSITIONS_EVALUATED), 4000);
+
+  PrometheusExporter exporter;
+  exporter.addSource([&seq]() { return seq.collectMetrics("sequence=\"a\""); });
+  exporter.addSource([&seq]() { return seq.collectMetrics("sequence=\"b\""); });
+  const std::string text = exporter.text();
+  EXPECT_NE(text.find("# TYPE sfc_transitions_fired_total counter\n"
+                      "sfc_transitions_fired_total{sequence=\"a\"} 1\n"
+                      "sfc_transitions_fired_total{sequence=\"b\"} 1\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("# TYPE sfc_active_steps gauge\nsfc_active_steps{sequence=\"a\"} 1\n"), std::string::npos);
+  // One header per family.
+  EXPECT_EQ(text.find("# HELP sfc_running "), text.rfind("# HELP sfc_running "));
+
+  const std::string path = testing::TempDir() + "sfc_metrics.prom";
+  exporter.writeFile(path);
+  std::ifstream file(path);
+  std::stringstream content;
+  content << file.rdbuf();
+  EXPECT_EQ(content.str(), text);
+  std::remove(path.c_str());
+  EXPECT_THROW(exporter.writeFile("/nonexistent/sfc_metrics.prom"), std::runtime_error);
+
+  const std::string socket_path = testing::TempDir() + "sfc_metrics.sock";
+  exporter.serve(socket_path);
+  EXPECT_THROW(exporter.serve(socket_path), std::runtime_error);
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+  std::string received;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+    received.append(buffer, n);
+  }
+  ::close(fd);
+  EXPECT_EQ(received, exporter.text());
+  exporter.stopServing();
+  EXPECT_NE(::access(socket_path.c_str(), F_OK), 0);
+  sim.stop();
+}
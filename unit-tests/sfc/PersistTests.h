@@ -0,0 +1,217 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/persist/Persister.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <cstdio>
+#include <thread>
+
+TEST_F(SfcTest, Journal_Rotation_And_Reopen) {
+  const std::string path = ::testing::TempDir() + "sfc_journal_test.wal";
+  std::remove(path.c_str());
+  uint64_t generation = 0;
+  {
+    Journal journal(path, 4);
+    EXPECT_EQ(journal.capacity(), 4);
+    // No generation started yet.
+    EXPECT_FALSE(journal.append(JournalEntry::STEP, 1, 1, std::chrono::nanoseconds(1)));
+    generation = journal.rotate();
+    EXPECT_TRUE(journal.append(JournalEntry::STEP, 1, 1, std::chrono::nanoseconds(2)));
+    EXPECT_TRUE(journal.append(JournalEntry::JOIN, 7, 2, std::chrono::nanoseconds(3)));
+    EXPECT_EQ(journal.size(), 2);
+    EXPECT_EQ(journal.entries(generation).size(), 2);
+    EXPECT_EQ(journal.entries(generation, 1).front().id, 7);
+    EXPECT_EQ(journal.rotate(), generation + 1);
+    for (int i = 0; i < 5; i++) {
+      journal.append(JournalEntry::STEP, i, 0, std::chrono::nanoseconds(4));
+    }
+    EXPECT_EQ(journal.overflowCount(), 2);
+    EXPECT_FALSE(journal.overflowed(generation));
+    EXPECT_TRUE(journal.overflowed(generation + 1));
+    EXPECT_EQ(journal.entries(generation + 1).size(), 4);
+    // The previous generation is untouched.
+    EXPECT_EQ(journal.entries(generation).size(), 2);
+    journal.sync();
+  }
+  Journal journal(path, 16);
+  EXPECT_EQ(journal.capacity(), 4);
+  EXPECT_EQ(journal.entries(generation).size(), 2);
+  EXPECT_EQ(journal.entries(generation + 1).size(), 4);
+  EXPECT_TRUE(journal.overflowed(generation + 1));
+  EXPECT_EQ(journal.rotate(), generation + 3);
+  EXPECT_TRUE(journal.entries(generation + 3).empty());
+  EXPECT_FALSE(journal.overflowed(generation + 1));
+  std::remove(path.c_str());
+}
+
+TEST_F(SfcTest, Persister_Journal_Overflow) {
+  const std::string path = ::testing::TempDir() + "sfc_persist_overflow_test";
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+  {
+    Persister persister(path, 4, std::chrono::hours(1));
+    persister.setSource([]() {
+      Snapshot snapshot;
+      snapshot.fingerprint = 1;
+      return snapshot;
+    });
+    persister.checkpoint();
+    for (unsigned int i = 0; i < 6; i++) {
+      persister.stepChanged(i, true, std::chrono::nanoseconds(i));
+    }
+    EXPECT_EQ(persister.journal().overflowCount(), 2);
+    // Checkpointed at once, not at the next flush period.
+    for (int i = 0; i < 5000 && persister.checkpointsCount() < 2; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_GE(persister.checkpointsCount(), 2);
+    EXPECT_NO_THROW(persister.recover());
+    // Not checkpointed: the dropped entries are lost.
+    persister.setSource(nullptr);
+    for (unsigned int i = 0; i < 6; i++) {
+      persister.stepChanged(i, false, std::chrono::nanoseconds(i));
+    }
+    EXPECT_THROW(persister.recover(), std::runtime_error);
+  }
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+}
+
+TEST_F(SfcTest, Simulate_Persist_And_Resume_With_Join) {
+  const std::string path = ::testing::TempDir() + "sfc_persist_test";
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+  struct Chart {
+    std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+    std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+    std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+    std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+    std::shared_ptr<Transition> t1, t2, t3;
+    explicit Chart(Sequence &seq) {
+      seq.addStep(init_step);
+      seq.addStep(first_step);
+      seq.addStep(second_step);
+      seq.addStep(third_step);
+      t1 = Transition::mk_sp_transition({first_step, third_step}, {init_step});
+      init_step->addTransition(t1);
+      t2 = Transition::mk_sp_transition({second_step}, {first_step});
+      first_step->addTransition(t2);
+      t3 = Transition::mk_sp_transition({init_step}, {second_step, third_step});
+      second_step->addTransition(t3);
+      third_step->addTransition(t3);
+    }
+  };
+
+  Snapshot snapshot;
+  uint64_t fingerprint = 0;
+  {
+    Sequence seq;
+    Chart chart(seq);
+    auto persister = std::make_shared<Persister>(path, 1024);
+    EXPECT_TRUE(persister->recover().empty());
+    seq.setPersister(persister);
+    Simulation sim(seq);
+    sim.start();
+    fingerprint = seq.getCompiledChart()->fingerprint();
+    EXPECT_EQ(persister->checkpointsCount(), 1);
+    chart.t1->setReceptivityState(true);
+    EXPECT_TRUE(sim.runUntil([&]() { return chart.third_step->isActivated(); }));
+    chart.t1->setReceptivityState(false);
+    // Third step arrives first at the join.
+    chart.t3->setReceptivityState(true);
+    sim.tick();
+    EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({1}));
+    persister->checkpoint();
+    EXPECT_EQ(persister->checkpointsCount(), 2);
+    chart.t3->setReceptivityState(false);
+    // Crash: deactivations are not journaled when stopped.
+    sim.stop();
+    seq.setPersister(nullptr);
+    EXPECT_THROW(persister->checkpoint(), std::runtime_error);
+  }
+
+  auto persister = std::make_shared<Persister>(path, 1024);
+  snapshot = persister->recover();
+  EXPECT_EQ(snapshot.fingerprint, fingerprint);
+  EXPECT_EQ(snapshot.active_steps, std::vector<unsigned int>({1}));
+  EXPECT_EQ(snapshot.join_counters, (std::vector<std::pair<unsigned int, unsigned int>>({{0, 1}})));
+
+  Sequence seq;
+  Chart chart(seq);
+  Simulation sim(seq, snapshot.time);
+  EXPECT_THROW(sim.resume(Snapshot()), std::invalid_argument);
+  seq.setPersister(persister);
+  sim.resume(snapshot);
+  EXPECT_TRUE(chart.first_step->isActivated());
+  chart.t2->setReceptivityState(true);
+  chart.t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return chart.init_step->isActivated(); }));
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({0}));
+  chart.t2->setReceptivityState(false);
+  chart.t3->setReceptivityState(false);
+  EXPECT_EQ(persister->recover().active_steps, std::vector<unsigned int>({0}));
+  sim.stop();
+  seq.setPersister(nullptr);
+  persister.reset();
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Persist_And_Resume) {
+  const std::string path = ::testing::TempDir() + "sfc_persist_run_test";
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+  auto build = [](Sequence &seq, std::vector<std::shared_ptr<Transition>> &transitions) {
+    std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+    std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+    std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+    seq.addStep(init_step);
+    seq.addStep(first_step);
+    seq.addStep(second_step);
+    transitions.push_back(Transition::mk_sp_transition({first_step}, {init_step}));
+    init_step->addTransition(transitions.back());
+    transitions.push_back(Transition::mk_sp_transition({second_step}, {first_step}));
+    first_step->addTransition(transitions.back());
+    transitions.push_back(Transition::mk_sp_transition({init_step}, {second_step}));
+    second_step->addTransition(transitions.back());
+  };
+
+  {
+    Sequence seq;
+    seq.setTransitionPollingDelay(10);
+    std::vector<std::shared_ptr<Transition>> t;
+    build(seq, t);
+    seq.setPersister(std::make_shared<Persister>(path));
+    std::thread thread([&seq]() { seq.start(); });
+    waitForStep(seq, *seq.getStepById(1), *t[0]);
+    t[0]->setReceptivityState(false);
+    waitForStep(seq, *seq.getStepById(2), *t[1]);
+    t[1]->setReceptivityState(false);
+    seq.stop();
+    thread.join();
+    seq.setPersister(nullptr);
+  }
+
+  Sequence seq;
+  seq.setTransitionPollingDelay(10);
+  std::vector<std::shared_ptr<Transition>> t;
+  build(seq, t);
+  auto persister = std::make_shared<Persister>(path);
+  Snapshot snapshot = persister->recover();
+  EXPECT_EQ(snapshot.active_steps, std::vector<unsigned int>({2}));
+  seq.setPersister(persister);
+  std::thread thread([&seq, &snapshot]() { seq.resume(snapshot); });
+  waitForStep(seq, *seq.getStepById(2));
+  EXPECT_FALSE(seq.getStepById(0)->isActivated());
+  waitForStep(seq, *seq.getStepById(0), *t[2]);
+  t[2]->setReceptivityState(false);
+  seq.stop();
+  thread.join();
+  seq.setPersister(nullptr);
+  persister.reset();
+  std::remove((path + ".wal").c_str());
+  std::remove((path + ".snap").c_str());
+}
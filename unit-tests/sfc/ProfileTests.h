@@ -0,0 +1,115 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/profile/Profiler.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <cstdio>
+
+TEST_F(SfcTest, Simulate_Exclusive_Sequence_Profile) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> a_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> b_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(a_step);
+  seq.addStep(b_step);
+  std::shared_ptr<Transition> ta = Transition::mk_sp_transition({a_step}, {init_step});
+  init_step->addTransition(ta);
+  std::shared_ptr<Transition> tb = Transition::mk_sp_transition({b_step}, {init_step});
+  init_step->addTransition(tb);
+  std::shared_ptr<Transition> ta_back = Transition::mk_sp_transition({init_step}, {a_step});
+  a_step->addTransition(ta_back);
+  std::shared_ptr<Transition> tb_back = Transition::mk_sp_transition({init_step}, {b_step});
+  b_step->addTransition(tb_back);
+
+  auto profiler = std::make_shared<Profiler>();
+  seq.setProfiler(profiler);
+  EXPECT_EQ(seq.getProfiler(), profiler);
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_THROW(seq.setProfiler(nullptr), std::runtime_error);
+  for (int i = 0; i < 2; i++) {
+    // Polled a few times before firing.
+    sim.runUntilStable();
+    sim.advance(std::chrono::microseconds(300));
+    ta->setReceptivityState(true);
+    EXPECT_TRUE(sim.runUntil([&]() { return a_step->isActivated(); }));
+    ta->setReceptivityState(false);
+    ta_back->setReceptivityState(true);
+    EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+    ta_back->setReceptivityState(false);
+  }
+  sim.stop();
+
+  Profile profile = profiler->profile();
+  EXPECT_EQ(profile.runs, 1);
+  EXPECT_EQ(profile.activations[0], 3);
+  EXPECT_EQ(profile.activations[1], 2);
+  EXPECT_EQ(profile.activations[2], 0);
+  const Profile::TransitionCounts &a_counts = profile.transitions[{0, 0}];
+  const Profile::TransitionCounts &b_counts = profile.transitions[{0, 1}];
+  EXPECT_EQ(a_counts.fired, 2);
+  EXPECT_GT(a_counts.evaluations, a_counts.fired);
+  EXPECT_EQ(a_counts.nexts, std::vector<unsigned int>({1}));
+  EXPECT_EQ(b_counts.fired, 0);
+  // Evaluated after the first one: not when it fires.
+  EXPECT_EQ(b_counts.evaluations, a_counts.evaluations - a_counts.fired);
+  EXPECT_EQ(profile.transitions[Profile::TransitionKey(1, 0)].fired, 2);
+  EXPECT_EQ(profile.neverFired(), std::vector<Profile::TransitionKey>({{0, 1}}));
+
+  // Merged across runs.
+  const std::string path = testing::TempDir() + "sfc_test.profile";
+  profiler->save(path);
+  EXPECT_EQ(Profile::load(path).encode(), profile.encode());
+  Profiler next_run;
+  next_run.load(path);
+  Profile merged = next_run.profile();
+  merged.merge(profile);
+  EXPECT_EQ(merged.runs, 2);
+  EXPECT_EQ(merged.activations[0], 6);
+  EXPECT_EQ(merged.transitions[Profile::TransitionKey(0, 0)].fired, 4);
+  std::remove(path.c_str());
+
+  Profile other_chart;
+  other_chart.transitions[{0, 0}].nexts = {2};
+  EXPECT_THROW(merged.merge(other_chart), std::invalid_argument);
+  EXPECT_THROW(Profile::decode("sfc-profile 1\nstep x\n"), std::invalid_argument);
+  EXPECT_THROW(Profile::decode("not a profile\n"), std::invalid_argument);
+  EXPECT_THROW(Profile::load("/nonexistent/sfc_test.profile"), std::runtime_error);
+  profiler->clear();
+  EXPECT_EQ(profiler->profile().runs, 0);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Profile) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  auto profiler = std::make_shared<Profiler>();
+  seq.setProfiler(profiler);
+
+  std::thread thread([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  seq.stop();
+  thread.join();
+
+  Profile profile = profiler->profile();
+  EXPECT_EQ(profile.runs, 1);
+  EXPECT_EQ(profile.activations[0], 1);
+  EXPECT_EQ(profile.activations[1], 1);
+  EXPECT_EQ(profile.transitions[Profile::TransitionKey(0, 0)].fired, 1);
+  EXPECT_GT(profile.transitions[Profile::TransitionKey(0, 0)].evaluations, 1);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/record/Recorder.hpp>
+#include <sfc/record/Replayer.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <cstdio>
+#include <thread>
+
+/**
+ * @brief Loop of three steps: 0 -> 1 -> 2 -> 0.
+ * @return std::vector<std::shared_ptr<Transition>> t1, t2, t3.
+ */
+static std::vector<std::shared_ptr<Transition>> buildRecordedLoop(Sequence &seq) {
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t3);
+  return {t1, t2, t3};
+}
+
+TEST_F(SfcTest, Record_Simulated_Sequence_And_Replay) {
+  const std::string path = ::testing::TempDir() + "sfc_record_test.bin";
+  Sequence seq;
+  auto transitions = buildRecordedLoop(seq);
+  auto recorder = std::make_shared<Recorder>(path);
+  seq.setRecorder(recorder);
+  Simulation sim(seq);
+  sim.start();
+  for (int cycle = 0; cycle < 100; cycle++) {
+    for (unsigned int i = 0; i < transitions.size(); i++) {
+      sim.advance(std::chrono::milliseconds(1 + cycle % 3));
+      transitions[i]->setReceptivityState(true);
+      // Setting the same state again is not a change.
+      transitions[i]->setReceptivityState(true);
+      EXPECT_TRUE(sim.runUntil([&]() { return seq.getStepById((i + 1) % 3)->isActivated(); }));
+      transitions[i]->setReceptivityState(false);
+    }
+  }
+  sim.stop();
+  seq.setRecorder(nullptr);
+  const uint64_t events_count = recorder->eventsCount();
+  transitions[0]->setReceptivityState(true);
+  transitions[0]->setReceptivityState(false);
+  EXPECT_EQ(recorder->eventsCount(), events_count);
+
+  Recording recording = recorder->recording();
+  // Init activation, then per crossing: 2 receptivity changes and 2 steps changes.
+  EXPECT_EQ(recording.events().size(), 1 + 100 * 3 * 4);
+  EXPECT_EQ(recorder->eventsCount(), recording.events().size());
+  EXPECT_LT(recorder->bytesCount(), Recording::HEADER_SIZE + recording.events().size() * 5);
+  EXPECT_EQ(recording.inputs()[0].id, seq.getCompiledChart()->transitionIndex(transitions[0].get()));
+  EXPECT_EQ(Recording::load(path).events().size(), recording.events().size());
+  std::remove(path.c_str());
+
+  Sequence replayed;
+  buildRecordedLoop(replayed);
+  auto replay_recorder = std::make_shared<Recorder>();
+  replayed.setRecorder(replay_recorder);
+  Simulation replay_sim(replayed);
+  replay_sim.start();
+  EXPECT_EQ(Replayer(recording).replay(replay_sim), 100 * 3 * 2);
+  replay_sim.stop();
+  Recording replay_recording = replay_recorder->recording();
+  EXPECT_EQ(Recording::firstDivergence(recording.trace(), replay_recording.trace()), Recording::NPOS);
+  EXPECT_EQ(Recording::firstDivergence(recording.events(), replay_recording.events()), Recording::NPOS);
+  EXPECT_EQ(replay_recording.events().back().time - replay_recording.events().front().time,
+            recording.events().back().time - recording.events().front().time);
+
+  // A divergence is reported where it starts.
+  auto truncated = recording.trace();
+  truncated.back().state = !truncated.back().state;
+  EXPECT_EQ(Recording::firstDivergence(recording.trace(), truncated), truncated.size() - 1);
+  EXPECT_THROW(Recording::decode(reinterpret_cast<const uint8_t *>("SFCX\1"), 5), std::invalid_argument);
+}
+
+TEST_F(SfcTest, Run_Record_Unique_Sequence_And_Replay_At_Max_Speed) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(10);
+  auto transitions = buildRecordedLoop(seq);
+  auto recorder = std::make_shared<Recorder>();
+  seq.setRecorder(recorder);
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *seq.getStepById(0));
+  for (int cycle = 0; cycle < 10; cycle++) {
+    for (unsigned int i = 0; i < transitions.size(); i++) {
+      transitions[i]->setReceptivityState(true);
+      waitForStep(seq, *seq.getStepById((i + 1) % 3));
+      transitions[i]->setReceptivityState(false);
+    }
+  }
+  seq.stop();
+  t.join();
+  Recording recording = recorder->recording();
+  EXPECT_EQ(recording.inputs().size(), 10 * 3 * 2);
+
+  Sequence replayed;
+  buildRecordedLoop(replayed);
+  auto replay_recorder = std::make_shared<Recorder>();
+  replayed.setRecorder(replay_recorder);
+  Simulation sim(replayed);
+  sim.start();
+  Replayer(recording).replay(sim);
+  sim.stop();
+  EXPECT_EQ(Recording::firstDivergence(recording.trace(), replay_recorder->recording().trace()), Recording::NPOS);
+}
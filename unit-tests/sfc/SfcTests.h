@@ -6,6 +6,8 @@
 #include <sfc/transition/Receptivity.hpp>
 #include <sfc/transition/Transition.hpp>
 
+#include <algorithm>
+
 TEST_F(SfcTest, Create_Delete_Sequence) { Sequence seq; }
 
 /// @brief See 'doc/Unique_Sequence.png'
@@ -88,6 +90,16 @@ TEST_F(SfcTest, Unique_Sequence_With_Orphan_Transition) {
   EXPECT_FALSE(seq.isValid());
 }
 
+TEST_F(SfcTest, Start_Sequence_With_Unknown_Next_Step) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> unknown_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  init_step->addTransition(Transition::mk_sp_transition({unknown_step}, {init_step}));
+  EXPECT_FALSE(seq.isValid());
+  EXPECT_THROW(seq.start(), std::runtime_error);
+}
+
 TEST_F(SfcTest, Unique_Sequence_Transition_Without_Validation) {
   Sequence seq;
   std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
@@ -139,48 +151,31 @@ void seqChanged(bool state) {
 #endif
 }
 
-/// @warning Waiting on a step is not a normal-use case.
-/// We can have unfixable deadlock with std::condition_variable
-/// and segfaults with current implementation...if polling to fast...
-/// Need to be improved...
-
 const unsigned int default_transition_poll_delay = Sequence().getTransitionPollingDelay();
 
-void waitForStep(Step &step) {
+void waitForStep(Sequence &seq, Step &step) {
 #ifdef DEBUG_MODE
   std::cout << "Waiting for step ! (#" << step.getStepId() << ")" << std::endl;
 #endif
-  while (!step.isActivated()) {
-    std::this_thread::sleep_for(
-        std::chrono::microseconds(default_transition_poll_delay * 3)); // be nice with all those async stuff...
-  }
+  seq.awaitStep(step.getStepId());
 }
 
-void waitForStep(Step &step, Transition &t) {
+void waitForStep(Sequence &seq, Step &step, Transition &t) {
 #ifdef DEBUG_MODE
   std::cout << "Waiting for step ! (#" << step.getStepId() << ")" << std::endl;
 #endif
   t.setReceptivityState(true); // Set the needed transition state to true.
-  while (!step.isActivated()) {
-    std::this_thread::sleep_for(
-        std::chrono::microseconds(default_transition_poll_delay * 3)); // be nice with all those async stuff...
-  }
+  seq.awaitStep(step.getStepId());
 }
 
-void waitForSteps(std::vector<std::shared_ptr<Step>> steps, std::vector<std::shared_ptr<Transition>> trans) {
-  bool ret = true;
+void waitForSteps(Sequence &seq, std::vector<std::shared_ptr<Step>> steps, std::vector<std::shared_ptr<Transition>> trans) {
   for (auto &t : trans) {
     t->setReceptivityState(true); // Set the needed transition state to true.
   }
-  for (auto &&step : steps) {
-    ret &= step->isActivated();
-  }
-  while (!ret) {
-    ret = true;
-    for (auto &&step : steps) {
-      ret &= step->isActivated();
-    }
-  }
+  seq.awaitSituation([&steps](const Situation &situation) {
+    return std::all_of(steps.begin(), steps.end(),
+                       [&situation](const auto &step) { return situation.isActivated(step->getStepId()); });
+  });
 }
 
 TEST_F(SfcTest, Copy_Sequence) {
@@ -291,12 +286,12 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_One_Action) {
   callback_called = false;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);       // Wait for step activation.
-  waitForStep(*first_step, *t1); // Wait for step activation.
+  waitForStep(seq, *init_step);       // Wait for step activation.
+  waitForStep(seq, *first_step, *t1); // Wait for step activation.
   t1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t3); // Wait for step activation.
+  waitForStep(seq, *init_step, *t3); // Wait for step activation.
   t3->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -332,12 +327,12 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_Two_Actions) {
   callback_called = false;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);       // Wait for step activation.
-  waitForStep(*first_step, *t1); // Wait for step activation.
+  waitForStep(seq, *init_step);       // Wait for step activation.
+  waitForStep(seq, *first_step, *t1); // Wait for step activation.
   t1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t3); // Wait for step activation.
+  waitForStep(seq, *init_step, *t3); // Wait for step activation.
   t3->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -372,20 +367,20 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_One_Action_Two_Loops) {
   callback_called = false;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);       // Wait for step activation.
-  waitForStep(*first_step, *t1); // Wait for step activation.
+  waitForStep(seq, *init_step);       // Wait for step activation.
+  waitForStep(seq, *first_step, *t1); // Wait for step activation.
   t1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t3); // Wait for step activation.
+  waitForStep(seq, *init_step, *t3); // Wait for step activation.
   t3->setReceptivityState(false);
   EXPECT_TRUE(callback_called);
   callback_called = false;
-  waitForStep(*first_step, *t1); // Wait for step activation.
+  waitForStep(seq, *first_step, *t1); // Wait for step activation.
   t1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t3); // Wait for step activation.
+  waitForStep(seq, *init_step, *t3); // Wait for step activation.
   t3->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -428,12 +423,12 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_Action_At_Each_Step) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);       // Wait for step activation.
-  waitForStep(*first_step, *t1); // Wait for step activation.
+  waitForStep(seq, *init_step);       // Wait for step activation.
+  waitForStep(seq, *first_step, *t1); // Wait for step activation.
   t1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t3); // Wait for step activation.
+  waitForStep(seq, *init_step, *t3); // Wait for step activation.
   t3->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -472,15 +467,15 @@ TEST_F(SfcTest, Run_Simultaneous_Sequence_Two_Branch) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step); // Wait for step activation (+1)
-  waitForSteps({first_step, second_step}, {t1});
+  waitForStep(seq, *init_step); // Wait for step activation (+1)
+  waitForSteps(seq, {first_step, second_step}, {t1});
   t1->setReceptivityState(false);
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation
+  waitForStep(seq, *init_step, *t2); // Wait for step activation
   t2->setReceptivityState(false);
-  waitForSteps({first_step, second_step}, {t1});
+  waitForSteps(seq, {first_step, second_step}, {t1});
   t1->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation
+  waitForStep(seq, *init_step, *t2); // Wait for step activation
   t2->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -533,31 +528,31 @@ TEST_F(SfcTest, Run_Simultaneous_Sequence_Two_Branch_Looping_On_NonInitStep) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step); // Wait for step activation (+1)
-  waitForSteps({first_step, second_step}, {t1});
+  waitForStep(seq, *init_step); // Wait for step activation (+1)
+  waitForSteps(seq, {first_step, second_step}, {t1});
   t1->setReceptivityState(false);
   t2->setReceptivityState(false);
-  waitForStep(*after_first_step, *t11); // Wait for step activation
+  waitForStep(seq, *after_first_step, *t11); // Wait for step activation
   t11->setReceptivityState(false);
-  waitForStep(*first_step, *t111); // Wait for step activation
+  waitForStep(seq, *first_step, *t111); // Wait for step activation
   t111->setReceptivityState(false);
-  waitForStep(*after_first_step, *t11); // Wait for step activation
+  waitForStep(seq, *after_first_step, *t11); // Wait for step activation
   t11->setReceptivityState(false);
-  waitForStep(*join_step, *t112); // Wait for step activation
+  waitForStep(seq, *join_step, *t112); // Wait for step activation
   t112->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation
+  waitForStep(seq, *init_step, *t2); // Wait for step activation
   t2->setReceptivityState(false);
-  waitForSteps({first_step, second_step}, {t1});
+  waitForSteps(seq, {first_step, second_step}, {t1});
   t1->setReceptivityState(false);
-  waitForStep(*after_first_step, *t11); // Wait for step activation
+  waitForStep(seq, *after_first_step, *t11); // Wait for step activation
   t11->setReceptivityState(false);
-  waitForStep(*first_step, *t111); // Wait for step activation
+  waitForStep(seq, *first_step, *t111); // Wait for step activation
   t111->setReceptivityState(false);
-  waitForStep(*after_first_step, *t11); // Wait for step activation
+  waitForStep(seq, *after_first_step, *t11); // Wait for step activation
   t11->setReceptivityState(false);
-  waitForStep(*join_step, *t112); // Wait for step activation
+  waitForStep(seq, *join_step, *t112); // Wait for step activation
   t112->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation
+  waitForStep(seq, *init_step, *t2); // Wait for step activation
   t2->setReceptivityState(false);
 
   seq.stop();
@@ -605,13 +600,13 @@ TEST_F(SfcTest, Run_Exclusive_Sequence_Two_Branches) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step); // Wait for step activation (+1)
+  waitForStep(seq, *init_step); // Wait for step activation (+1)
   /// Go left branch. Check count.
-  waitForStep(*first_step, *t1); // Wait for step activation. Step 1 only. (+1)
+  waitForStep(seq, *first_step, *t1); // Wait for step activation. Step 1 only. (+1)
   EXPECT_TRUE(first_step->isActivated());
   EXPECT_FALSE(second_step->isActivated());
   t1->setReceptivityState(false);
-  waitForStep(*init_step, *t11); // Wait for step activation. Back to Init Step. (+1)
+  waitForStep(seq, *init_step, *t11); // Wait for step activation. Back to Init Step. (+1)
   t11->setReceptivityState(false);
   EXPECT_TRUE(callback_called);
   EXPECT_EQ(callback_called_count, 3);
@@ -619,11 +614,11 @@ TEST_F(SfcTest, Run_Exclusive_Sequence_Two_Branches) {
   callback_called = false;
 
   /// Go right branch. Check count.
-  waitForStep(*second_step, *t2); // Wait for step activation. Step 2 only. (+1)
+  waitForStep(seq, *second_step, *t2); // Wait for step activation. Step 2 only. (+1)
   EXPECT_FALSE(first_step->isActivated());
   EXPECT_TRUE(second_step->isActivated());
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t22); // Wait for step activation. Back to Init Step. (+1)
+  waitForStep(seq, *init_step, *t22); // Wait for step activation. Back to Init Step. (+1)
   t22->setReceptivityState(false);
 
   seq.stop();
@@ -666,15 +661,15 @@ TEST_F(SfcTest, Run_Simultaneous_Sequence_Three_Branches) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);                                   // Wait for step activation (+1)
-  waitForSteps({first_step, second_step, third_step}, {t1}); // Step 1&2&3 simultaneously. (+3)
+  waitForStep(seq, *init_step);                                   // Wait for step activation (+1)
+  waitForSteps(seq, {first_step, second_step, third_step}, {t1}); // Step 1&2&3 simultaneously. (+3)
   t1->setReceptivityState(false);
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation. Go back to Init Step (+1)
+  waitForStep(seq, *init_step, *t2); // Wait for step activation. Go back to Init Step (+1)
   t2->setReceptivityState(false);
-  waitForSteps({first_step, second_step, third_step}, {t1});
+  waitForSteps(seq, {first_step, second_step, third_step}, {t1});
   t1->setReceptivityState(false);
-  waitForStep(*init_step, *t2); // Wait for step activation. Back to Init (+1)
+  waitForStep(seq, *init_step, *t2); // Wait for step activation. Back to Init (+1)
   t2->setReceptivityState(false);
 
   seq.stop();
@@ -729,14 +724,14 @@ TEST_F(SfcTest, Run_Exclusive_Sequence_Three_Branches) {
   callback_called_count = 0;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step); // Wait for step activation (+1)
+  waitForStep(seq, *init_step); // Wait for step activation (+1)
   /// Go left branch. Check count.
-  waitForStep(*first_step, *t1); // Wait for step activation. Step 1 only. (+1)
+  waitForStep(seq, *first_step, *t1); // Wait for step activation. Step 1 only. (+1)
   EXPECT_TRUE(first_step->isActivated());
   EXPECT_FALSE(second_step->isActivated());
   EXPECT_FALSE(third_step->isActivated());
   t1->setReceptivityState(false);
-  waitForStep(*init_step, *t11); // Wait for step activation. Back to Init Step. (+1)
+  waitForStep(seq, *init_step, *t11); // Wait for step activation. Back to Init Step. (+1)
   t11->setReceptivityState(false);
   EXPECT_TRUE(callback_called);
   EXPECT_EQ(callback_called_count, 3);
@@ -744,12 +739,12 @@ TEST_F(SfcTest, Run_Exclusive_Sequence_Three_Branches) {
   callback_called = false;
 
   /// Go right branch. Check count.
-  waitForStep(*second_step, *t2); // Wait for step activation. Step 2 only. (+1)
+  waitForStep(seq, *second_step, *t2); // Wait for step activation. Step 2 only. (+1)
   EXPECT_FALSE(first_step->isActivated());
   EXPECT_TRUE(second_step->isActivated());
   EXPECT_FALSE(third_step->isActivated());
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *t22); // Wait for step activation. Back to Init Step. (+1)
+  waitForStep(seq, *init_step, *t22); // Wait for step activation. Back to Init Step. (+1)
   t22->setReceptivityState(false);
   EXPECT_TRUE(callback_called);
   EXPECT_EQ(callback_called_count, 5);
@@ -757,12 +752,12 @@ TEST_F(SfcTest, Run_Exclusive_Sequence_Three_Branches) {
   callback_called = false;
 
   /// Go last branch. Check count.
-  waitForStep(*third_step, *t3); // Wait for step activation. Step 3 only. (+1)
+  waitForStep(seq, *third_step, *t3); // Wait for step activation. Step 3 only. (+1)
   EXPECT_FALSE(first_step->isActivated());
   EXPECT_FALSE(second_step->isActivated());
   EXPECT_TRUE(third_step->isActivated());
   t3->setReceptivityState(false);
-  waitForStep(*init_step, *t33); // Wait for step activation. Back to Init Step. (+1)
+  waitForStep(seq, *init_step, *t33); // Wait for step activation. Back to Init Step. (+1)
   t33->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -931,7 +926,7 @@ TEST_F(SfcTest, Detect_And_Stop_Cray_Parallelism) {
     }
   });
 
-  waitForStep(*init_step);
+  waitForStep(seq, *init_step);
   t1->setReceptivityState(true);
   uint32_t watchdog_counter = 0;
   while (seq.isRunning() && watchdog_counter++ < 100) {
@@ -988,7 +983,7 @@ TEST_F(SfcTest, Detect_And_Stop_Crazy_Looping_Sequence) {
     }
   });
 
-  waitForStep(*init_step);
+  waitForStep(seq, *init_step);
   EXPECT_TRUE(seq.isRunning());
 
   t1->setReceptivityState(true);
@@ -1037,12 +1032,12 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_One_Macro) {
   callback_called = false;
   std::thread t([&seq]() { seq.start(); });
 
-  waitForStep(*init_step);        // Wait for step activation.
-  waitForStep(*first_step, *mt1); // Wait for step activation.
+  waitForStep(seq, *init_step);        // Wait for step activation.
+  waitForStep(seq, *first_step, *mt1); // Wait for step activation.
   mt1->setReceptivityState(false);
-  waitForStep(*second_step, *t2); // Wait for step activation.
+  waitForStep(seq, *second_step, *t2); // Wait for step activation.
   t2->setReceptivityState(false);
-  waitForStep(*init_step, *mt2); // Wait for step activation.
+  waitForStep(seq, *init_step, *mt2); // Wait for step activation.
   mt2->setReceptivityState(false);
   seq.stop();
   t.join();
@@ -1050,5 +1045,148 @@ TEST_F(SfcTest, Run_Unique_Sequence_With_One_Macro) {
   callback_called = false;
 }
 
-/// @todo Forbid to use "in parallel" the same macro in the same sequence ?
-// TEST_F(SfcTest, Run_Unique_Sequence_With_Two_Times_The_Same_Macro) { FAIL(); }
\ No newline at end of file
+TEST_F(SfcTest, Run_Unique_Sequence_With_Two_Times_The_Same_Macro) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  // Definition, never added as is.
+  std::shared_ptr<Macro> macro = std::make_shared<Macro>(10);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  macro->addStep(first_step);
+  macro->addStep(second_step);
+  std::shared_ptr<Transition> t = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t);
+  first_step->addStepAction(std::make_unique<StepAction>(action_callback));
+
+  std::shared_ptr<Macro> macro_a = macro->instantiate(20, 100);
+  std::shared_ptr<Macro> macro_b = macro->instantiate(30, 200);
+  EXPECT_EQ(macro_a->first()->getStepId(), 101);
+  EXPECT_EQ(macro_b->last()->getStepId(), 202);
+  EXPECT_EQ(macro_a->first()->getActions(), first_step->getActions());
+  std::shared_ptr<Transition> ta = macro_a->transition(t);
+  std::shared_ptr<Transition> tb = macro_b->transition(t);
+  ASSERT_TRUE(ta && tb);
+  EXPECT_NE(ta, tb);
+  seq.addStep(init_step);
+  seq.addStep(macro_a);
+  seq.addStep(macro_b);
+  EXPECT_THROW(seq.addStep(macro->instantiate(40, 100)), std::invalid_argument);
+
+  std::shared_ptr<Transition> mt1 = Transition::mk_sp_transition({macro_a}, {init_step});
+  init_step->addTransition(mt1);
+  std::shared_ptr<Transition> mt2 = Transition::mk_sp_transition({macro_b}, {macro_a});
+  macro_a->addTransition(mt2);
+  std::shared_ptr<Transition> mt3 = Transition::mk_sp_transition({init_step}, {macro_b});
+  macro_b->addTransition(mt3);
+  EXPECT_TRUE(seq.isValid());
+
+  callback_called = false;
+  std::thread thread([&seq]() { seq.start(); });
+  waitForStep(seq, *macro_a->first(), *mt1);
+  mt1->setReceptivityState(false);
+  EXPECT_TRUE(callback_called);
+  // Only the first instance's transition is crossable.
+  tb->setReceptivityState(true);
+  waitForStep(seq, *macro_a->last(), *ta);
+  ta->setReceptivityState(false);
+  EXPECT_FALSE(macro_b->isActivated());
+  waitForStep(seq, *macro_b->last(), *mt2);
+  mt2->setReceptivityState(false);
+  tb->setReceptivityState(false);
+  EXPECT_TRUE(seq.awaitStep(20, false, std::chrono::seconds(5)));
+  waitForStep(seq, *init_step, *mt3);
+  mt3->setReceptivityState(false);
+  EXPECT_TRUE(seq.awaitStep(30, false, std::chrono::seconds(5)));
+  EXPECT_FALSE(first_step->isActivated());
+  seq.stop();
+  thread.join();
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Step_Times) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(50);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::thread thread([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  for (int i = 0; i < 3; i++) {
+    t1->setReceptivityState(true);
+    EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+    t1->setReceptivityState(false);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_GE(seq.getStepElapsed(1), std::chrono::milliseconds(20));
+    t2->setReceptivityState(true);
+    EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+    t2->setReceptivityState(false);
+  }
+  EXPECT_TRUE(seq.awaitStep(1, false, std::chrono::seconds(5)));
+  EXPECT_EQ(seq.getStepElapsed(1), std::chrono::nanoseconds(0));
+  seq.stop();
+  thread.join();
+
+  DwellHistogram dwell = seq.getStepDwell(1);
+  EXPECT_EQ(dwell.count, 3);
+  EXPECT_GE(dwell.mean(), std::chrono::milliseconds(20));
+  EXPECT_GE(dwell.max, dwell.mean());
+  EXPECT_GE(dwell.quantile(0.5), std::chrono::milliseconds(16));
+  // Deactivated at stop.
+  EXPECT_EQ(seq.getStepDwell(0).count, 4);
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_With_Predicates) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(50);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  // One input, read by the engine itself: on at step #0, off at step #1.
+  std::atomic_bool input(false);
+  t1->setPredicate([&input]() { return input.load(); }, std::chrono::milliseconds(1));
+  t2->setPredicate([&input]() { return !input.load(); }, std::chrono::milliseconds(1));
+
+  std::thread thread([&seq]() { seq.start(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  for (int i = 0; i < 5; i++) {
+    input = true;
+    EXPECT_TRUE(seq.awaitStep(1, true, std::chrono::seconds(5)));
+    input = false;
+    EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  }
+  seq.stop();
+  thread.join();
+  EXPECT_EQ(first_step->activationsCount(), 5);
+  EXPECT_GE(seq.getMetrics().value(Metrics::PREDICATES_SAMPLED), 20);
+  t1->setPredicate(nullptr);
+  t2->setPredicate(nullptr);
+}
+TEST_F(SfcTest, Instantiate_Macro_With_Predicate) {
+  std::shared_ptr<Macro> macro = std::make_shared<Macro>(10);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  macro->addStep(first_step);
+  macro->addStep(second_step);
+  std::shared_ptr<Transition> t = Transition::mk_sp_transition({second_step}, {first_step});
+  t->setPredicate([]() { return true; }, std::chrono::milliseconds(5));
+  first_step->addTransition(t);
+
+  std::shared_ptr<Transition> instance_t = macro->instantiate(20, 100)->transition(t);
+  ASSERT_TRUE(instance_t);
+  EXPECT_TRUE(instance_t->hasPredicate());
+  EXPECT_EQ(instance_t->getSamplingPeriod(), std::chrono::milliseconds(5));
+  // Own receptivity, same condition.
+  EXPECT_TRUE(instance_t->sample());
+  EXPECT_FALSE(t->getReceptivityState());
+}
@@ -0,0 +1,386 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/step/action/StepAction.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <thread>
+
+TEST_F(SfcTest, Simulate_Unique_Sequence) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(100);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t3);
+  int32_t actions_count = 0;
+  init_step->addStepAction(std::make_shared<StepAction>([&actions_count]() { actions_count++; }));
+  std::vector<std::pair<unsigned int, bool>> trace;
+  seq.addStepChangedCallback([&trace](unsigned int id, bool state) { trace.emplace_back(id, state); });
+
+  Simulation sim(seq);
+  EXPECT_THROW(sim.start(9999), std::invalid_argument);
+  EXPECT_FALSE(seq.isRunning());
+  sim.start();
+  EXPECT_TRUE(seq.isRunning());
+  EXPECT_TRUE(init_step->isActivated());
+  EXPECT_EQ(seq.getClock(), sim.getClock());
+  EXPECT_THROW(seq.start(), std::runtime_error);
+
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+  EXPECT_EQ(sim.now(), std::chrono::microseconds(100));
+  t1->setReceptivityState(false);
+
+  // Nothing can evolve: one hour is simulated at once.
+  sim.advance(std::chrono::hours(1));
+  EXPECT_TRUE(first_step->isActivated());
+  EXPECT_EQ(sim.now(), std::chrono::hours(1) + std::chrono::microseconds(100));
+
+  t2->setReceptivityState(true);
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  EXPECT_FALSE(second_step->isActivated());
+  t2->setReceptivityState(false);
+  t3->setReceptivityState(false);
+  EXPECT_TRUE(sim.runUntilStable());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({0}));
+  EXPECT_EQ(sim.firedCount(), 3);
+  EXPECT_EQ(sim.activationsCount(), 4);
+  EXPECT_EQ(actions_count, 2);
+
+  sim.stop();
+  EXPECT_FALSE(seq.isRunning());
+  EXPECT_FALSE(init_step->isActivated());
+  EXPECT_NE(seq.getClock(), sim.getClock());
+  std::vector<std::pair<unsigned int, bool>> expected_trace = {{0, true}, {0, false}, {1, true}, {1, false},
+                                                               {2, true}, {2, false}, {0, true}};
+  EXPECT_EQ(trace, expected_trace);
+}
+
+TEST_F(SfcTest, Simulate_Simultaneous_Sequence_Is_Deterministic) {
+  auto simulate = []() {
+    Sequence seq;
+    std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+    std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+    std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+    std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+    seq.addStep(init_step);
+    seq.addStep(first_step);
+    seq.addStep(second_step);
+    seq.addStep(third_step);
+    std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step, third_step}, {init_step});
+    init_step->addTransition(t1);
+    std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step, second_step, third_step});
+    first_step->addTransition(t2);
+    second_step->addTransition(t2);
+    third_step->addTransition(t2);
+    std::vector<std::pair<unsigned int, bool>> trace;
+    seq.addStepChangedCallback([&trace](unsigned int id, bool state) { trace.emplace_back(id, state); });
+
+    Simulation sim(seq);
+    sim.start();
+    for (int i = 0; i < 1000; i++) {
+      t1->setReceptivityState(true);
+      EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated() && third_step->isActivated(); }));
+      EXPECT_TRUE(second_step->isActivated());
+      t1->setReceptivityState(false);
+      t2->setReceptivityState(true);
+      EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+      t2->setReceptivityState(false);
+    }
+    EXPECT_EQ(sim.activationsCount(), 4001);
+    sim.stop();
+    return trace;
+  };
+  auto trace = simulate();
+  EXPECT_EQ(trace.size(), 8001);
+  EXPECT_EQ(trace, simulate());
+}
+
+TEST_F(SfcTest, Simulate_Exclusive_Sequence_With_Macro) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Macro> macro_step = std::make_shared<Macro>(12);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  macro_step->addStep(first_step);
+  macro_step->addStep(second_step);
+  seq.addStep(init_step);
+  seq.addStep(macro_step);
+  seq.addStep(third_step);
+  std::shared_ptr<Transition> mt1 = Transition::mk_sp_transition({macro_step}, {init_step});
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({third_step}, {init_step});
+  init_step->addTransition(mt1);
+  init_step->addTransition(t3);
+  std::shared_ptr<Transition> mt2 = Transition::mk_sp_transition({init_step}, {macro_step});
+  macro_step->addTransition(mt2);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t2);
+  std::shared_ptr<Transition> t33 = Transition::mk_sp_transition({init_step}, {third_step});
+  third_step->addTransition(t33);
+  EXPECT_TRUE(seq.isValid());
+
+  Simulation sim(seq);
+  sim.start();
+  // Both exclusive transitions are true: the first added one wins.
+  mt1->setReceptivityState(true);
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+  EXPECT_TRUE(macro_step->isActivated());
+  EXPECT_FALSE(third_step->isActivated());
+  mt1->setReceptivityState(false);
+  t3->setReceptivityState(false);
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return second_step->isActivated(); }));
+  t2->setReceptivityState(false);
+  mt2->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  EXPECT_FALSE(macro_step->isActivated());
+  mt2->setReceptivityState(false);
+  t3->setReceptivityState(true);
+  EXPECT_TRUE(sim.runUntil([&]() { return third_step->isActivated(); }));
+  EXPECT_FALSE(sim.runUntil([&]() { return init_step->isActivated(); }, std::chrono::seconds(10)));
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({3}));
+}
+
+TEST_F(SfcTest, Simulate_Synchronous_Evolution) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  seq.addStep(third_step);
+  std::shared_ptr<Transition> t0 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t0);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({second_step, third_step}, {first_step});
+  first_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {second_step, third_step});
+  second_step->addTransition(t2);
+  third_step->addTransition(t2);
+  std::vector<std::pair<unsigned int, bool>> trace;
+  seq.addStepChangedCallback([&trace](unsigned int id, bool state) { trace.emplace_back(id, state); });
+
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_TRUE(sim.evolve());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({0}));
+  // Step #1 is transient: crossed through in the same evolution, at the same instant.
+  t0->setReceptivityState(true);
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.evolve());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({2, 3}));
+  EXPECT_EQ(sim.transientCount(), 1);
+  EXPECT_EQ(sim.evolutionsCount(), 2);
+  EXPECT_EQ(sim.ticksCount(), 0);
+  EXPECT_EQ(sim.now(), std::chrono::nanoseconds(0));
+  EXPECT_EQ(first_step->activationsCount(), 1);
+  std::vector<std::pair<unsigned int, bool>> expected_trace = {{0, true}, {0, false}, {1, true},
+                                                               {1, false}, {2, true}, {3, true}};
+  EXPECT_EQ(trace, expected_trace);
+  // Both simultaneous branches cross together, then the loop never stabilizes.
+  t2->setReceptivityState(true);
+  EXPECT_FALSE(sim.evolve(10));
+  EXPECT_TRUE(seq.isRunning());
+  t1->setReceptivityState(false);
+  EXPECT_TRUE(sim.evolve());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({1}));
+  // Ticks still evolve one polling period at a time.
+  t0->setReceptivityState(false);
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(sim.tick());
+  EXPECT_EQ(sim.getActivatedSteps(), std::vector<unsigned int>({2, 3}));
+  sim.stop();
+}
+
+TEST_F(SfcTest, Run_Synchronous_Evolution) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(100);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t0 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t0);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({second_step}, {first_step});
+  first_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t2);
+
+  Simulation sim(seq);
+  sim.start();
+  std::thread engine([&sim]() { sim.runSynchronous(); });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  t1->setReceptivityState(true);
+  t0->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(2, true, std::chrono::seconds(5)));
+  t0->setReceptivityState(false);
+  t1->setReceptivityState(false);
+  seq.stop();
+  engine.join();
+  EXPECT_FALSE(seq.isRunning());
+  EXPECT_EQ(first_step->activationsCount(), 1);
+  EXPECT_EQ(sim.transientCount(), 1);
+  EXPECT_GT(sim.now(), std::chrono::nanoseconds(0));
+  // Stopped: back to the sequence clock.
+  EXPECT_NE(seq.getClock(), sim.getClock());
+}
+
+TEST_F(SfcTest, Simulate_Step_Activation_Times_And_Dwell) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1000);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  EXPECT_EQ(seq.getStepElapsed(0), std::chrono::nanoseconds(0));
+  EXPECT_EQ(seq.getStepDwell(0).count, 0);
+
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_THROW(seq.getStepElapsed(42), std::invalid_argument);
+  sim.advance(std::chrono::milliseconds(10));
+  EXPECT_EQ(seq.getStepElapsed(0), std::chrono::milliseconds(10));
+  EXPECT_EQ(seq.getStepElapsed(1), std::chrono::nanoseconds(0));
+  // Step #1 stays active 3ms, then 100ms.
+  for (auto dwell : {std::chrono::milliseconds(3), std::chrono::milliseconds(100)}) {
+    t1->setReceptivityState(true);
+    EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }));
+    t1->setReceptivityState(false);
+    sim.advance(dwell - std::chrono::milliseconds(1));
+    EXPECT_EQ(seq.getStepElapsed(1), dwell);
+    t2->setReceptivityState(true);
+    EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+    t2->setReceptivityState(false);
+  }
+  DwellHistogram dwell = seq.getStepDwell(1);
+  EXPECT_EQ(dwell.count, 2);
+  EXPECT_EQ(dwell.total, std::chrono::milliseconds(103));
+  EXPECT_EQ(dwell.max, std::chrono::milliseconds(100));
+  EXPECT_EQ(dwell.mean(), std::chrono::microseconds(51500));
+  EXPECT_EQ(dwell.buckets[DwellHistogram::bucket(std::chrono::milliseconds(3))], 1);
+  EXPECT_EQ(dwell.quantile(0.5), std::chrono::microseconds(4096));
+  EXPECT_EQ(dwell.quantile(1), std::chrono::milliseconds(100));
+  EXPECT_EQ(seq.getStepDwell(0).count, 2);
+  sim.stop();
+  // Stopped: kept until the next start.
+  EXPECT_EQ(seq.getStepDwell(0).count, 3);
+  EXPECT_EQ(seq.getStepElapsed(0), std::chrono::nanoseconds(0));
+
+  EXPECT_EQ(DwellHistogram::bucket(std::chrono::nanoseconds(999)), 0);
+  EXPECT_EQ(DwellHistogram::bucket(std::chrono::microseconds(1)), 1);
+  EXPECT_EQ(DwellHistogram::bucket(std::chrono::microseconds(3)), 2);
+  EXPECT_EQ(DwellHistogram::bucket(std::chrono::hours(24)), DwellHistogram::BUCKETS_COUNT - 1);
+}
+
+TEST_F(SfcTest, Simulate_Sampled_Predicates) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1000);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  std::atomic_bool a(false), b(false);
+  uint32_t a_reads = 0, b_reads = 0;
+  t1->setPredicate(
+      [&]() {
+        a_reads++;
+        return a.load();
+      },
+      std::chrono::milliseconds(5));
+  t2->setPredicate([&]() {
+    b_reads++;
+    return b.load();
+  });
+  EXPECT_TRUE(t1->hasPredicate());
+  EXPECT_EQ(t1->getSamplingPeriod(), std::chrono::milliseconds(5));
+  EXPECT_EQ(t2->getSamplingPeriod(), std::chrono::microseconds(0));
+
+  Simulation sim(seq);
+  sim.start();
+  for (int i = 0; i < 10; i++) {
+    EXPECT_FALSE(sim.tick());
+  }
+  // Every 5ms, and at every polling.
+  EXPECT_EQ(a_reads, 2);
+  EXPECT_EQ(b_reads, 10);
+  EXPECT_EQ(seq.getMetrics().value(Metrics::PREDICATES_SAMPLED), 12);
+  a = true;
+  EXPECT_TRUE(sim.tick());
+  EXPECT_TRUE(first_step->isActivated());
+  EXPECT_EQ(sim.now(), std::chrono::milliseconds(11));
+  // Sampled state: kept until the next sampling.
+  a = false;
+  EXPECT_TRUE(t1->getReceptivityState());
+  while (sim.now() < std::chrono::milliseconds(16)) {
+    EXPECT_FALSE(sim.tick());
+  }
+  EXPECT_FALSE(t1->getReceptivityState());
+  EXPECT_EQ(a_reads, 4);
+  b = true;
+  EXPECT_TRUE(sim.runUntil([&]() { return init_step->isActivated(); }));
+  EXPECT_TRUE(sim.runUntilStable());
+  EXPECT_TRUE(init_step->isActivated());
+  sim.stop();
+
+  t1->setPredicate(nullptr);
+  EXPECT_FALSE(t1->hasPredicate());
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(t1->sample());
+}
+
+TEST_F(SfcTest, Simulate_Timed_Predicate) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1000);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  first_step->addTransition(Transition::mk_sp_transition({init_step}, {first_step}));
+  Simulation sim(seq);
+  t1->setPredicate([&sim]() { return sim.now() >= std::chrono::milliseconds(50); }, std::chrono::milliseconds(10));
+
+  sim.start();
+  // Idle ticks jump to the next sampling, not to the end.
+  sim.advance(std::chrono::seconds(1));
+  EXPECT_EQ(sim.now(), std::chrono::seconds(1));
+  EXPECT_TRUE(first_step->isActivated());
+  EXPECT_EQ(seq.getStepElapsed(1), std::chrono::milliseconds(950));
+  // One tick per sampling period, and the one following the crossing.
+  EXPECT_EQ(sim.ticksCount(), 101);
+  sim.stop();
+
+  sim.getClock()->advanceTo(std::chrono::seconds(2));
+  t1->setPredicate([&sim]() { return sim.now() >= std::chrono::milliseconds(2050); }, std::chrono::milliseconds(10));
+  sim.start();
+  EXPECT_TRUE(sim.runUntil([&]() { return first_step->isActivated(); }, std::chrono::seconds(1)));
+  EXPECT_EQ(sim.now(), std::chrono::milliseconds(2051));
+  sim.stop();
+  t1->setPredicate(nullptr);
+}
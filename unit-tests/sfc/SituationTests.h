@@ -0,0 +1,189 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/Simulation.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <thread>
+
+TEST_F(SfcTest, Simulate_Situation_Snapshot) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step, second_step});
+  first_step->addTransition(t2);
+  second_step->addTransition(t2);
+
+  Situation situation = seq.getSituation();
+  EXPECT_EQ(situation.chart, nullptr);
+  EXPECT_TRUE(situation.getActivatedSteps().empty());
+
+  Simulation sim(seq);
+  sim.start();
+  situation = seq.getSituation();
+  EXPECT_EQ(situation.chart, seq.getCompiledChart());
+  EXPECT_EQ(situation.getActivatedSteps(), std::vector<unsigned int>({0}));
+  EXPECT_FALSE(situation.getReceptivityState(t1.get()));
+
+  t1->setReceptivityState(true);
+  Situation changed;
+  EXPECT_TRUE(seq.tryGetSituation(changed));
+  EXPECT_GT(changed.epoch, situation.epoch);
+  EXPECT_TRUE(changed.getReceptivityState(t1.get()));
+  EXPECT_TRUE(changed.isActivated(0));
+
+  sim.tick();
+  t1->setReceptivityState(false);
+  situation = seq.getSituation();
+  EXPECT_EQ(situation.getActivatedSteps(), std::vector<unsigned int>({1, 2}));
+  EXPECT_FALSE(situation.isActivated(0));
+  EXPECT_FALSE(situation.isActivated(9999));
+  EXPECT_FALSE(situation.getReceptivityState(t1.get()));
+  sim.stop();
+  EXPECT_TRUE(seq.getSituation().getActivatedSteps().empty());
+}
+
+TEST_F(SfcTest, Simulate_Situation_Read_While_Writing) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  Simulation sim(seq);
+  sim.start();
+
+  SituationPublisher publisher;
+  publisher.reset(seq.getCompiledChart());
+  const Situation closed = publisher.read();
+  EXPECT_EQ(closed.getActivatedSteps(), std::vector<unsigned int>({0}));
+  // A write section left open: readers get the last closed snapshot, without waiting.
+  publisher.beginWrite();
+  publisher.publishStep(0, false);
+  publisher.publishStep(1, true);
+  Situation situation;
+  EXPECT_TRUE(publisher.tryRead(situation));
+  EXPECT_EQ(situation.epoch, closed.epoch);
+  EXPECT_EQ(situation.getActivatedSteps(), std::vector<unsigned int>({0}));
+  EXPECT_EQ(publisher.read().getActivatedSteps(), std::vector<unsigned int>({0}));
+  publisher.endWrite();
+  situation = publisher.read();
+  EXPECT_GT(situation.epoch, closed.epoch);
+  EXPECT_EQ(situation.getActivatedSteps(), std::vector<unsigned int>({1}));
+  sim.stop();
+}
+
+TEST_F(SfcTest, Run_Unique_Sequence_Situation_Never_Torn) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(10);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  std::thread t([&seq]() { seq.start(); });
+  waitForStep(seq, *init_step);
+  std::atomic_bool reading(true);
+  uint64_t reads = 0;
+  uint64_t torn = 0;
+  std::thread reader([&]() {
+    while (reading) {
+      // One step is always active, on a consistent situation.
+      torn += seq.getSituation().getActivatedSteps().size() != 1;
+      reads++;
+      std::this_thread::yield();
+    }
+  });
+  for (int i = 0; i < 200; i++) {
+    waitForStep(seq, *first_step, *t1);
+    t1->setReceptivityState(false);
+    waitForStep(seq, *init_step, *t2);
+    t2->setReceptivityState(false);
+  }
+  reading = false;
+  reader.join();
+  seq.stop();
+  t.join();
+  EXPECT_GT(reads, 0);
+  EXPECT_EQ(torn, 0);
+}
+
+TEST_F(SfcTest, Simulate_Await_Situation_Timeouts) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+
+  // Not yet started.
+  EXPECT_FALSE(seq.awaitStep(0, true, 1ms));
+  Simulation sim(seq);
+  sim.start();
+  EXPECT_TRUE(seq.awaitStep(0, true, 0ms));
+  EXPECT_TRUE(seq.awaitStep(1, false, 0ms));
+  EXPECT_FALSE(seq.awaitStep(1, true, 1ms));
+  EXPECT_THROW(seq.awaitStep(9999, true, 1ms), std::invalid_argument);
+  EXPECT_EQ(seq.awaitAny({1, 0}, true, 0ms), 0);
+  EXPECT_EQ(seq.awaitAny({1}, true, 1ms), -1);
+  EXPECT_TRUE(seq.awaitStable(0ms));
+  t1->setReceptivityState(true);
+  EXPECT_FALSE(seq.awaitStable(1ms));
+  sim.tick();
+  EXPECT_TRUE(seq.awaitStable(0ms));
+  EXPECT_TRUE(seq.awaitStep(1, true, 0ms));
+}
+
+TEST_F(SfcTest, Run_Await_Step_Activation) {
+  Sequence seq;
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({second_step}, {init_step});
+  init_step->addTransition(t2);
+  std::shared_ptr<Transition> t3 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t3);
+  std::shared_ptr<Transition> t4 = Transition::mk_sp_transition({init_step}, {second_step});
+  second_step->addTransition(t4);
+
+  std::thread t([&seq]() { seq.start(); });
+  // Waiting before the sequence is started.
+  EXPECT_TRUE(seq.awaitStep(0, true, 10s));
+  std::thread producer([&t2]() {
+    std::this_thread::sleep_for(5ms);
+    t2->setReceptivityState(true);
+  });
+  EXPECT_EQ(seq.awaitAny({1, 2}, true, 10s), 2);
+  producer.join();
+  t2->setReceptivityState(false);
+  EXPECT_TRUE(seq.awaitStable(10s));
+  EXPECT_FALSE(init_step->isActivated());
+  t4->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(2, false, 10s));
+  EXPECT_TRUE(seq.awaitStep(0, true, 10s));
+  t4->setReceptivityState(false);
+  seq.stop();
+  t.join();
+}
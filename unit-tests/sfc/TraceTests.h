@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/Sequence.hpp>
+#include <sfc/step/action/StepAction.hpp>
+#include <sfc/trace/Tracer.hpp>
+#include <sfc/transition/Transition.hpp>
+
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+TEST_F(SfcTest, Run_Simultaneous_Sequence_Traced) {
+  Sequence seq(4);
+  seq.setTransitionPollingDelay(1);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  std::shared_ptr<Step> second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  seq.addStep(second_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step, second_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 =
+      Transition::mk_sp_transition({init_step}, {first_step, second_step}, Transition::ALL);
+  first_step->addTransition(t2);
+  second_step->addTransition(t2);
+  first_step->addStepAction(std::make_shared<StepAction>([]() { std::this_thread::sleep_for(std::chrono::milliseconds(1)); }));
+  seq.addStepChangedCallback([](unsigned int, bool) {});
+
+  auto tracer = std::make_shared<Tracer>(1024);
+  seq.setTracer(tracer);
+  EXPECT_EQ(seq.getTracer(), tracer);
+  std::thread thread([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &) {
+    }
+  });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  EXPECT_THROW(seq.setTracer(nullptr), std::runtime_error);
+  t1->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitSituation([](const Situation &situation) { return situation.isActivated(1) && situation.isActivated(2); },
+                                 std::chrono::seconds(5)));
+  t1->setReceptivityState(false);
+  t2->setReceptivityState(true);
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  t2->setReceptivityState(false);
+  seq.stop();
+  thread.join();
+
+  auto events = tracer->events();
+  auto count = [&events](TraceEvent::Kind kind, unsigned int step_id) {
+    return std::count_if(events.begin(), events.end(),
+                         [&](const TraceEvent &e) { return e.kind == kind && e.step_id == step_id; });
+  };
+  EXPECT_EQ(count(TraceEvent::STEP, 1), 1);
+  EXPECT_EQ(count(TraceEvent::STEP, 2), 1);
+  EXPECT_EQ(count(TraceEvent::ACTIONS, 1), 1);
+  EXPECT_EQ(count(TraceEvent::ACTIONS, 2), 0);
+  EXPECT_EQ(count(TraceEvent::WAIT_PREVIOUS, 1), 1);
+  EXPECT_GE(count(TraceEvent::CALLBACKS, 1), 2);
+  // A divergence: two arrows out of the init step. A convergence: two arrows into it.
+  EXPECT_EQ(count(TraceEvent::FLOW_START, 0), 2);
+  EXPECT_EQ(count(TraceEvent::FLOW_END, 1), 1);
+  EXPECT_EQ(count(TraceEvent::FLOW_END, 0), 2);
+  for (const auto &e : events) {
+    EXPECT_LE(e.begin, e.end);
+    if (e.kind == TraceEvent::STEP && e.step_id != 0) {
+      // Steps of the divergence are on their own branch, run by workers.
+      EXPECT_GT(e.branch, 0);
+      EXPECT_GE(e.worker, 0);
+    }
+  }
+  auto action = std::find_if(events.begin(), events.end(), [](const TraceEvent &e) { return e.kind == TraceEvent::ACTIONS; });
+  ASSERT_NE(action, events.end());
+  EXPECT_GE(action->end - action->begin, std::chrono::milliseconds(1));
+
+  std::stringstream json;
+  tracer->writeChromeJson(json);
+  const std::string text = json.str();
+  EXPECT_EQ(text.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0), 0);
+  EXPECT_NE(text.find("\"name\":\"Branch #1\""), std::string::npos);
+  EXPECT_NE(text.find("\"ph\":\"s\""), std::string::npos);
+  EXPECT_NE(text.find("\"bp\":\"e\""), std::string::npos);
+  EXPECT_EQ(tracer->droppedCount(), 0);
+  tracer->clear();
+  EXPECT_EQ(tracer->eventsCount(), 0);
+}
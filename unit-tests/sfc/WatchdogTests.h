@@ -0,0 +1,217 @@
+#pragma once
+
+#include "../SfcTest.h"
+#include <sfc/CompiledChart.hpp>
+#include <sfc/Sequence.hpp>
+#include <sfc/transition/Transition.hpp>
+#include <sfc/watchdog/TimerWheel.hpp>
+#include <sfc/watchdog/Watchdog.hpp>
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+TEST_F(SfcTest, Timer_Wheel_Expiry) {
+  using namespace std::chrono_literals;
+  TimerWheel wheel(1ms, 3);
+  std::vector<uint32_t> expired;
+  auto collect = [&expired](const TimerWheel::Timer &timer) { expired.push_back(timer.key); };
+  wheel.schedule(1, 5ms);
+  wheel.schedule(2, 300ms);
+  EXPECT_EQ(wheel.size(), 2);
+  EXPECT_FALSE(wheel.due(4ms));
+  EXPECT_EQ(wheel.advance(4ms, collect), 0);
+  EXPECT_TRUE(wheel.due(5ms));
+  EXPECT_EQ(wheel.advance(5ms, collect), 1);
+  EXPECT_EQ(expired, std::vector<uint32_t>({1}));
+  // Only the earliest pending deadline is tracked.
+  EXPECT_FALSE(wheel.due(260ms));
+  // Re-armed in place: the previous deadline is gone.
+  wheel.schedule(2, 320ms);
+  EXPECT_EQ(wheel.size(), 1);
+  EXPECT_EQ(wheel.advance(310ms, collect), 0);
+  EXPECT_FALSE(wheel.due(315ms));
+  // Long gap.
+  EXPECT_EQ(wheel.advance(1s, collect), 1);
+  EXPECT_EQ(expired, std::vector<uint32_t>({1, 2}));
+  EXPECT_EQ(wheel.size(), 0);
+  // Cancelled for its deadline only.
+  wheel.schedule(0, 1100ms);
+  EXPECT_FALSE(wheel.cancel(0, 1000ms));
+  EXPECT_TRUE(wheel.cancel(0, 1100ms));
+  EXPECT_EQ(wheel.size(), 0);
+  EXPECT_EQ(wheel.advance(2s, collect), 0);
+  // In the past: next advance.
+  wheel.schedule(0, 10ms);
+  EXPECT_EQ(wheel.advance(2001ms, collect), 1);
+}
+
+TEST_F(SfcTest, Watchdog_Loops_Rates_And_Dwell) {
+  using namespace std::chrono_literals;
+  auto init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  auto first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  auto second_step = std::make_shared<Step>(2, Step::DEFAULT_STEP);
+  auto third_step = std::make_shared<Step>(3, Step::DEFAULT_STEP);
+  auto fourth_step = std::make_shared<Step>(4, Step::DEFAULT_STEP);
+  init_step->addTransition(Transition::mk_sp_transition({first_step}, {init_step}));
+  first_step->addTransition(Transition::mk_sp_transition({second_step}, {first_step}));
+  second_step->addTransition(Transition::mk_sp_transition({init_step}, {second_step}));
+  second_step->addTransition(Transition::mk_sp_transition({third_step}, {second_step}));
+  third_step->addTransition(Transition::mk_sp_transition({fourth_step}, {third_step}));
+  fourth_step->addTransition(Transition::mk_sp_transition({fourth_step}, {fourth_step}));
+  auto chart = CompiledChart::compile({{0, init_step}},
+                                      {{1, first_step}, {2, second_step}, {3, third_step}, {4, fourth_step}});
+
+  uint32_t loops_count = 0;
+  auto loops = Watchdog::findLoops(*chart, loops_count);
+  EXPECT_EQ(loops_count, 2);
+  const uint32_t loop = loops[chart->stepIndex(0)];
+  EXPECT_NE(loop, Watchdog::NO_LOOP);
+  EXPECT_EQ(loops[chart->stepIndex(1)], loop);
+  EXPECT_EQ(loops[chart->stepIndex(2)], loop);
+  EXPECT_EQ(loops[chart->stepIndex(3)], Watchdog::NO_LOOP);
+  EXPECT_NE(loops[chart->stepIndex(4)], Watchdog::NO_LOOP);
+  EXPECT_NE(loops[chart->stepIndex(4)], loop);
+
+  WatchdogConfig config;
+  EXPECT_FALSE(config.enabled());
+  config.max_loop_activations = 3;
+  config.loop_max_activations[4] = 0;
+  config.max_dwell[3] = 10ms;
+  EXPECT_TRUE(config.enabled());
+  Watchdog watchdog(*chart, config);
+  // Any step of the loop counts.
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(0), 1ms), 0);
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(1), 2ms), 0);
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(2), 3ms), 0);
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(0), 4ms), 4);
+  // Reported once per window.
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(1), 5ms), 0);
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(0), 200ms), 0);
+  // Disabled loop, and no loop.
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(watchdog.activated(chart->stepIndex(4), 201ms), 0);
+  }
+
+  std::vector<std::pair<uint32_t, std::chrono::nanoseconds>> timeouts;
+  auto timeout = [&timeouts](uint32_t index, std::chrono::nanoseconds dwell) { timeouts.push_back({index, dwell}); };
+  EXPECT_EQ(watchdog.activated(chart->stepIndex(3), 210ms), 0);
+  EXPECT_EQ(watchdog.pendingTimers(), 1);
+  EXPECT_EQ(watchdog.poll(215ms, [](uint32_t, int64_t) { return true; }, timeout), 0);
+  EXPECT_EQ(watchdog.poll(230ms, [](uint32_t, int64_t) { return true; }, timeout), 1);
+  ASSERT_EQ(timeouts.size(), 1);
+  EXPECT_EQ(timeouts[0].first, chart->stepIndex(3));
+  EXPECT_EQ(timeouts[0].second, 20ms);
+  // Deactivated meanwhile: outdated timer.
+  watchdog.armDwell(chart->stepIndex(3), 240ms);
+  EXPECT_EQ(watchdog.poll(260ms, [](uint32_t, int64_t) { return false; }, timeout), 0);
+  EXPECT_EQ(watchdog.pendingTimers(), 0);
+  // Re-armed in place by the next activation, disarmed by its deactivation only.
+  watchdog.armDwell(chart->stepIndex(3), 270ms);
+  watchdog.armDwell(chart->stepIndex(3), 275ms);
+  EXPECT_EQ(watchdog.pendingTimers(), 1);
+  watchdog.disarmDwell(chart->stepIndex(3), 270ms);
+  EXPECT_EQ(watchdog.pendingTimers(), 1);
+  watchdog.disarmDwell(chart->stepIndex(3), 275ms);
+  EXPECT_EQ(watchdog.pendingTimers(), 0);
+  EXPECT_EQ(watchdog.poll(300ms, [](uint32_t, int64_t) { return true; }, timeout), 0);
+  EXPECT_EQ(timeouts.size(), 1);
+}
+
+TEST_F(SfcTest, Run_Sequence_Watchdog_Loop_Rate) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(1);
+  // Busy workers are waited for: the pool never tells the loop.
+  PoolPolicy policy;
+  policy.mode = PoolPolicy::BACKPRESSURE;
+  seq.setPoolPolicy(policy);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  WatchdogConfig config;
+  config.max_loop_activations = 50;
+  config.rate_window = std::chrono::seconds(10);
+  seq.setWatchdogConfig(config);
+  std::mutex events_mutex;
+  std::vector<WatchdogEvent> events;
+  seq.addWatchdogCallback([&events_mutex, &events](const WatchdogEvent &event) {
+    std::lock_guard<std::mutex> _lock(events_mutex);
+    events.push_back(event);
+  });
+  t2->setReceptivityState(true);
+
+  std::thread t([&seq]() {
+    try {
+      seq.start();
+    } catch (const std::exception &) {
+    }
+  });
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  EXPECT_THROW(seq.setWatchdogConfig(WatchdogConfig()), std::runtime_error);
+  // Tight loop: told by its activation rate, not by the pool.
+  t1->setReceptivityState(true);
+  for (int i = 0; i < 5000 && seq.isRunning(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(seq.isRunning());
+  if (seq.isRunning()) {
+    seq.stop();
+  }
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::CRAZY_LOOPING_STOP);
+  EXPECT_EQ(seq.getMetrics().value(Metrics::WATCHDOG_VIOLATIONS), 1);
+  std::lock_guard<std::mutex> _lock(events_mutex);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].kind, WatchdogEvent::LOOP_RATE);
+  EXPECT_EQ(events[0].activations, 51);
+  EXPECT_LE(init_step->activationsCount() + first_step->activationsCount(), 52);
+}
+
+TEST_F(SfcTest, Run_Sequence_Watchdog_Dwell_Timeout) {
+  Sequence seq;
+  seq.setTransitionPollingDelay(100);
+  std::shared_ptr<Step> init_step = std::make_shared<Step>(0, Step::INIT_STEP);
+  std::shared_ptr<Step> first_step = std::make_shared<Step>(1, Step::DEFAULT_STEP);
+  seq.addStep(init_step);
+  seq.addStep(first_step);
+  std::shared_ptr<Transition> t1 = Transition::mk_sp_transition({first_step}, {init_step});
+  init_step->addTransition(t1);
+  std::shared_ptr<Transition> t2 = Transition::mk_sp_transition({init_step}, {first_step});
+  first_step->addTransition(t2);
+  WatchdogConfig config;
+  config.max_dwell[1] = std::chrono::milliseconds(20);
+  seq.setWatchdogConfig(config);
+  std::mutex events_mutex;
+  std::vector<WatchdogEvent> events;
+  seq.addWatchdogCallback([&events_mutex, &events](const WatchdogEvent &event) {
+    std::lock_guard<std::mutex> _lock(events_mutex);
+    events.push_back(event);
+  });
+
+  std::thread t([&seq]() { seq.start(); });
+  // Step #0 has no limit.
+  EXPECT_TRUE(seq.awaitStep(0, true, std::chrono::seconds(5)));
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  EXPECT_TRUE(seq.isRunning());
+  // Step #1 is stuck.
+  t1->setReceptivityState(true);
+  for (int i = 0; i < 5000 && seq.isRunning(); i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_FALSE(seq.isRunning());
+  if (seq.isRunning()) {
+    seq.stop();
+  }
+  t.join();
+  EXPECT_EQ(seq.getStopCode(), Sequence::DWELL_TIMEOUT_STOP);
+  std::lock_guard<std::mutex> _lock(events_mutex);
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].kind, WatchdogEvent::DWELL_TIMEOUT);
+  EXPECT_EQ(events[0].step_id, 1);
+  EXPECT_GE(events[0].dwell, std::chrono::milliseconds(20));
+}